@@ -18,6 +18,7 @@
 #include <vector>
 
 #include "Farfalle.h"
+#include "threads.h"
 
 using namespace std;
 
@@ -35,63 +36,210 @@ static void Farfalle_assert(bool condition, const string &synopsis, const char *
 #define assert(cond, msg)  Farfalle_assert(cond, msg, __FUNCTION__)
 #endif
 
+/* BaseRollingFunction */
+BitString BaseRollingFunction::operator()(const BitString &k, unsigned int i) const
+{
+	BitString kp = k;
+	for (unsigned int j = 0; j < i; j++)
+	{
+		step(kp);
+	}
+	return kp;
+}
+
 /* IdentityRollingFunction */
+void IdentityRollingFunction::step(BitString &k) const
+{
+	(void)k;
+}
+
 BitString IdentityRollingFunction::operator()(const BitString &k, unsigned int i) const
 {
     (void)i;
 	return k;
 }
 
+/* Farfalle layers */
+static void xorBlockInto(UINT8 *target, const UINT8 *source, unsigned int blockSize)
+{
+	for (unsigned int i = 0; i < blockSize; i++)
+	{
+		target[i] ^= source[i];
+	}
+}
+
+/** Permutes the blocks [begin, end) in batches and, if sum is not NULL, XORs their images into sum. */
+static void permuteBlockRange(const BaseIterableTransformation &p, UINT8 *blocks, UINT64 begin, UINT64 end, unsigned int blockSize, UINT8 *sum)
+{
+	UINT8 *states[Farfalle::batchSize];
+
+	for (UINT64 i = begin; i < end; i += Farfalle::batchSize)
+	{
+		size_t n = (size_t)min<UINT64>(Farfalle::batchSize, end - i);
+
+		for (size_t j = 0; j < n; j++)
+		{
+			states[j] = blocks + (i + j) * blockSize;
+		}
+		p.permuteN(states, n);
+
+		if (sum != NULL)
+		{
+			for (size_t j = 0; j < n; j++)
+			{
+				xorBlockInto(sum, states[j], blockSize);
+			}
+		}
+	}
+}
+
+/**
+ * Permutes all the blocks in place and, if sum is not NULL, XORs their images into sum.
+ * Each thread accumulates into its own partial sum, and the partial sums are combined
+ * once all threads are done, so that no synchronization is needed on sum.
+ */
+static void permuteBlocks(const BaseIterableTransformation &p, vector<UINT8> &blocks, unsigned int blockSize, bool multiThreaded, UINT8 *sum)
+{
+	UINT64       nrBlocks = blocks.size() / blockSize;
+	unsigned int nrThreads = multiThreaded ? getNumberOfThreads() : 1;
+
+	if ((nrThreads <= 1) || (nrBlocks < (UINT64)Farfalle::minimumBlocksPerThread * nrThreads))
+	{
+		if (nrBlocks > 0)
+		{
+			permuteBlockRange(p, &blocks[0], 0, nrBlocks, blockSize, sum);
+		}
+		return;
+	}
+
+	vector<UINT8> partialSums((sum != NULL) ? nrThreads * blockSize : 0, 0);
+	parallelFor(0, nrThreads, [&](UINT64 threadBegin, UINT64 threadEnd)
+	{
+		for (UINT64 t = threadBegin; t < threadEnd; t++)
+		{
+			permuteBlockRange(p, &blocks[0], nrBlocks * t / nrThreads, nrBlocks * (t + 1) / nrThreads, blockSize,
+				(sum != NULL) ? &partialSums[t * blockSize] : NULL);
+		}
+	});
+
+	if (sum != NULL)
+	{
+		for (unsigned int t = 0; t < nrThreads; t++)
+		{
+			xorBlockInto(sum, &partialSums[t * blockSize], blockSize);
+		}
+	}
+}
+
 /* Farfalle */
 Farfalle::Farfalle(BaseIterableTransformation &p_b,
                    BaseIterableTransformation &p_c,
                    BaseIterableTransformation &p_d,
                    BaseIterableTransformation &p_e,
                    BaseRollingFunction        &roll_c,
-                   BaseRollingFunction        &roll_e)
-	: p_b(p_b), p_c(p_c), p_d(p_d), p_e(p_e), roll_c(roll_c), roll_e(roll_e)
+                   BaseRollingFunction        &roll_e,
+                   bool                        multiThreaded)
+	: p_b(p_b), p_c(p_c), p_d(p_d), p_e(p_e), roll_c(roll_c), roll_e(roll_e), multiThreaded(multiThreaded)
 {
 	assert((p_b.width % 8) == 0 && (p_c.width % 8) == 0 && (p_d.width % 8) == 0 && (p_e.width % 8) == 0,
 		"This implementation only supports permutation width that are multiple of 8."); // Limitation of Transformation class
 }
 
 BitString Farfalle::operator()(const BitString &K, const BitStrings &Mseq, unsigned int n, unsigned int q) const
+{
+	FarfalleState state = start(K);
+
+	for (unsigned int j = 0; j < Mseq.size(); j++)
+	{
+		absorb(state, Mseq[j]);
+	}
+
+	return squeeze(state, n, q);
+}
+
+FarfalleState Farfalle::start(const BitString &K) const
 {
 	unsigned int b = width();
 	if (!(K.size() <= b - 1)) throw Exception("Key length must be less than b bits");
-	unsigned int m = Mseq.size();
 
 	BitString Kp = K || BitString::pad10(b, K.size());
-	BitString k = p_b(Kp);
 
-	BitString    x = BitString::zeroes(b);
-	unsigned int I = 0;
+	FarfalleState state;
+	state.x = BitString::zeroes(b);
+	state.kI = p_b(Kp);
+	state.I = 0;
+	return state;
+}
 
-	for (unsigned int j = 0; j <= m - 1; j++)
+void Farfalle::absorb(FarfalleState &state, const BitString &M) const
+{
+	unsigned int b = width();
+	unsigned int blockSize = b / 8;
+
+	// Compression layer: the blocks mblocks[i] ^ roll_c(k, I + i) are gathered
+	// in chunks, with the rolled key computed incrementally, in the order of i.
+	// Each chunk is then permuted by p_c and accumulated into x.
+	// The whole blocks are read in place from M; only the last one is padded into a copy.
+	unsigned int mu = (M.size() + b) / b;
+	BitString last = BitString(BitStringView(M, (mu - 1) * b, b)) || BitString::pad10(b, M.size());
+	vector<UINT8> chunk;
+	chunk.reserve(((mu < compressionChunkBlocks) ? mu : compressionChunkBlocks) * blockSize);
+
+	for (unsigned int i = 0; i < mu; i++)
 	{
-		unsigned int mu = (Mseq[j].size() + b) / b;
-		BitString M = Mseq[j] || BitString::pad10(mu * b, Mseq[j].size());
-		Blocks mblocks(M, b);
+		size_t offset = chunk.size();
+		chunk.resize(offset + blockSize);
+		const UINT8 *mask = state.kI.array();
+		const UINT8 *mblock = (i + 1 < mu) ? BitStringView(M, i * b, b).array() : last.array();
 
-		for (unsigned int i = I; i <= I + mu - 1; i++)
+		for (unsigned int l = 0; l < blockSize; l++)
 		{
-			x = x ^ p_c(mblocks[i - I] ^ roll_c(k, i));
+			chunk[offset + l] = mblock[l] ^ mask[l];
 		}
+		roll_c.step(state.kI);
 
-		I = I + mu + 1;
+		if (chunk.size() == compressionChunkBlocks * blockSize)
+		{
+			permuteBlocks(p_c, chunk, blockSize, multiThreaded, state.x.array());
+			chunk.clear();
+		}
 	}
+	permuteBlocks(p_c, chunk, blockSize, multiThreaded, state.x.array());
+
+	// Skip one index between consecutive strings, i.e., I = I + mu + 1.
+	roll_c.step(state.kI);
+	state.I = state.I + mu + 1;
+}
+
+BitString Farfalle::squeeze(const FarfalleState &state, unsigned int n, unsigned int q) const
+{
+	unsigned int b = width();
+	unsigned int blockSize = b / 8;
 
-	BitString kp = roll_c(k, I);
-	BitString y = p_d(x);
+	const BitString &kp = state.kI;
+	BitString y = p_d(state.x);
 
-	Blocks zblocks(width());
+	// Expansion layer: the blocks roll_e(y, j) are permuted by p_e, then k' is added.
+	UINT64          nrOutputBlocks = ((UINT64)n + q + b - 1) / b;
+	vector<UINT8>   zblocks(nrOutputBlocks * blockSize);
+	RollingIterator ye(roll_e, y);
 
-	for (unsigned int j = 0; width() * j < n + q; j++)
+	for (UINT64 j = 0; j < nrOutputBlocks; j++, ++ye)
+	{
+		std::copy((*ye).array(), (*ye).array() + blockSize, zblocks.begin() + j * blockSize);
+	}
+	permuteBlocks(p_e, zblocks, blockSize, multiThreaded, NULL);
+	for (UINT64 j = 0; j < nrOutputBlocks; j++)
 	{
-		zblocks[j] = p_e(roll_e(y, j)) ^ kp;
+		xorBlockInto(&zblocks[j * blockSize], kp.array(), blockSize);
 	}
 
-	BitString Z = BitString::substring(zblocks.bits(), q, n);
+	BitString Z(zblocks);
+	if (q > 0)
+	{
+		return BitString(BitStringView(Z, q, n));
+	}
+	Z.truncate(n);
 	return Z;
 }
 
@@ -108,11 +256,12 @@ FarfalleSANE::FarfalleSANE(const Farfalle  &F,
                            const BitString &N,
                            BitString &T,
                            bool sender)
-	: F(F), t(t), l(l), K(K), e(0)
+	: F(F), t(t), l(l), e(0)
 {
 	offset = l * ((t + l - 1) / l);
-	history = N;
-	BitString Tp = F(K, history, t);
+	history = F.start(K);
+	F.absorb(history, N);
+	BitString Tp = F.squeeze(history, t);
 
 	if (sender)
 	{
@@ -126,38 +275,38 @@ FarfalleSANE::FarfalleSANE(const Farfalle  &F,
 
 pair<BitString, BitString> FarfalleSANE::wrap(const BitString &A, const BitString &P)
 {
-	BitString C = P ^ F(K, history, P.size(), offset);
+	BitString C = P ^ F.squeeze(history, P.size(), offset);
 
 	if (A.size() > 0 || P.size() == 0)
 	{
-		history = (A || 0 || e) * history;
+		F.absorb(history, A || 0 || e);
 	}
 
 	if (P.size() > 0)
 	{
-		history = (C || 1 || e) * history;
+		F.absorb(history, C || 1 || e);
 	}
 
-	BitString T = F(K, history, t);
+	BitString T = F.squeeze(history, t);
 	e = (e + 1) % 2;
 	return make_pair(C, T);
 }
 
 BitString FarfalleSANE::unwrap(const BitString &A, const BitString &C, const BitString &T)
 {
-	BitString P = C ^ F(K, history, C.size(), offset);
+	BitString P = C ^ F.squeeze(history, C.size(), offset);
 
 	if (A.size() > 0 || C.size() == 0)
 	{
-		history = (A || 0 || e) * history;
+		F.absorb(history, A || 0 || e);
 	}
 
 	if (C.size() > 0)
 	{
-		history = (C || 1 || e) * history;
+		F.absorb(history, C || 1 || e);
 	}
 
-	BitString Tp = F(K, history, t);
+	BitString Tp = F.squeeze(history, t);
 	e = (e + 1) % 2;
 
 	if (Tp == T)
@@ -174,28 +323,35 @@ BitString FarfalleSANE::unwrap(const BitString &A, const BitString &C, const Bit
 FarfalleSANSE::FarfalleSANSE(const Farfalle  &F,
                              unsigned int     t,
                              const BitString &K)
-	: F(F), t(t), K(K), e(0)
+	: F(F), t(t), e(0)
 {
+	history = F.start(K);
 }
 
 pair<BitString, BitString> FarfalleSANSE::wrap(const BitString &A, const BitString &P)
 {
 	if (A.size() > 0 || P.size() == 0)
 	{
-		history = (A || 0 || e) * history;
+		F.absorb(history, A || 0 || e);
 	}
 
 	BitString T, C;
 
 	if (P.size() > 0)
 	{
-		T =     F(K, (P || 0 || 1 || e) * history, t);
-		C = P ^ F(K, (T || 1 || 1 || e) * history, P.size());
-		history = (P || 0 || 1 || e) * history;
+		FarfalleState historyP = history;
+		F.absorb(historyP, P || 0 || 1 || e);
+		T = F.squeeze(historyP, t);
+
+		FarfalleState historyT = history;
+		F.absorb(historyT, T || 1 || 1 || e);
+		C = P ^ F.squeeze(historyT, P.size());
+
+		history = historyP;
 	}
 	else
 	{
-		T = F(K, history, t);
+		T = F.squeeze(history, t);
 	}
 
 	e = (e + 1) % 2;
@@ -206,18 +362,20 @@ BitString FarfalleSANSE::unwrap(const BitString &A, const BitString &C, const Bi
 {
 	if (A.size() > 0 || C.size() == 0)
 	{
-		history = (A || 0 || e) * history;
+		F.absorb(history, A || 0 || e);
 	}
 
 	BitString P;
 
 	if (C.size() > 0)
 	{
-		P = C ^ F(K, (T || 1 || 1 || e) * history, C.size());
-		history = (P || 0 || 1 || e) * history;
+		FarfalleState historyT = history;
+		F.absorb(historyT, T || 1 || 1 || e);
+		P = C ^ F.squeeze(historyT, C.size());
+		F.absorb(history, P || 0 || 1 || e);
 	}
 
-	BitString Tp = F(K, history, t);
+	BitString Tp = F.squeeze(history, t);
 	e = (e + 1) % 2;
 
 	if (Tp == T)
@@ -324,7 +482,7 @@ BitString FarfalleWBCAE::unwrap(const BitString &K, const BitString &A, const Bi
 
 	if (R.size() >= b + t)
 	{
-		if (!(BitString::substring(R, R.size() - t, t) == BitString::zeroes(t))) throw Exception("error!");
+		if (!(BitStringView(R, R.size() - t, t) == BitString::zeroes(t))) throw Exception("error!");
 		L = L ^ G(K, (R || 1) * A, L.size());
 		Hval = H(K, (L || 0), b);
 		R = R ^ (Hval || BitString::zeroes(R.size() - Hval.size()));
@@ -334,7 +492,7 @@ BitString FarfalleWBCAE::unwrap(const BitString &K, const BitString &A, const Bi
 		L = L ^ G(K, (R || 1) * A, L.size());
 		Hval = H(K, (L || 0), min(b, R.size()));
 		R = R ^ (Hval || BitString::zeroes(R.size() - Hval.size()));
-		if (!(BitString::substring(L || R, C.size() - t, t) == BitString::zeroes(t))) throw Exception("error!");
+		if (!(BitStringView(L || R, C.size() - t, t) == BitString::zeroes(t))) throw Exception("error!");
 	}
 
 	BitString Pp = L || R;
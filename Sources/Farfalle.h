@@ -35,6 +35,9 @@ class BaseIterableTransformation
 		BaseIterableTransformation(unsigned int width, unsigned int rounds) : width(width), rounds(rounds) {}
 
 		virtual BitString operator()(const BitString &state) const = 0;
+
+		/** Applies the permutation in place onto @a n states of width/8 bytes each. */
+		virtual void permuteN(UINT8 * const * states, size_t n) const = 0;
 };
 
 template<class T>
@@ -53,25 +56,80 @@ class IterableTransformation : public BaseIterableTransformation
 			f(state2.array());
 			return state2;
 		}
+
+		void permuteN(UINT8 * const * states, size_t n) const
+		{
+			f.permuteN(states, n);
+		}
 };
 
 /**
- * Class implementing a rolling function
+ * Class implementing a rolling function, i.e., a function roll(k, i) obtained
+ * by applying i times the same step to k
  */
 class BaseRollingFunction
 {
 	public:
-		virtual BitString operator()(const BitString &k, unsigned int i) const = 0;
+		virtual ~BaseRollingFunction() {}
+
+		/** Applies one step in place, turning roll(k, i) into roll(k, i+1). */
+		virtual void step(BitString &k) const = 0;
+
+		/** Returns roll(k, i); by default, applies i steps to a copy of k. */
+		virtual BitString operator()(const BitString &k, unsigned int i) const;
 };
 
 class IdentityRollingFunction : public BaseRollingFunction
 {
 	public:
+		void step(BitString &k) const;
 		BitString operator()(const BitString &k, unsigned int i) const;
 };
 
 /**
- * Class implementing the Farfalle construction
+ * Class iterating over roll(k, i) for i = 0, 1, 2, ..., one step at a time,
+ * so that going through n values costs n steps instead of n(n-1)/2
+ */
+class RollingIterator
+{
+	protected:
+		const BaseRollingFunction &roll;
+		BitString                  value;
+		unsigned int               i;
+
+	public:
+		RollingIterator(const BaseRollingFunction &roll, const BitString &k, unsigned int i = 0) : roll(roll), value(roll(k, i)), i(i) {}
+
+		const BitString &operator*() const { return value; }
+		RollingIterator &operator++() { roll.step(value); i++; return *this; }
+		RollingIterator &operator+=(unsigned int n) { while (n-- > 0) ++(*this); return *this; }
+		unsigned int     index() const { return i; }
+};
+
+/**
+ * Class holding the state of the Farfalle compression layer after a sequence of strings,
+ * i.e., the accumulator x, the index I of the next block and the rolled key roll_c(k, I).
+ * Further strings can be absorbed without compressing the earlier ones again.
+ */
+class FarfalleState
+{
+	friend class Farfalle;
+
+	protected:
+		BitString     x;
+		BitString     kI;
+		unsigned int  I;
+
+	public:
+		FarfalleState() : I(0) {}
+		unsigned int  index() const { return I; }
+};
+
+/**
+ * Class implementing the Farfalle construction.
+ * The blocks of the compression and expansion layers are processed
+ * in batches with BaseIterableTransformation::permuteN(), and,
+ * if multiThreaded is set and there are enough blocks, spread over several threads.
  */
 class Farfalle
 {
@@ -82,11 +140,26 @@ class Farfalle
 		BaseIterableTransformation &p_e;
 		BaseRollingFunction        &roll_c;
 		BaseRollingFunction        &roll_e;
+		bool                        multiThreaded;
 
 	public:
-		Farfalle(BaseIterableTransformation &p_b, BaseIterableTransformation &p_c, BaseIterableTransformation &p_d, BaseIterableTransformation &p_e, BaseRollingFunction &roll_c, BaseRollingFunction &roll_e);
+		/** The number of blocks given to BaseIterableTransformation::permuteN() at once. */
+		static const unsigned int batchSize = 8;
+		/** The minimum number of blocks per thread for a layer to be processed with several threads. */
+		static const unsigned int minimumBlocksPerThread = 256;
+		/** The number of input blocks buffered by the compression layer before being processed. */
+		static const unsigned int compressionChunkBlocks = 4096;
+
+		Farfalle(BaseIterableTransformation &p_b, BaseIterableTransformation &p_c, BaseIterableTransformation &p_d, BaseIterableTransformation &p_e, BaseRollingFunction &roll_c, BaseRollingFunction &roll_e, bool multiThreaded = true);
 		BitString     operator()(const BitString &K, const BitStrings &Mseq, unsigned int n, unsigned int q = 0) const;
 		unsigned int  width() const;
+
+		/** Returns the state after the key K and no strings. */
+		FarfalleState start(const BitString &K) const;
+		/** Appends the string M to the sequence of strings compressed into @a state. */
+		void          absorb(FarfalleState &state, const BitString &M) const;
+		/** Returns the n bits at offset q of the output for the strings compressed into @a state. */
+		BitString     squeeze(const FarfalleState &state, unsigned int n, unsigned int q = 0) const;
 };
 
 /**
@@ -98,8 +171,7 @@ class FarfalleSANE
 		Farfalle           F;
 		const unsigned int t;
 		const unsigned int l;
-		BitString          K;
-		BitStrings         history;
+		FarfalleState      history;
 		unsigned int       offset;
 		unsigned int       e;
 
@@ -117,8 +189,7 @@ class FarfalleSANSE
 	private:
 		Farfalle           F;
 		const unsigned int t;
-		BitString          K;
-		BitStrings         history;
+		FarfalleState      history;
 		unsigned int       e;
 
 	public:
@@ -0,0 +1,39 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <iostream>
+#include "Keccak-fCodeGen.h"
+
+using namespace std;
+
+/** Generation stage of the makefile: writes the code produced by
+  * KeccakFCodeGen into the directory given as argument, so that
+  * Keccak-fGenerated.cpp can compile it into KeccakTools.
+  */
+int main(int argc, char *argv[])
+{
+    if (argc != 2) {
+        cerr << "Usage: " << argv[0] << " <output directory>" << endl;
+        return 1;
+    }
+    try {
+        genKeccakFKernels(argv[1]);
+    }
+    catch(KeccakException e) {
+        cerr << e.reason << endl;
+        return 1;
+    }
+    return 0;
+}
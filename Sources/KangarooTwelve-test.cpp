@@ -0,0 +1,104 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <iostream>
+#include <sstream>
+#include "KangarooTwelve.h"
+#include "KangarooTwelve-test.h"
+
+using namespace std;
+
+static vector<UINT8> pattern(unsigned int length)
+{
+    vector<UINT8> result(length);
+    for(unsigned int i=0; i<length; i++)
+        result[i] = (UINT8)(i % 0xFB);
+    return result;
+}
+
+static vector<UINT8> fromHex(const string& hex)
+{
+    vector<UINT8> result;
+    for(unsigned int i=0; i+1<hex.size(); i+=2)
+        result.push_back((UINT8)stoul(hex.substr(i, 2), 0, 16));
+    return result;
+}
+
+static void checkKangarooTwelve(const vector<UINT8>& M, const vector<UINT8>& C, unsigned int L,
+    unsigned int skip, const string& expectedHex, const string& description)
+{
+    vector<UINT8> expected = fromHex(expectedHex);
+    const unsigned int pieceSizes[] = { 0, 1, 8191, 8193, 100000 };
+    for(unsigned int p=0; p<sizeof(pieceSizes)/sizeof(pieceSizes[0]); p++) {
+        for(int multiThreaded=0; multiThreaded<2; multiThreaded++) {
+            KangarooTwelve k12(C, multiThreaded != 0);
+            if (pieceSizes[p] == 0)
+                k12.absorb(M);
+            else
+                for(unsigned int i=0; i<M.size(); i+=pieceSizes[p])
+                    k12.absorb(&M[i], min((size_t)pieceSizes[p], M.size() - i));
+            vector<UINT8> output;
+            k12.squeeze(output, L);
+            if (vector<UINT8>(output.begin() + skip, output.end()) != expected) {
+                stringstream str;
+                str << "KangarooTwelve does not match the test vector for " << description;
+                if (pieceSizes[p] > 0)
+                    str << " when absorbing per " << dec << pieceSizes[p] << " bytes";
+                str << ".";
+                throw Exception(str.str());
+            }
+        }
+    }
+}
+
+void testKangarooTwelve()
+{
+    const vector<UINT8> empty;
+    checkKangarooTwelve(empty, empty, 32, 0,
+        "1AC2D450FC3B4205D19DA7BFCA1B37513C0803577AC7167F06FE2CE1F0EF39E5", "M=empty, C=empty, L=32");
+    checkKangarooTwelve(empty, empty, 64, 0,
+        "1AC2D450FC3B4205D19DA7BFCA1B37513C0803577AC7167F06FE2CE1F0EF39E5"
+        "4269C056B8C82E48276038B6D292966CC07A3D4645272E31FF38508139EB0A71", "M=empty, C=empty, L=64");
+    checkKangarooTwelve(empty, empty, 10032, 10000,
+        "E8DC563642F7228C84684C898405D3A834799158C079B12880277A1D28E2FF6D", "M=empty, C=empty, L=10032");
+    const char *expectedForPattern[] = {
+        "6BF75FA2239198DB4772E36478F8E19B0F371205F6A9A93A273F51DF37122888",
+        "0C315EBCDEDBF61426DE7DCF8FB725D1E74675D7F5327A5067F367B108ECB67C",
+        "CB552E2EC77D9910701D578B457DDF772C12E322E4EE7FE417F92C758F0D59D0",
+        "8701045E22205345FF4DDA05555CBB5C3AF1A771C2B89BAEF37DB43D9998B9FE",
+        "844D610933B1B9963CBDEB5AE3B6B05CC7CBD67CEEDF883EB678A0A8E0371682",
+        "3C390782A8A4E89FA6367F72FEAAF13255C8D95878481D3CD8CE85F58E880AF8" };
+    unsigned int length = 1;
+    for(unsigned int i=0; i<6; i++) {
+        length *= 17;
+        stringstream description;
+        description << "M=ptn(17^" << dec << (i+1) << " bytes), C=empty, L=32";
+        checkKangarooTwelve(pattern(length), empty, 32, 0, expectedForPattern[i], description.str());
+    }
+    const char *expectedForCustomization[] = {
+        "FAB658DB63E94A246188BF7AF69A133045F46EE984C56E3C3328CAAF1AA1A583",
+        "D848C5068CED736F4462159B9867FD4C20B808ACC3D5BC48E0B06BA0A3762EC4",
+        "C389E5009AE57120854C2E8C64670AC01358CF4C1BAF89447A724234DC7CED74",
+        "75D2F86A2E644566726B4FBCFC5657B9DBCF070C7B0DCA06450AB291D7443BCF" };
+    unsigned int customizationLength = 1;
+    for(unsigned int i=0; i<4; i++) {
+        vector<UINT8> M((1 << i) - 1, 0xFF);
+        stringstream description;
+        description << "M=" << dec << M.size() << " bytes 0xFF, C=ptn(41^" << i << " bytes), L=32";
+        checkKangarooTwelve(M, pattern(customizationLength), 32, 0, expectedForCustomization[i], description.str());
+        customizationLength *= 41;
+    }
+    cout << "KangarooTwelve: OK" << endl;
+}
@@ -0,0 +1,27 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KANGAROOTWELVETEST_H_
+#define _KANGAROOTWELVETEST_H_
+
+/**
+  * Function that checks KangarooTwelve against the test vectors of the
+  * CFRG draft, giving the message in one call and in several calls,
+  * and with one thread and several threads for the leaves.
+  * It throws an Exception in case of mismatch.
+  */
+void testKangarooTwelve();
+
+#endif
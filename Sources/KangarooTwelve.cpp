@@ -0,0 +1,123 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include "KangarooTwelve.h"
+#include "threads.h"
+
+using namespace std;
+
+KangarooTwelve::KangarooTwelve(const vector<UINT8>& aCustomization, bool aMultiThreaded)
+    : f(1600, 12), customization(aCustomization), finalNode(&f, &pad, rate),
+    leafHasher(&f, &pad, rate, aMultiThreaded),
+    // Each leaf is followed by the bits 110, i.e., the delimited suffix 0x0B.
+    leaves(&leafHasher, chunkSize, 0x03, 3, chainingValueSize*8, aMultiThreaded ? 64*getNumberOfThreads() : 64,
+        [this](const vector<UINT8>& chainingValue) { finalNode.absorb(chainingValue, chainingValueSize*8); })
+{
+    reset();
+}
+
+void KangarooTwelve::reset()
+{
+    finalNode.reset();
+    leaves.reset();
+    firstChunkSize = 0;
+    squeezing = false;
+}
+
+void KangarooTwelve::absorb(const UINT8 *input, UINT64 lengthInBytes)
+{
+    if (squeezing)
+        throw SpongeException("The absorbing phase is over.");
+    absorbBytes(input, lengthInBytes);
+}
+
+void KangarooTwelve::absorb(const vector<UINT8>& input)
+{
+    if (!input.empty())
+        absorb(&input[0], input.size());
+}
+
+void KangarooTwelve::absorbBytes(const UINT8 *input, UINT64 lengthInBytes)
+{
+    if ((lengthInBytes > 0) && (leaves.getNumberOfLeaves() == 0)) {
+        unsigned int count = chunkSize - firstChunkSize;
+        if (count > lengthInBytes)
+            count = (unsigned int)lengthInBytes;
+        finalNode.absorb(input, count*8);
+        firstChunkSize += count;
+        input += count;
+        lengthInBytes -= count;
+        if (lengthInBytes > 0) {
+            // The first chunk is followed by at least one leaf
+            const UINT8 firstChunkSuffix[8] = { 0x03, 0, 0, 0, 0, 0, 0, 0 };
+            finalNode.absorb(firstChunkSuffix, 64);
+        }
+    }
+    leaves.absorb(input, lengthInBytes);
+}
+
+void KangarooTwelve::finish()
+{
+    absorbBytes(customization.empty() ? 0 : &customization[0], customization.size());
+    vector<UINT8> encodedLength = lengthEncode(customization.size());
+    absorbBytes(&encodedLength[0], encodedLength.size());
+    if (leaves.getNumberOfLeaves() == 0) {
+        // Single node, followed by the bits 11, i.e., the delimited suffix 0x07.
+        const UINT8 suffix = 0x03;
+        finalNode.absorb(&suffix, 2);
+    }
+    else {
+        leaves.flush();
+        vector<UINT8> encodedNrLeaves = lengthEncode(leaves.getNumberOfLeaves());
+        finalNode.absorb(encodedNrLeaves, (unsigned int)encodedNrLeaves.size()*8);
+        // Final node with chaining values, followed by the bits 01,
+        // i.e., the delimited suffix 0x06.
+        const UINT8 finalNodeSuffix[3] = { 0xFF, 0xFF, 0x02 };
+        finalNode.absorb(finalNodeSuffix, 16+2);
+    }
+    squeezing = true;
+}
+
+void KangarooTwelve::squeeze(UINT8 *output, unsigned int lengthInBytes)
+{
+    if (!squeezing)
+        finish();
+    finalNode.squeeze(output, lengthInBytes*8);
+}
+
+void KangarooTwelve::squeeze(vector<UINT8>& output, unsigned int lengthInBytes)
+{
+    if (!squeezing)
+        finish();
+    finalNode.squeeze(output, lengthInBytes*8);
+}
+
+vector<UINT8> KangarooTwelve::hash(const vector<UINT8>& message, const vector<UINT8>& customization, unsigned int outputLengthInBytes)
+{
+    KangarooTwelve k12(customization);
+    k12.absorb(message);
+    vector<UINT8> output;
+    k12.squeeze(output, outputLengthInBytes);
+    return output;
+}
+
+vector<UINT8> KangarooTwelve::lengthEncode(UINT64 x)
+{
+    vector<UINT8> encoding;
+    for( ; x > 0; x >>= 8)
+        encoding.insert(encoding.begin(), (UINT8)(x & 0xFF));
+    encoding.push_back((UINT8)encoding.size());
+    return encoding;
+}
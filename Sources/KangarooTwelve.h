@@ -0,0 +1,129 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KANGAROOTWELVE_H_
+#define _KANGAROOTWELVE_H_
+
+#include <vector>
+#include "Keccak-f.h"
+#include "padding.h"
+#include "sponge.h"
+#include "spongebatch.h"
+#include "types.h"
+
+using namespace std;
+
+/**
+  * Class that implements the KangarooTwelve extendable output function,
+  * as specified in [Bertoni et al., KangarooTwelve: fast hashing based
+  * on Keccak-p, ACNS 2018] and in the CFRG draft.
+  *
+  * The input <i>S</i> = <i>M</i> || <i>C</i> || length_encode(|<i>C</i>|)
+  * is cut into chunks of 8192 bytes. If there is only one chunk, it is
+  * hashed directly. Otherwise, the first chunk goes into the final node,
+  * and each of the other chunks is a leaf whose 256-bit chaining value
+  * is appended to the final node, following the Sakura coding.
+  * All nodes use the sponge construction on Keccak-<i>p</i>[1600, 12]
+  * with a rate of 1344 bits.
+  *
+  * The leaves are buffered and hashed together with SpongeBatch,
+  * so that several leaves are permuted at once with the SIMD backends of
+  * KeccakF::permuteN() and spread over several threads.
+  * The message can be given in any number of calls to absorb().
+  * The objects cannot be copied, as their sponges refer to their own
+  * permutation and padding rule.
+  */
+class KangarooTwelve {
+public:
+    /** The size of a chunk in bytes. */
+    static const unsigned int chunkSize = 8192;
+    /** The size of a chaining value in bytes. */
+    static const unsigned int chainingValueSize = 32;
+    /** The rate of the sponge function used in all nodes. */
+    static const unsigned int rate = 1344;
+protected:
+    /** The permutation Keccak-<i>p</i>[1600, 12]. */
+    KeccakP f;
+    /** The padding rule pad10*1. */
+    MultiRatePadding pad;
+    /** The customization string <i>C</i>. */
+    vector<UINT8> customization;
+    /** The sponge function of the final node. */
+    Sponge finalNode;
+    /** The object that hashes the leaves in batches. */
+    SpongeBatch leafHasher;
+    /** The leaves not yet hashed, whose chaining values go to the final node. */
+    LeafBatchHasher leaves;
+    /** The number of bytes of the first chunk absorbed so far. */
+    unsigned int firstChunkSize;
+    /** Boolean indicating whether the output is being squeezed. */
+    bool squeezing;
+public:
+    /**
+      * The constructor.
+      *
+      * @param  aCustomization  The customization string <i>C</i>.
+      * @param  aMultiThreaded  Whether the leaves may be hashed by several threads.
+      */
+    KangarooTwelve(const vector<UINT8>& aCustomization = vector<UINT8>(), bool aMultiThreaded = true);
+    /**
+      * Method that goes back to the initial state, with the same
+      * customization string.
+      */
+    void reset();
+    /**
+      * Method that absorbs the next bytes of the message <i>M</i>.
+      *
+      * @pre This function must be used before squeeze() only.
+      */
+    void absorb(const UINT8 *input, UINT64 lengthInBytes);
+    /**
+      * Method that absorbs the next bytes of the message <i>M</i>.
+      *
+      * @pre This function must be used before squeeze() only.
+      */
+    void absorb(const vector<UINT8>& input);
+    /**
+      * Method that gives the next bytes of output. The first call
+      * appends the customization string and finishes the tree.
+      */
+    void squeeze(UINT8 *output, unsigned int lengthInBytes);
+    /**
+      * Method that gives the next bytes of output, appended to @a output.
+      */
+    void squeeze(vector<UINT8>& output, unsigned int lengthInBytes);
+    /**
+      * Function that computes KangarooTwelve(<i>M</i>, <i>C</i>, <i>L</i>) in one call.
+      *
+      * @param  message         The message <i>M</i>.
+      * @param  customization   The customization string <i>C</i>.
+      * @param  outputLengthInBytes     The output length <i>L</i> in bytes.
+      */
+    static vector<UINT8> hash(const vector<UINT8>& message, const vector<UINT8>& customization, unsigned int outputLengthInBytes);
+    /**
+      * Function that returns the encoding length_encode(<i>x</i>):
+      * the bytes of <i>x</i> in big-endian order without leading zeroes,
+      * followed by their number.
+      */
+    static vector<UINT8> lengthEncode(UINT64 x);
+protected:
+    void absorbBytes(const UINT8 *input, UINT64 lengthInBytes);
+    void finish();
+private:
+    KangarooTwelve(const KangarooTwelve&);
+    KangarooTwelve& operator=(const KangarooTwelve&);
+};
+
+#endif
@@ -0,0 +1,340 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <iostream>
+#include <string.h>
+#include <vector>
+#include "Keccak-f.h"
+#include "Keccak-fGenerated.h"
+#include "Keccak-fInterleaved.h"
+#include "Keccak-fLUT.h"
+#include "Keccak-fPropagation.h"
+#include "Keccak-fTrails.h"
+#include "Keccak-f-benchmark.h"
+#include "timing.h"
+
+using namespace std;
+
+static const unsigned int nrMeasurements = 200;
+static const unsigned int nrCallsPerMeasurement = 8;
+
+static double cyclesPerByte(UINT64 cycles, unsigned int width)
+{
+    return (double)cycles/nrCallsPerMeasurement/((width+7)/8);
+}
+
+void benchmarkKeccakF()
+{
+    cout << "Permutation         generic (c/B)  unrolled (c/B)  speed-up" << endl;
+    for(unsigned int width=25; width<=1600; width*=2) {
+        KeccakF keccakF(width);
+        UINT8 state[200];
+        memset(state, 0, sizeof(state));
+
+        CycleMeasurement generic;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            generic.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakF.forwardGeneric(state);
+            generic.stop();
+        }
+        CycleMeasurement unrolled;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            unrolled.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakF(state);
+            unrolled.stop();
+        }
+
+        double before = cyclesPerByte(generic.getMinimum(), width);
+        double after = cyclesPerByte(unrolled.getMinimum(), width);
+        cout << setw(20) << left << keccakF.getDescription() << right;
+        cout << fixed << setprecision(1);
+        cout << setw(14) << before << setw(16) << after;
+        cout << setw(9) << before/after << "x" << endl;
+    }
+}
+
+void benchmarkKeccakFInverse()
+{
+    cout << "Inverse of         generic (c/B)  unrolled (c/B)  speed-up" << endl;
+    for(unsigned int width=200; width<=1600; width*=2) {
+        KeccakF keccakF(width);
+        UINT8 state[200];
+        memset(state, 0, sizeof(state));
+
+        CycleMeasurement generic;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            generic.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakF.inverseGeneric(state);
+            generic.stop();
+        }
+        CycleMeasurement unrolled;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            unrolled.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakF.inverse(state);
+            unrolled.stop();
+        }
+
+        double before = cyclesPerByte(generic.getMinimum(), width);
+        double after = cyclesPerByte(unrolled.getMinimum(), width);
+        cout << setw(20) << left << keccakF.getDescription() << right;
+        cout << fixed << setprecision(1);
+        cout << setw(14) << before << setw(16) << after;
+        cout << setw(9) << before/after << "x" << endl;
+    }
+}
+
+void benchmarkKeccakFInterleaved()
+{
+    cout << "Keccak-f[1600] on " << (8*sizeof(void*)) << "-bit platform" << endl;
+    cout << "Permutation         lanes (c/B)  interleaved (c/B)" << endl;
+    KeccakF keccakF(1600);
+    KeccakFInterleaved keccakFInterleaved(1600);
+    UINT8 state[200];
+    memset(state, 0, sizeof(state));
+
+    CycleMeasurement lanes;
+    for(unsigned int i=0; i<nrMeasurements; i++) {
+        lanes.start();
+        for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+            keccakF(state);
+        lanes.stop();
+    }
+    CycleMeasurement interleaved;
+    for(unsigned int i=0; i<nrMeasurements; i++) {
+        interleaved.start();
+        for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+            keccakFInterleaved(state);
+        interleaved.stop();
+    }
+    cout << setw(20) << left << keccakF.getDescription() << right;
+    cout << fixed << setprecision(1);
+    cout << setw(12) << cyclesPerByte(lanes.getMinimum(), 1600);
+    cout << setw(19) << cyclesPerByte(interleaved.getMinimum(), 1600) << endl;
+}
+
+void benchmarkKeccakFParallel()
+{
+    KeccakF keccakF(1600);
+    const unsigned int maxN = 64;
+    const unsigned int byteSize = 200;
+    vector<UINT8> states(maxN*byteSize, 0);
+    vector<UINT8*> pointers(maxN);
+    for(unsigned int i=0; i<maxN; i++)
+        pointers[i] = &states[i*byteSize];
+
+    cout << keccakF << ", throughput of permuteN() in cycles/byte" << endl;
+    cout << "batch";
+    for(unsigned int b=KeccakFParallelScalar; b<=KeccakFParallelAVX512; b++)
+        if (isKeccakFParallelBackendSupported((KeccakFParallelBackend)b))
+            cout << setw(10) << getKeccakFParallelBackendName((KeccakFParallelBackend)b);
+    cout << endl;
+    for(unsigned int n=1; n<=maxN; n++) {
+        if ((n > 8) && ((n % 8) != 0))
+            continue;
+        cout << setw(5) << n;
+        for(unsigned int b=KeccakFParallelScalar; b<=KeccakFParallelAVX512; b++) {
+            KeccakFParallelBackend backend = (KeccakFParallelBackend)b;
+            if (!isKeccakFParallelBackendSupported(backend))
+                continue;
+            CycleMeasurement measurement;
+            for(unsigned int i=0; i<nrMeasurements; i++) {
+                measurement.start();
+                keccakF.permuteN(&pointers[0], n, backend);
+                measurement.stop();
+            }
+            cout << fixed << setprecision(2);
+            cout << setw(10) << (double)measurement.getMinimum()/(n*byteSize);
+        }
+        cout << endl;
+    }
+}
+
+static UINT64 measurePermutation(const Permutation& f, UINT8 *state)
+{
+    CycleMeasurement measurement;
+    for(unsigned int i=0; i<nrMeasurements; i++) {
+        measurement.start();
+        for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+            f(state);
+        measurement.stop();
+    }
+    return measurement.getMinimum();
+}
+
+void benchmarkKeccakFGenerated()
+{
+    for(unsigned int width=200; width<=1600; width*=2) {
+        KeccakF keccakF(width);
+        UINT8 state[200];
+        memset(state, 0, sizeof(state));
+
+        CycleMeasurement generic;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            generic.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakF.forwardGeneric(state);
+            generic.stop();
+        }
+        double reference = cyclesPerByte(generic.getMinimum(), width);
+
+        cout << keccakF << endl;
+        cout << "Implementation                      schedule  compl.  early parity   c/B  speed-up" << endl;
+        cout << fixed << setprecision(1);
+        cout << setw(36) << left << "generic (forwardGeneric())" << right;
+        cout << setw(44) << reference << endl;
+        double unrolled = cyclesPerByte(measurePermutation(keccakF, state), width);
+        cout << setw(36) << left << "unrolled (KeccakF::operator())" << right;
+        cout << setw(44) << unrolled << setw(9) << reference/unrolled << "x" << endl;
+        for(unsigned int scheduleType=1; scheduleType<=2; scheduleType++)
+        for(unsigned int laneComplementing=0; laneComplementing<=1; laneComplementing++)
+        for(unsigned int earlyParity=0; earlyParity<=1; earlyParity++) {
+            if (!KeccakFGenerated::isAvailable(width, scheduleType, laneComplementing != 0, earlyParity != 0))
+                continue;
+            KeccakFGenerated generated(width, scheduleType, laneComplementing != 0, earlyParity != 0);
+            double cycles = cyclesPerByte(measurePermutation(generated, state), width);
+            cout << setw(36) << left << generated.getName() << right;
+            cout << setw(9) << scheduleType;
+            cout << setw(8) << (laneComplementing ? "yes" : "no");
+            cout << setw(14) << (earlyParity ? "yes" : "no");
+            cout << setw(13) << cycles << setw(9) << reference/cycles << "x" << endl;
+        }
+        cout << endl;
+    }
+
+    const unsigned int n = 64;
+    vector<UINT8> states(n*200, 0);
+    vector<UINT8*> pointers(n);
+    for(unsigned int i=0; i<n; i++)
+        pointers[i] = &states[i*200];
+    cout << "Generated code for parallel instances, throughput of permuteN() on " << n << " states" << endl;
+    for(unsigned int SIMD=KeccakFCodeGenSSE2; SIMD<=KeccakFCodeGenAVX512; SIMD++) {
+        if (!KeccakFGeneratedParallel::isAvailable((KeccakFCodeGenSIMD)SIMD))
+            continue;
+        KeccakFGeneratedParallel generated(1600, (KeccakFCodeGenSIMD)SIMD);
+        CycleMeasurement measurement;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            measurement.start();
+            generated.permuteN(&pointers[0], n);
+            measurement.stop();
+        }
+        cout << setw(36) << left << generated.getName() << right;
+        cout << fixed << setprecision(2);
+        cout << setw(8) << (double)measurement.getMinimum()/(n*200) << " c/B" << endl;
+    }
+}
+
+void benchmarkKeccakFLUT()
+{
+    cout << "Permutation         generic (c/B)  unrolled (c/B)  tables (c/B)  tables on planes (c/B)" << endl;
+    for(unsigned int width=25; width<=200; width*=2) {
+        KeccakF keccakF(width);
+        KeccakFLUT keccakFLUT(width);
+        UINT8 state[200];
+        memset(state, 0, sizeof(state));
+
+        CycleMeasurement generic;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            generic.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakF.forwardGeneric(state);
+            generic.stop();
+        }
+        UINT64 planes[5] = { 0, 0, 0, 0, 0 };
+        CycleMeasurement onPlanes;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            onPlanes.start();
+            for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+                keccakFLUT.forwardOnPlanes(planes);
+            onPlanes.stop();
+        }
+
+        cout << setw(20) << left << keccakF.getDescription() << right;
+        cout << fixed << setprecision(1);
+        cout << setw(14) << cyclesPerByte(generic.getMinimum(), width);
+        cout << setw(16) << cyclesPerByte(measurePermutation(keccakF, state), width);
+        cout << setw(14) << cyclesPerByte(measurePermutation(keccakFLUT, state), width);
+        cout << setw(24) << cyclesPerByte(onPlanes.getMinimum(), width) << endl;
+    }
+}
+
+static void benchmarkLambdaOnTrails(const string& fileName, unsigned int width, KeccakFPropagation::DCorLC DCorLC)
+{
+    {
+        ifstream fin(fileName.c_str());
+        if (!fin)
+            return;
+    }
+    KeccakFDCLC keccakFDCLC(width);
+    KeccakFPropagation DCLC(keccakFDCLC, DCorLC);
+    vector<vector<SliceValue> > states;
+    for(TrailFileIterator i(fileName, DCLC); !i.isEnd(); ++i)
+        for(unsigned int j=((*i).firstStateSpecified ? 0 : 1); j<(*i).states.size(); j++)
+            states.push_back((*i).states[j]);
+    if (states.empty())
+        return;
+
+    vector<SliceValue> out;
+    double cycles[4];
+    for(unsigned int function=0; function<4; function++) {
+        CycleMeasurement measurement;
+        for(unsigned int i=0; i<nrMeasurements; i++) {
+            measurement.start();
+            for(unsigned int j=0; j<states.size(); j++) {
+                if (function == 0)
+                    DCLC.directLambda(states[j], out);
+                else if (function == 1)
+                    DCLC.reverseLambda(states[j], out);
+                else if (function == 2)
+                    DCLC.directLambdaAfterTheta(states[j], out);
+                else
+                    DCLC.reverseLambdaBeforeTheta(states[j], out);
+            }
+            measurement.stop();
+        }
+        cycles[function] = (double)measurement.getMinimum()/states.size();
+    }
+    size_t slash = fileName.find_last_of("/\\");
+    cout << setw(44) << left << fileName.substr(slash == string::npos ? 0 : slash+1) << right;
+    cout << setw(7) << states.size();
+    for(unsigned int function=0; function<4; function++)
+        cout << setw(10) << cycles[function];
+    cout << endl;
+}
+
+void benchmarkLambdaOnTrails(const string& directory)
+{
+    cout << "Trail core file                              states  direct λ reverse λ  dir. a.θ  rev. b.θ  (cycles)" << endl;
+    cout << fixed << setprecision(0);
+    for(unsigned int width=25; width<=1600; width*=2)
+    for(unsigned int i=0; i<2; i++) {
+        KeccakFPropagation::DCorLC DCorLC = (i == 0) ? KeccakFPropagation::DC : KeccakFPropagation::LC;
+        string prefix = directory + "/" + ((i == 0) ? "DC" : "LC");
+        stringstream fileName;
+        fileName << prefix << "KeccakF-" << dec << width << "-trailcores";
+        benchmarkLambdaOnTrails(fileName.str(), width, DCorLC);
+        for(unsigned int nrRounds=3; nrRounds<=4; nrRounds++) {
+            stringstream fileNameFSE;
+            fileNameFSE << prefix << "KeccakF-" << dec << width << "-FSE2012-" << nrRounds << "round-trailcores";
+            benchmarkLambdaOnTrails(fileNameFSE.str(), width, DCorLC);
+        }
+    }
+}
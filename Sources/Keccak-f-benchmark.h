@@ -0,0 +1,83 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFBENCHMARK_H_
+#define _KECCAKFBENCHMARK_H_
+
+#include <string>
+
+using namespace std;
+
+/**
+  * Function that measures, for the seven Keccak-<i>f</i> widths, the number
+  * of cycles per byte of the generic template implementation
+  * (KeccakF::forwardGeneric()) and of the unrolled one (KeccakF::operator()).
+  */
+void benchmarkKeccakF();
+
+/**
+  * Function that measures, for the widths 200 to 1600, the number of cycles
+  * per byte of the generic inverse (KeccakF::inverseGeneric()) and of the
+  * unrolled one (KeccakF::inverse()).
+  */
+void benchmarkKeccakFInverse();
+
+/**
+  * Function that compares the number of cycles per byte of Keccak-<i>f</i>[1600]
+  * with 64-bit lanes (KeccakF) and with lanes bit-interleaved in 32-bit words
+  * (KeccakFInterleaved). The comparison is meaningful on 32-bit platforms,
+  * e.g., with the executable built by <code>make KeccakTools32</code>.
+  */
+void benchmarkKeccakFInterleaved();
+
+/**
+  * Function that measures the throughput, in cycles per byte, of
+  * KeccakF::permuteN() on Keccak-<i>f</i>[1600] for batches of 1 to 64 states
+  * and for each SIMD backend supported by the processor.
+  */
+void benchmarkKeccakFParallel();
+
+/**
+  * Function that measures, for the widths 200 to 1600, the number of cycles
+  * per byte of each variant of the code generated by KeccakFCodeGen and
+  * compiled into KeccakFGenerated (schedule type, lane complementing and
+  * early parity), compared to the generic template implementation
+  * (KeccakF::forwardGeneric()) and to the unrolled one (KeccakF::operator()).
+  * It also measures the throughput of the generated code for parallel
+  * instances (KeccakFGeneratedParallel) supported by the processor.
+  * If the tool was built without the generation stage of the makefile,
+  * only the generic and unrolled implementations are measured.
+  */
+void benchmarkKeccakFGenerated();
+
+/**
+  * Function that measures, for the widths 25 to 200, the number of cycles
+  * per byte of the generic template implementation, of the unrolled one
+  * and of the table-based one (KeccakFLUT), with and without the conversion
+  * from and to bytes.
+  */
+void benchmarkKeccakFLUT();
+
+/**
+  * Function that measures the number of cycles of the λ function on states
+  * represented as slices (KeccakFPropagation::directLambda() and
+  * KeccakFPropagation::reverseLambda(), and their parts before and after θ),
+  * averaged over the states of the trail cores in the given directory,
+  * i.e., <code>Example trails</code> by default.
+  * @param  directory   The directory containing the trail core files.
+  */
+void benchmarkLambdaOnTrails(const string& directory = "Example trails");
+
+#endif
@@ -0,0 +1,243 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <cstdio>
+#include <iostream>
+#include <string.h>
+#include "Keccak-f.h"
+#include "Keccak-f25LUT.h"
+#include "Keccak-fAutotune.h"
+#include "Keccak-fGenerated.h"
+#include "Keccak-fInterleaved.h"
+#include "Keccak-fLUT.h"
+#include "Keccak-f-test.h"
+
+using namespace std;
+
+static void fillState(UINT8 *state, unsigned int width, unsigned int seed)
+{
+    unsigned int byteSize = (width+7)/8;
+    for(unsigned int i=0; i<byteSize; i++)
+        state[i] = (UINT8)(seed*151 + i*17 + (i >> 3)*seed);
+    if ((width % 8) != 0)
+        state[byteSize-1] &= (1 << (width % 8)) - 1;
+}
+
+static void checkForward(const KeccakF& keccakF)
+{
+    unsigned int byteSize = (keccakF.getWidth()+7)/8;
+    for(unsigned int seed=0; seed<16; seed++) {
+        UINT8 reference[200], state[200];
+        fillState(reference, keccakF.getWidth(), seed);
+        memcpy(state, reference, byteSize);
+        keccakF.forwardGeneric(reference);
+        keccakF(state);
+        if (memcmp(reference, state, byteSize) != 0)
+            throw KeccakException("The unrolled implementation of " + keccakF.getDescription() + " does not match forward().");
+    }
+}
+
+static void checkInverse(const KeccakF& keccakF)
+{
+    unsigned int byteSize = (keccakF.getWidth()+7)/8;
+    for(unsigned int seed=0; seed<16; seed++) {
+        UINT8 original[200], reference[200], state[200];
+        fillState(original, keccakF.getWidth(), seed);
+        memcpy(reference, original, byteSize);
+        memcpy(state, original, byteSize);
+        keccakF.inverseGeneric(reference);
+        keccakF.inverse(state);
+        if (memcmp(reference, state, byteSize) != 0)
+            throw KeccakException("The unrolled inverse of " + keccakF.getDescription() + " does not match inverse().");
+        keccakF(state);
+        if (memcmp(original, state, byteSize) != 0)
+            throw KeccakException("The unrolled implementation of " + keccakF.getDescription() + " is not the inverse of its unrolled inverse.");
+    }
+}
+
+static void checkTwisted(const KeccakPStar& keccakPStar)
+{
+    unsigned int byteSize = (keccakPStar.getWidth()+7)/8;
+    for(unsigned int seed=0; seed<16; seed++) {
+        UINT8 reference[200], state[200];
+        fillState(reference, keccakPStar.getWidth(), seed);
+        memcpy(state, reference, byteSize);
+        vector<LaneValue> A;
+        keccakPStar.fromBytesToLanes(reference, A);
+        keccakPStar.inversePi(A);
+        keccakPStar.forward(A);
+        keccakPStar.pi(A);
+        keccakPStar.fromLanesToBytes(A, reference);
+        keccakPStar(state);
+        if (memcmp(reference, state, byteSize) != 0)
+            throw KeccakException("The unrolled implementation of " + keccakPStar.getName() + " does not match forward().");
+        keccakPStar.fromBytesToLanes(reference, A);
+        keccakPStar.inversePi(A);
+        keccakPStar.KeccakF::inverse(A);
+        keccakPStar.pi(A);
+        keccakPStar.fromLanesToBytes(A, reference);
+        keccakPStar.inverse(state);
+        if (memcmp(reference, state, byteSize) != 0)
+            throw KeccakException("The unrolled inverse of " + keccakPStar.getName() + " does not match inverse().");
+    }
+    // permuteN() must apply the twisted permutation, not the SIMD backends of Keccak-p
+    const unsigned int n = 9;
+    for(unsigned int b=KeccakFParallelScalar; b<=KeccakFParallelAVX512; b++) {
+        KeccakFParallelBackend backend = (KeccakFParallelBackend)b;
+        if (!isKeccakFParallelBackendSupported(backend))
+            continue;
+        vector<UINT8> reference(n*byteSize), states(n*byteSize);
+        vector<UINT8*> pointers(n);
+        for(unsigned int i=0; i<n; i++) {
+            fillState(&reference[i*byteSize], keccakPStar.getWidth(), 16+i);
+            memcpy(&states[i*byteSize], &reference[i*byteSize], byteSize);
+            pointers[i] = &states[i*byteSize];
+            keccakPStar(&reference[i*byteSize]);
+        }
+        keccakPStar.permuteN(&pointers[0], n, backend);
+        if (memcmp(&reference[0], &states[0], n*byteSize) != 0)
+            throw KeccakException("The " + getKeccakFParallelBackendName(backend) + " permuteN() of " + keccakPStar.getName() + " does not match operator().");
+    }
+}
+
+static void checkParallel(const KeccakF& keccakF)
+{
+    const unsigned int maxN = 21;
+    unsigned int byteSize = (keccakF.getWidth()+7)/8;
+    for(unsigned int b=KeccakFParallelScalar; b<=KeccakFParallelAVX512; b++) {
+        KeccakFParallelBackend backend = (KeccakFParallelBackend)b;
+        if (!isKeccakFParallelBackendSupported(backend))
+            continue;
+        for(unsigned int n=0; n<=maxN; n++) {
+            vector<UINT8> reference(maxN*byteSize), states(maxN*byteSize);
+            vector<UINT8*> pointers(maxN);
+            for(unsigned int i=0; i<n; i++) {
+                fillState(&reference[i*byteSize], keccakF.getWidth(), 7*n+i);
+                memcpy(&states[i*byteSize], &reference[i*byteSize], byteSize);
+                // Reverse the order to check that the pointers are used independently
+                pointers[n-1-i] = &states[i*byteSize];
+                keccakF.forwardGeneric(&reference[i*byteSize]);
+            }
+            keccakF.permuteN(&pointers[0], n, backend);
+            if (memcmp(&reference[0], &states[0], n*byteSize) != 0)
+                throw KeccakException("The " + getKeccakFParallelBackendName(backend) + " implementation of " + keccakF.getDescription() + " does not match forward().");
+        }
+    }
+}
+
+static void checkGenerated(unsigned int width)
+{
+    for(unsigned int scheduleType=1; scheduleType<=2; scheduleType++)
+    for(unsigned int laneComplementing=0; laneComplementing<=1; laneComplementing++)
+    for(unsigned int earlyParity=0; earlyParity<=1; earlyParity++) {
+        if (!KeccakFGenerated::isAvailable(width, scheduleType, laneComplementing != 0, earlyParity != 0))
+            continue;
+        checkForward(KeccakFGenerated(width, scheduleType, laneComplementing != 0, earlyParity != 0));
+        for(unsigned int nrRounds=1; nrRounds<=5; nrRounds++)
+            checkForward(KeccakFGenerated(width, 3-(int)nrRounds, nrRounds, scheduleType, laneComplementing != 0, earlyParity != 0));
+    }
+}
+
+static void checkGeneratedParallel(const KeccakF& keccakF)
+{
+    const unsigned int maxN = 19;
+    const unsigned int byteSize = 200;
+    for(unsigned int n=0; n<=maxN; n++) {
+        vector<UINT8> reference(maxN*byteSize), states(maxN*byteSize);
+        vector<UINT8*> pointers(maxN);
+        for(unsigned int i=0; i<n; i++) {
+            fillState(&reference[i*byteSize], 1600, 5*n+i);
+            memcpy(&states[i*byteSize], &reference[i*byteSize], byteSize);
+            pointers[n-1-i] = &states[i*byteSize];
+            keccakF.forwardGeneric(&reference[i*byteSize]);
+        }
+        keccakF.permuteN(&pointers[0], n);
+        if (memcmp(&reference[0], &states[0], n*byteSize) != 0)
+            throw KeccakException("The generated code of " + keccakF.getName() + " does not match forward().");
+    }
+}
+
+static void checkTuned(unsigned int width)
+{
+    vector<KeccakFTuningChoice> choices(1, KeccakFTuningChoice());
+    for(unsigned int scheduleType=1; scheduleType<=2; scheduleType++)
+    for(unsigned int laneComplementing=0; laneComplementing<=1; laneComplementing++)
+    for(unsigned int earlyParity=0; earlyParity<=1; earlyParity++)
+        if (KeccakFGenerated::isAvailable(width, scheduleType, laneComplementing != 0, earlyParity != 0))
+            choices.push_back(KeccakFTuningChoice(scheduleType, laneComplementing != 0, earlyParity != 0));
+    const KeccakFCodeGenSIMD instructionSets[] = { KeccakFCodeGenSSE2, KeccakFCodeGenAVX2, KeccakFCodeGenAVX512 };
+    for(unsigned int i=0; i<sizeof(instructionSets)/sizeof(instructionSets[0]); i++)
+        if ((width == 1600) && KeccakFGeneratedParallel::isAvailable(instructionSets[i])) {
+            KeccakFTuningChoice choice(choices.back());
+            choice.parallelInstructionSet = instructionSets[i];
+            choices.push_back(choice);
+        }
+    const string fileName = "KeccakF-autotune-test.profile";
+    for(unsigned int i=0; i<choices.size(); i++) {
+        KeccakFTuningProfile saved, loaded;
+        saved.setChoice(width, choices[i]);
+        saved.save(fileName);
+        if (!loaded.load(fileName))
+            throw KeccakException("Could not load " + fileName);
+        KeccakFTuned keccakF(width, -1, 3, loaded);
+        if (keccakF.getChoice().getName() != choices[i].getName())
+            throw KeccakException("KeccakFTuned does not use the implementation " + choices[i].getName() + " given in the profile.");
+        checkForward(keccakF);
+        if (width == 1600)
+            checkGeneratedParallel(keccakF);
+    }
+    remove(fileName.c_str());
+}
+
+void testKeccakFImplementations()
+{
+    for(unsigned int width=25; width<=1600; width*=2) {
+        KeccakF keccakF(width);
+        checkForward(keccakF);
+        checkInverse(keccakF);
+        for(unsigned int nrRounds=1; nrRounds<=keccakF.getNominalNumberOfRounds(); nrRounds++) {
+            checkForward(KeccakP(width, nrRounds));
+            checkForward(KeccakFfirstRounds(width, nrRounds));
+            checkForward(KeccakFanyRounds(width, -(int)nrRounds, 2*nrRounds));
+            checkInverse(KeccakP(width, nrRounds));
+            checkInverse(KeccakFanyRounds(width, -(int)nrRounds, 2*nrRounds));
+            checkTwisted(KeccakPStar(width, nrRounds));
+        }
+        checkParallel(keccakF);
+        checkGenerated(width);
+        checkTuned(width);
+        // The first run generates the 128 MiB table and saves it, later runs map it
+        if (width == 25)
+            checkForward(KeccakF25LUT());
+        if ((width >= 25) && (width <= 200)) {
+            checkForward(KeccakFLUT(width));
+            checkForward(KeccakFLUT(width, -2, 5));
+        }
+        if (width == 1600) {
+            checkParallel(KeccakP(width, 12));
+            checkParallel(KeccakFanyRounds(width, -3, 6));
+            checkForward(KeccakFInterleaved(width));
+            checkForward(KeccakFInterleaved(width, 12, 12));
+            checkForward(KeccakFInterleaved(width, -3, 6));
+            for(unsigned int SIMD=KeccakFCodeGenSSE2; SIMD<=KeccakFCodeGenAVX512; SIMD++) {
+                if (!KeccakFGeneratedParallel::isAvailable((KeccakFCodeGenSIMD)SIMD))
+                    continue;
+                checkGeneratedParallel(KeccakFGeneratedParallel(width, (KeccakFCodeGenSIMD)SIMD));
+                checkGeneratedParallel(KeccakFGeneratedParallel(width, -3, 7, (KeccakFCodeGenSIMD)SIMD));
+            }
+        }
+        cout << keccakF << ": OK" << endl;
+    }
+}
@@ -0,0 +1,27 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFTEST_H_
+#define _KECCAKFTEST_H_
+
+/**
+  * Function that checks that the optimized implementations of the
+  * Keccak-<i>f</i> and Keccak-<i>p</i> permutations give the same results
+  * as the generic template methods KeccakF::forward() and KeccakF::inverse().
+  * It throws a KeccakException in case of mismatch.
+  */
+void testKeccakFImplementations();
+
+#endif
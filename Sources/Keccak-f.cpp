@@ -15,6 +15,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 
 #include <sstream>
 #include "Keccak-f.h"
+#include "Keccak-fUnrolled.h"
 
 using namespace std;
 
@@ -168,7 +169,42 @@ void KeccakF::fromLanesToBytes(const vector<LaneValue>& in, UINT8 *out) const
     }
 }
 
+/** Function that applies the unrolled implementation matching the lane size.
+  * See KeccakFUnrolled::permute() for the parameters.
+  */
+static void permuteUnrolled(unsigned int laneSize, UINT8 *state, const LaneValue *RC, int startRoundIndex, unsigned int nrRounds, bool inverseRounds, bool twisted)
+{
+    switch(laneSize) {
+    case 1:
+        KeccakFUnrolled<UINT32, 1>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    case 2:
+        KeccakFUnrolled<UINT32, 2>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    case 4:
+        KeccakFUnrolled<UINT32, 4>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    case 8:
+        KeccakFUnrolled<UINT32, 8>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    case 16:
+        KeccakFUnrolled<UINT32, 16>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    case 32:
+        KeccakFUnrolled<UINT32, 32>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    case 64:
+        KeccakFUnrolled<UINT64, 64>::permute(state, RC, startRoundIndex, nrRounds, inverseRounds, twisted);
+        break;
+    }
+}
+
 void KeccakF::operator()(UINT8 * state) const
+{
+    permuteUnrolled(laneSize, state, &roundConstants[0], startRoundIndex, nrRounds, false, false);
+}
+
+void KeccakF::forwardGeneric(UINT8 * state) const
 {
     vector<LaneValue> A(25);
     fromBytesToLanes(state, A);
@@ -176,7 +212,36 @@ void KeccakF::operator()(UINT8 * state) const
     fromLanesToBytes(A, state);
 }
 
+void KeccakF::permuteN(UINT8 * const * states, size_t n) const
+{
+    permuteN(states, n, getKeccakFParallelBackend());
+}
+
+void KeccakF::permuteN(UINT8 * const * states, size_t n, KeccakFParallelBackend backend) const
+{
+    size_t i = 0;
+    if ((laneSize == 64) && isPlainKeccakP()) {
+        if (backend == KeccakFParallelAVX512) {
+            for( ; i+8<=n; i+=8)
+                KeccakF1600Parallel(KeccakFParallelAVX512, states+i, &roundConstants[0], startRoundIndex, nrRounds);
+            if (isKeccakFParallelBackendSupported(KeccakFParallelAVX2))
+                backend = KeccakFParallelAVX2;
+        }
+        if (backend == KeccakFParallelAVX2) {
+            for( ; i+4<=n; i+=4)
+                KeccakF1600Parallel(KeccakFParallelAVX2, states+i, &roundConstants[0], startRoundIndex, nrRounds);
+        }
+    }
+    for( ; i<n; i++)
+        (*this)(states[i]);
+}
+
 void KeccakF::inverse(UINT8 * state) const
+{
+    permuteUnrolled(laneSize, state, &roundConstants[0], startRoundIndex, nrRounds, true, false);
+}
+
+void KeccakF::inverseGeneric(UINT8 * state) const
 {
     vector<LaneValue> A(25);
     fromBytesToLanes(state, A);
@@ -336,22 +401,12 @@ KeccakPStar::KeccakPStar(unsigned int aWidth, unsigned int aNrRounds)
 
 void KeccakPStar::operator()(UINT8 * state) const
 {
-    vector<LaneValue> A(25);
-    fromBytesToLanes(state, A);
-    inversePi(A);
-    KeccakF::forward(A);
-    pi(A);
-    fromLanesToBytes(A, state);
+    permuteUnrolled(laneSize, state, &roundConstants[0], startRoundIndex, nrRounds, false, true);
 }
 
 void KeccakPStar::inverse(UINT8 * state) const
 {
-    vector<LaneValue> A(25);
-    fromBytesToLanes(state, A);
-    inversePi(A);
-    KeccakF::inverse(A);
-    pi(A);
-    fromLanesToBytes(A, state);
+    permuteUnrolled(laneSize, state, &roundConstants[0], startRoundIndex, nrRounds, true, true);
 }
 
 string KeccakPStar::getName() const
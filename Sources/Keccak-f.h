@@ -20,6 +20,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #include <string>
 #include <vector>
 #include "transformations.h"
+#include "Keccak-fParallel.h"
 #include <algorithm>
 
 using namespace std;
@@ -98,13 +99,59 @@ public:
     /**
       * Method that applies the Keccak-<i>f</i> permutation onto the parameter
       * @a state.
+      * It uses the unrolled implementation in KeccakFUnrolled,
+      * which does not allocate memory on the heap.
       */
     void operator()(UINT8 * state) const;
+    /**
+      * Method that applies the Keccak-<i>f</i> permutation onto the parameter
+      * @a state using the generic template method forward(),
+      * as a reference for operator().
+      */
+    void forwardGeneric(UINT8 * state) const;
+    /**
+      * Method that applies the Keccak-<i>f</i> permutation onto @a n
+      * independent states. For the width 1600, the states are processed
+      * in groups of 4 or 8 using the fastest SIMD backend available on the
+      * processor (see getKeccakFParallelBackend()); the remaining states,
+      * and all states for the other widths, are processed one by one
+      * with operator(). See also isPlainKeccakP().
+      *
+      * @param  states  An array of @a n pointers to the states.
+      * @param  n       The number of states.
+      */
+    virtual void permuteN(UINT8 * const * states, size_t n) const;
+    /**
+      * Same as permuteN(UINT8 * const *, size_t), but using the given backend
+      * instead of the fastest one. The backend must be supported
+      * (see isKeccakFParallelBackendSupported()).
+      *
+      * @param  states  An array of @a n pointers to the states.
+      * @param  n       The number of states.
+      * @param  backend The backend to use.
+      */
+    virtual void permuteN(UINT8 * const * states, size_t n, KeccakFParallelBackend backend) const;
+    /**
+      * Method that indicates whether operator() computes the plain
+      * Keccak-<i>p</i> permutation with the width and rounds of this instance.
+      * Only then does permuteN() use the SIMD backends; otherwise, it applies
+      * operator() onto each state. A derived class whose operator() computes
+      * another permutation, such as KeccakPStar, must return false.
+      */
+    virtual bool isPlainKeccakP() const { return true; }
     /**
       * Method that applies the inverse of the Keccak-<i>f</i> permutation onto
       * the parameter @a state.
+      * It uses the unrolled implementation in KeccakFUnrolled, where θ<sup>-1</sup>
+      * is computed from the column parities with a precomputed schedule.
       */
     void inverse(UINT8 * state) const;
+    /**
+      * Method that applies the inverse of the Keccak-<i>f</i> permutation onto
+      * the parameter @a state using the generic template method inverse(),
+      * as a reference for inverse(UINT8*).
+      */
+    void inverseGeneric(UINT8 * state) const;
     /**
       * Method that returns a string describing the instance of the Keccak-<i>f</i>
       * permutation.
@@ -471,7 +518,7 @@ private:
 template<class Lane>
 void KeccakF::forward(vector<Lane>& state) const
 {
-    for(unsigned int i=startRoundIndex; i<startRoundIndex+nrRounds; i++)
+    for(int i=startRoundIndex; i<startRoundIndex+(int)nrRounds; i++)
         round(state, i);
 }
 
@@ -757,6 +804,12 @@ public:
       */
     void inverse(UINT8 * state) const;
 
+    /**
+      * Method that returns false, as the twisted permutation is not the plain
+      * Keccak-<i>p</i> computed by the SIMD backends of permuteN().
+      */
+    bool isPlainKeccakP() const { return false; }
+
     string getName() const;
 };
 
@@ -13,70 +13,72 @@ and related or neighboring rights to the source code in this file.
 http://creativecommons.org/publicdomain/zero/1.0/
 */
 
-#include <fstream>
-#include <math.h>
+#include <iostream>
 #include "Keccak-f25LUT.h"
+#include "threads.h"
 
 using namespace std;
 
 KeccakF25LUT::KeccakF25LUT(unsigned int aNrRounds)
-    : KeccakFfirstRounds(25, aNrRounds)
+    : KeccakFfirstRounds(25, aNrRounds), LUT(0)
 {
     generateLUT();
 }
 
 KeccakF25LUT::KeccakF25LUT()
-    : KeccakFfirstRounds(25)
+    : KeccakFfirstRounds(25), LUT(0)
 {
     generateLUT();
 }
 
 void KeccakF25LUT::generateLUT()
 {
-   if (!retrieveLUT()) {
-        cout << "Generating the look-up table..." << flush;
-        vector<LaneValue> lanes(25, 0);
-        LUT.resize(1<<25);
-        for (SliceValue sliceIn=0; sliceIn< (1<<25) ; sliceIn++) {
-            if ((sliceIn & 0xfffff) == 0) cout << " " << floor(sliceIn*100.0/(1<<25)) << "%" << flush;
-            setSlice(lanes, sliceIn);
-            forward(lanes);
-            SliceValue sliceOut = getSlice(lanes);
-            LUT[sliceIn] = sliceOut;
-        }
+    if (!retrieveLUT()) {
+        cout << "Generating the look-up table with " << getNumberOfThreads() << " thread(s)..." << flush;
+        generatedLUT.resize(1<<25);
+        parallelFor(0, 1<<25, [this](UINT64 begin, UINT64 end) {
+            vector<LaneValue> lanes(25, 0);
+            for (SliceValue sliceIn=(SliceValue)begin; sliceIn<(SliceValue)end; sliceIn++) {
+                setSlice(lanes, sliceIn);
+                forward(lanes);
+                generatedLUT[sliceIn] = getSlice(lanes);
+            }
+        });
+        LUT = &generatedLUT[0];
         cout << " done, now saving to disk..." << flush;
-        saveLUT();
-        cout << "and saved." << endl;
+        if (saveLUT() && retrieveLUT()) {
+            vector<SliceValue>().swap(generatedLUT);
+            cout << "and saved." << endl;
+        }
+        else
+            cout << "failed, the table is kept in memory." << endl;
     }
 }
 
-void KeccakF25LUT::saveLUT() const
+bool KeccakF25LUT::saveLUT() const
 {
-    string fileName = buildFileName("", ".LUT");
-    ofstream fout(fileName.c_str(), ios::binary);
-    for (SliceValue i=0 ; i<(1<<25); i++) {
-        static unsigned char tmp[4];
-        tmp[0] =  LUT[i]&0xFF;
-        tmp[1] = (LUT[i]>>8)&0xFF;
-        tmp[2] = (LUT[i]>>16)&0xFF;
-        tmp[3] = (LUT[i]>>24)&0xFF;
-        fout.write((char *)tmp, 4);
-    }
+    return MappedTable::save(buildFileName("", ".LUT"), "KeccakF25LUT", width, nrRounds, LUTVersion,
+        LUT, (UINT64)sizeof(SliceValue) << 25);
 }
 
 bool KeccakF25LUT::retrieveLUT()
 {
-    string fileName = buildFileName("", ".LUT");
-    ifstream fin(fileName.c_str(), ios::binary);
-    if (!fin) return false;
-    LUT.resize(1<<25);
-    for (SliceValue i=0 ; i<(1<<25); i++) {
-        static unsigned char tmp[4];
-        fin.read((char *)tmp, 4);
-        LUT[i]  = tmp[3];  LUT[i] <<= 8;
-        LUT[i] ^= tmp[2];  LUT[i] <<= 8;
-        LUT[i] ^= tmp[1];  LUT[i] <<= 8;
-        LUT[i] ^= tmp[0];
+    if (!mappedLUT.open(buildFileName("", ".LUT"), "KeccakF25LUT", width, nrRounds, LUTVersion))
+        return false;
+    if (mappedLUT.getSize() != ((UINT64)sizeof(SliceValue) << 25)) {
+        mappedLUT.close();
+        return false;
     }
+    LUT = (const SliceValue *)mappedLUT.getData();
     return true;
 }
+
+void KeccakF25LUT::operator()(UINT8 * state) const
+{
+    SliceValue slice = state[0] ^ ((SliceValue)state[1] << 8) ^ ((SliceValue)state[2] << 16) ^ ((SliceValue)(state[3] & 1) << 24);
+    slice = LUT[slice];
+    state[0] = (UINT8)slice;
+    state[1] = (UINT8)(slice >> 8);
+    state[2] = (UINT8)(slice >> 16);
+    state[3] = (UINT8)(slice >> 24);
+}
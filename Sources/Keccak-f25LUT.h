@@ -19,6 +19,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #include <vector>
 #include "Keccak-f.h"
 #include "Keccak-fParts.h"
+#include "mappedtable.h"
 
 using namespace std;
 
@@ -28,16 +29,23 @@ using namespace std;
 class KeccakF25LUT : public KeccakFfirstRounds {
 public:
     /**
-      * Attribute containing the lookup table for Keccak-<i>f</i>[25].
-      * It is generated by generateLUT() or loaded from disk by retrieveLUT().
+      * Attribute pointing to the lookup table for Keccak-<i>f</i>[25], with 2<sup>25</sup> entries.
+      * It is generated by generateLUT() or mapped from disk by retrieveLUT().
       */
-    vector<SliceValue> LUT;
+    const SliceValue *LUT;
+protected:
+    /** The file containing the lookup table, mapped into memory. */
+    MappedTable mappedLUT;
+    /** The lookup table, if it could not be mapped from disk. */
+    vector<SliceValue> generatedLUT;
+    /** The version of the format of the lookup table file. */
+    static const unsigned int LUTVersion = 1;
 public:
     /**
       * The constructor, for which the width is fixed to 25. It generates a lookup table
       * for the Keccak-<i>f</i>[25] permutation with a given number of rounds.
       * When done, the lookup table is saved to disk.
-      * If the lookup table exists on disk, it is retrieved instead of being generated.
+      * If the lookup table exists on disk, it is mapped into memory instead of being generated.
       * See KeccakF() for more details.
       */
     KeccakF25LUT(unsigned int aNrRounds);
@@ -45,17 +53,23 @@ public:
       * The constructor, with the nominal number of rounds.
       */
     KeccakF25LUT();
+    /**
+      * Method that applies the permutation onto the parameter @a state,
+      * with one look-up.
+      */
+    void operator()(UINT8 * state) const;
 protected:
     /**
       * Method that saves the lookup table to a file with extension '.LUT'.
       */
-    void saveLUT() const;
+    bool saveLUT() const;
     /**
-      * Method that retrieves the lookup table from a file with extension '.LUT'.
+      * Method that maps the lookup table from a file with extension '.LUT'.
       */
     bool retrieveLUT();
     /**
-      * Method that generates the actual lookup table.
+      * Method that generates the actual lookup table, using several threads,
+      * and then maps it from disk.
       */
     void generateLUT();
 };
@@ -0,0 +1,305 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include <vector>
+#include "Keccak-fAutotune.h"
+#include "timing.h"
+
+using namespace std;
+
+KeccakFTuningChoice::KeccakFTuningChoice()
+    : generated(false), scheduleType(1), laneComplementing(false), earlyParity(false), cyclesPerByte(0),
+    parallelInstructionSet(KeccakFCodeGenNoSIMD)
+{
+}
+
+KeccakFTuningChoice::KeccakFTuningChoice(unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity)
+    : generated(true), scheduleType(aScheduleType), laneComplementing(aLaneComplementing),
+    earlyParity(anEarlyParity), cyclesPerByte(0), parallelInstructionSet(KeccakFCodeGenNoSIMD)
+{
+}
+
+string KeccakFTuningChoice::getName() const
+{
+    stringstream a;
+    if (!generated)
+        a << "unrolled";
+    else {
+        a << "gen-s" << dec << scheduleType;
+        if (laneComplementing)
+            a << "-lc";
+        if (earlyParity)
+            a << "-ep";
+    }
+    if (parallelInstructionSet != KeccakFCodeGenNoSIMD)
+        a << "+" << KeccakFGeneratedParallel::getInstructionSetName(parallelInstructionSet);
+    return a.str();
+}
+
+static const KeccakFCodeGenSIMD parallelInstructionSets[] = { KeccakFCodeGenSSE2, KeccakFCodeGenAVX2, KeccakFCodeGenAVX512 };
+
+const string KeccakFTuningProfile::defaultFileName = "KeccakF-autotune.profile";
+
+void KeccakFTuningProfile::setChoice(unsigned int width, const KeccakFTuningChoice& choice)
+{
+    choices[width] = choice;
+}
+
+bool KeccakFTuningProfile::getChoice(unsigned int width, KeccakFTuningChoice& choice) const
+{
+    map<unsigned int, KeccakFTuningChoice>::const_iterator i = choices.find(width);
+    if (i == choices.end())
+        return false;
+    choice = i->second;
+    return true;
+}
+
+void KeccakFTuningProfile::save(const string& fileName) const
+{
+    ofstream fout(fileName.c_str());
+    if (!fout)
+        throw KeccakException("KeccakFTuningProfile::save(): could not open " + fileName);
+    for(map<unsigned int, KeccakFTuningChoice>::const_iterator i=choices.begin(); i!=choices.end(); ++i) {
+        const KeccakFTuningChoice& choice = i->second;
+        fout << dec << i->first;
+        if (choice.generated)
+            fout << " generated " << choice.scheduleType << " "
+                << (choice.laneComplementing ? 1 : 0) << " " << (choice.earlyParity ? 1 : 0);
+        else
+            fout << " unrolled";
+        fout << " " << choice.cyclesPerByte;
+        if (choice.parallelInstructionSet != KeccakFCodeGenNoSIMD)
+            fout << " parallel " << KeccakFGeneratedParallel::getInstructionSetName(choice.parallelInstructionSet);
+        fout << endl;
+    }
+}
+
+bool KeccakFTuningProfile::load(const string& fileName)
+{
+    ifstream fin(fileName.c_str());
+    if (!fin)
+        return false;
+    string line;
+    while(getline(fin, line)) {
+        if (line.empty())
+            continue;
+        stringstream a(line);
+        unsigned int width;
+        string type;
+        KeccakFTuningChoice choice;
+        a >> width >> type;
+        if (type == "generated") {
+            unsigned int laneComplementing, earlyParity;
+            a >> choice.scheduleType >> laneComplementing >> earlyParity;
+            choice.generated = true;
+            choice.laneComplementing = (laneComplementing != 0);
+            choice.earlyParity = (earlyParity != 0);
+        }
+        else if (type != "unrolled")
+            throw KeccakException("KeccakFTuningProfile::load(): unknown implementation in " + fileName);
+        a >> choice.cyclesPerByte;
+        if (a.fail())
+            throw KeccakException("KeccakFTuningProfile::load(): malformed line in " + fileName);
+        string keyword, instructionSet;
+        if (a >> keyword) {
+            a >> instructionSet;
+            bool found = false;
+            for(unsigned int i=0; i<sizeof(parallelInstructionSets)/sizeof(parallelInstructionSets[0]); i++)
+                if (instructionSet == KeccakFGeneratedParallel::getInstructionSetName(parallelInstructionSets[i])) {
+                    choice.parallelInstructionSet = parallelInstructionSets[i];
+                    found = true;
+                }
+            if ((keyword != "parallel") || !found)
+                throw KeccakException("KeccakFTuningProfile::load(): malformed line in " + fileName);
+        }
+        choices[width] = choice;
+    }
+    return true;
+}
+
+static KeccakFTuningProfile loadDefaultProfile()
+{
+    KeccakFTuningProfile profile;
+    try {
+        profile.load(KeccakFTuningProfile::defaultFileName);
+    }
+    catch(KeccakException&) {
+        // A malformed profile must not prevent hashing: fall back to the unrolled implementation
+        profile = KeccakFTuningProfile();
+    }
+    return profile;
+}
+
+const KeccakFTuningProfile& KeccakFTuningProfile::getDefault()
+{
+    static const KeccakFTuningProfile profile = loadDefaultProfile();
+    return profile;
+}
+
+KeccakFTuned::KeccakFTuned(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds)
+    : KeccakF(aWidth, aStartRoundIndex, aNrRounds)
+{
+    initializeChoice(KeccakFTuningProfile::getDefault());
+}
+
+KeccakFTuned::KeccakFTuned(unsigned int aWidth)
+    : KeccakF(aWidth)
+{
+    initializeChoice(KeccakFTuningProfile::getDefault());
+}
+
+KeccakFTuned::KeccakFTuned(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds, const KeccakFTuningProfile& profile)
+    : KeccakF(aWidth, aStartRoundIndex, aNrRounds)
+{
+    initializeChoice(profile);
+}
+
+void KeccakFTuned::initializeChoice(const KeccakFTuningProfile& profile)
+{
+    kernel = 0;
+    parallelKernel = 0;
+    parallelism = 1;
+    if (!profile.getChoice(width, choice))
+        choice = KeccakFTuningChoice();
+    if (choice.generated)
+        kernel = KeccakFGenerated::getKernel(width, choice.scheduleType, choice.laneComplementing, choice.earlyParity);
+    if (kernel == 0) {
+        choice.generated = false;
+        choice.scheduleType = 1;
+        choice.laneComplementing = false;
+        choice.earlyParity = false;
+    }
+    if ((width == 1600) && (choice.parallelInstructionSet != KeccakFCodeGenNoSIMD))
+        parallelKernel = KeccakFGeneratedParallel::getKernel(choice.parallelInstructionSet, parallelism);
+    if (parallelKernel == 0) {
+        choice.parallelInstructionSet = KeccakFCodeGenNoSIMD;
+        parallelism = 1;
+    }
+}
+
+void KeccakFTuned::operator()(UINT8 * state) const
+{
+    if (kernel != 0)
+        kernel(state, startRoundIndex, nrRounds);
+    else
+        KeccakF::operator()(state);
+}
+
+void KeccakFTuned::permuteN(UINT8 * const * states, size_t n) const
+{
+    if (parallelKernel == 0) {
+        permuteN(states, n, getKeccakFParallelBackend());
+        return;
+    }
+    size_t i = 0;
+    for( ; i+parallelism<=n; i+=parallelism)
+        parallelKernel(states+i, startRoundIndex, nrRounds);
+    for( ; i<n; i++)
+        (*this)(states[i]);
+}
+
+static double measurePermuteNCyclesPerByte(const Permutation& f, unsigned int width)
+{
+    const unsigned int nrMeasurements = 200;
+    const unsigned int nrStates = 8;
+    vector<UINT8> buffer(nrStates*200, 0);
+    UINT8 *states[nrStates];
+    for(unsigned int i=0; i<nrStates; i++)
+        states[i] = &buffer[i*200];
+    CycleMeasurement measurement;
+    for(unsigned int i=0; i<nrMeasurements; i++) {
+        measurement.start();
+        f.permuteN(states, nrStates);
+        measurement.stop();
+    }
+    return (double)measurement.getMinimum()/nrStates/((width+7)/8);
+}
+
+static double measureCyclesPerByte(const Permutation& f, unsigned int width)
+{
+    const unsigned int nrMeasurements = 500;
+    const unsigned int nrCallsPerMeasurement = 8;
+    UINT8 state[200];
+    memset(state, 0, sizeof(state));
+    CycleMeasurement measurement;
+    for(unsigned int i=0; i<nrMeasurements; i++) {
+        measurement.start();
+        for(unsigned int j=0; j<nrCallsPerMeasurement; j++)
+            f(state);
+        measurement.stop();
+    }
+    return (double)measurement.getMinimum()/nrCallsPerMeasurement/((width+7)/8);
+}
+
+KeccakFTuningChoice autotuneKeccakF(unsigned int width, bool verbose)
+{
+    KeccakF keccakF(width);
+    KeccakFTuningChoice best;
+    best.cyclesPerByte = measureCyclesPerByte(keccakF, width);
+    if (verbose) {
+        cout << keccakF << endl;
+        cout << fixed << setprecision(2);
+        cout << setw(16) << left << best.getName() << right << setw(8) << best.cyclesPerByte << " c/B" << endl;
+    }
+    for(unsigned int scheduleType=1; scheduleType<=2; scheduleType++)
+    for(unsigned int laneComplementing=0; laneComplementing<=1; laneComplementing++)
+    for(unsigned int earlyParity=0; earlyParity<=1; earlyParity++) {
+        if (!KeccakFGenerated::isAvailable(width, scheduleType, laneComplementing != 0, earlyParity != 0))
+            continue;
+        KeccakFTuningChoice candidate(scheduleType, laneComplementing != 0, earlyParity != 0);
+        KeccakFGenerated generated(width, scheduleType, laneComplementing != 0, earlyParity != 0);
+        candidate.cyclesPerByte = measureCyclesPerByte(generated, width);
+        if (verbose)
+            cout << setw(16) << left << candidate.getName() << right << setw(8) << candidate.cyclesPerByte << " c/B" << endl;
+        if (candidate.cyclesPerByte < best.cyclesPerByte)
+            best = candidate;
+    }
+    if (width == 1600) {
+        double bestParallel = measurePermuteNCyclesPerByte(keccakF, width);
+        if (verbose)
+            cout << setw(16) << left << "permuteN" << right << setw(8) << bestParallel << " c/B" << endl;
+        for(unsigned int i=0; i<sizeof(parallelInstructionSets)/sizeof(parallelInstructionSets[0]); i++) {
+            if (!KeccakFGeneratedParallel::isAvailable(parallelInstructionSets[i]))
+                continue;
+            KeccakFGeneratedParallel generated(width, parallelInstructionSets[i]);
+            double cyclesPerByte = measurePermuteNCyclesPerByte(generated, width);
+            if (verbose)
+                cout << setw(16) << left << ("permuteN-" + KeccakFGeneratedParallel::getInstructionSetName(parallelInstructionSets[i]))
+                    << right << setw(8) << cyclesPerByte << " c/B" << endl;
+            if (cyclesPerByte < bestParallel) {
+                bestParallel = cyclesPerByte;
+                best.parallelInstructionSet = parallelInstructionSets[i];
+            }
+        }
+    }
+    if (verbose)
+        cout << "Fastest: " << best.getName() << endl << endl;
+    return best;
+}
+
+void autotuneKeccakF(const string& fileName)
+{
+    KeccakFTuningProfile profile;
+    profile.load(fileName);
+    for(unsigned int width=200; width<=1600; width*=2)
+        profile.setChoice(width, autotuneKeccakF(width));
+    profile.save(fileName);
+    cout << "Profile written to " << fileName << endl;
+}
@@ -0,0 +1,180 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFAUTOTUNE_H_
+#define _KECCAKFAUTOTUNE_H_
+
+#include <map>
+#include "Keccak-fGenerated.h"
+
+using namespace std;
+
+/**
+  * Class that describes one implementation of Keccak-<i>f</i> among which
+  * the autotuner chooses: either the unrolled implementation of
+  * KeccakF::operator(), or one variant of the generated code (see KeccakFGenerated).
+  */
+class KeccakFTuningChoice {
+public:
+    /** If false, the unrolled implementation is chosen and the other attributes are ignored. */
+    bool generated;
+    /** The schedule type of the generated code, 1 or 2. */
+    unsigned int scheduleType;
+    /** Whether the generated code uses lane complementing. */
+    bool laneComplementing;
+    /** Whether the generated code uses early parity. */
+    bool earlyParity;
+    /** The number of cycles per byte measured by the autotuner, for information. */
+    double cyclesPerByte;
+    /** The instruction set of the generated code for several instances used by permuteN()
+      * (see KeccakFGeneratedParallel), or KeccakFCodeGenNoSIMD to use KeccakF::permuteN(). */
+    KeccakFCodeGenSIMD parallelInstructionSet;
+public:
+    /**
+      * The constructor, which designates the unrolled implementation.
+      */
+    KeccakFTuningChoice();
+    /**
+      * The constructor, which designates a variant of the generated code.
+      */
+    KeccakFTuningChoice(unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity);
+    /**
+      * Method that returns a short description of the choice,
+      * e.g., "unrolled", "gen-s1-lc-ep" or "gen-s1-lc-ep+avx2".
+      */
+    string getName() const;
+};
+
+/**
+  * Class that contains, for each width, the fastest implementation of
+  * Keccak-<i>f</i> found on the host by autotuneKeccakF().
+  * It is saved as a text file with one line per width, e.g.,
+  * <pre>1600 generated 2 1 1 4.56</pre>
+  * for the generated variant with schedule type 2, lane complementing
+  * and early parity, measured at 4.56 cycles per byte, or
+  * <pre>1600 unrolled 5.21</pre>
+  * for the unrolled implementation. A line may end with, e.g.,
+  * <pre>parallel avx2</pre>
+  * if permuteN() is faster with the generated code for several instances.
+  */
+class KeccakFTuningProfile {
+protected:
+    /** The choices, indexed by width. */
+    map<unsigned int, KeccakFTuningChoice> choices;
+public:
+    /** The name of the file that holds the profile of the host,
+      * which is loaded by getDefault() and written by autotuneKeccakF(). */
+    static const string defaultFileName;
+    /**
+      * Method that sets the choice for the given width.
+      */
+    void setChoice(unsigned int width, const KeccakFTuningChoice& choice);
+    /**
+      * Method that retrieves the choice for the given width.
+      *
+      * @return true if the profile contains a choice for this width.
+      */
+    bool getChoice(unsigned int width, KeccakFTuningChoice& choice) const;
+    /**
+      * Method that saves the profile into the file @a fileName.
+      */
+    void save(const string& fileName) const;
+    /**
+      * Method that loads the profile from the file @a fileName,
+      * replacing the choices for the widths it contains.
+      * An exception is thrown if the file is malformed.
+      *
+      * @return false if the file could not be opened.
+      */
+    bool load(const string& fileName);
+    /**
+      * Function that returns the profile of the host, loaded from
+      * defaultFileName the first time it is called.
+      * If the file does not exist or is malformed, the profile is empty.
+      */
+    static const KeccakFTuningProfile& getDefault();
+};
+
+/**
+  * Class implementing Keccak-<i>f</i> (or a range of its rounds) with the
+  * implementation chosen for its width in a KeccakFTuningProfile,
+  * by default the profile of the host (KeccakFTuningProfile::getDefault()).
+  * If the profile has no choice for the width, or if the chosen variant
+  * of the generated code is not compiled into the tool, the unrolled
+  * implementation of KeccakF::operator() is used.
+  * Keccak and ReducedRoundKeccak use this class as their permutation.
+  */
+class KeccakFTuned : public KeccakF {
+protected:
+    /** The chosen implementation. */
+    KeccakFTuningChoice choice;
+    /** The compiled function implementing the choice, or 0 for the unrolled implementation. */
+    KeccakFGeneratedKernel kernel;
+    /** The compiled function for several instances used by permuteN(), or 0 for KeccakF::permuteN(). */
+    KeccakFGeneratedParallelKernel parallelKernel;
+    /** The number of states processed by one call to parallelKernel. */
+    unsigned int parallelism;
+public:
+    /**
+      * The constructor, using the profile of the host.
+      * See KeccakF(unsigned int, int, unsigned int) for the parameters.
+      */
+    KeccakFTuned(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds);
+    /**
+      * The constructor, using the profile of the host and the nominal number of rounds.
+      */
+    KeccakFTuned(unsigned int aWidth);
+    /**
+      * The constructor, using the given profile.
+      */
+    KeccakFTuned(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds, const KeccakFTuningProfile& profile);
+    /**
+      * Method that applies the permutation onto the parameter @a state.
+      */
+    void operator()(UINT8 * state) const;
+    /**
+      * Method that applies the permutation onto @a n states, with the generated
+      * code for several instances if the profile chose it, otherwise as
+      * permuteN(UINT8 * const *, size_t, KeccakFParallelBackend) with the backend of the processor.
+      */
+    void permuteN(UINT8 * const * states, size_t n) const;
+    using KeccakF::permuteN;
+    /**
+      * Method that returns the chosen implementation.
+      */
+    const KeccakFTuningChoice& getChoice() const { return choice; }
+protected:
+    void initializeChoice(const KeccakFTuningProfile& profile);
+};
+
+/**
+  * Function that measures, on the host, the unrolled implementation and
+  * each variant of the generated code compiled into the tool for the given
+  * width, and that returns the fastest one. For the width 1600, it also
+  * compares KeccakF::permuteN() with the generated code for several instances.
+  *
+  * @param  width   The width of Keccak-<i>f</i>, from 25 to 1600.
+  * @param  verbose If true, the measurements are displayed.
+  */
+KeccakFTuningChoice autotuneKeccakF(unsigned int width, bool verbose = true);
+
+/**
+  * Function that runs autotuneKeccakF() for the widths 200 to 1600
+  * and saves the result into the file @a fileName,
+  * which is by default the one loaded by KeccakFTuned.
+  */
+void autotuneKeccakF(const string& fileName = KeccakFTuningProfile::defaultFileName);
+
+#endif
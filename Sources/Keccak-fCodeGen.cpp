@@ -13,6 +13,7 @@ and related or neighboring rights to the source code in this file.
 http://creativecommons.org/publicdomain/zero/1.0/
 */
 
+#include <fstream>
 #include <iostream>
 #include <sstream>
 #include "Keccak-fCodeGen.h"
@@ -22,7 +23,7 @@ using namespace std;
 KeccakFCodeGen::KeccakFCodeGen(unsigned int aWidth)
     : KeccakF(aWidth), interleavingFactor(1),
     wordSize(laneSize), outputMacros(false), outputSubscripts(false),
-    scheduleType(1)
+    scheduleType(1), SIMDInstructionSet(KeccakFCodeGenNoSIMD)
 {
 }
 
@@ -48,6 +49,27 @@ void KeccakFCodeGen::setScheduleType(unsigned int aScheduleType)
         scheduleType = aScheduleType;
 }
 
+void KeccakFCodeGen::setSIMDInstructionSet(KeccakFCodeGenSIMD aSIMDInstructionSet)
+{
+    if ((aSIMDInstructionSet != KeccakFCodeGenNoSIMD) && (wordSize != 64))
+        throw KeccakException("KeccakFCodeGen: the SIMD instruction sets are only available for 64-bit words.");
+    SIMDInstructionSet = aSIMDInstructionSet;
+}
+
+unsigned int KeccakFCodeGen::getNumberOfInstances() const
+{
+    switch(SIMDInstructionSet) {
+        case KeccakFCodeGenSSE2:
+            return 2;
+        case KeccakFCodeGenAVX2:
+            return 4;
+        case KeccakFCodeGenAVX512:
+            return 8;
+        default:
+            return 1;
+    }
+}
+
 void KeccakFCodeGen::displayRoundConstants()
 {
     for(unsigned int i=0; i<roundConstants.size(); ++i) {
@@ -148,7 +170,7 @@ void KeccakFCodeGen::genDeclarationsLanes(ostream& fout, const string& prefixSym
     for(unsigned int y=0; y<5; y++)
     for(unsigned int z=0; z<interleavingFactor; z++) {
         fout << "    ";
-        fout << (outputMacros ? "V" : "UINT") << dec << wordSize << " ";
+        fout << getWordType() << " ";
         for(unsigned int x=0; x<5; x++) {
             fout << buildWordName(prefixSymbol, x, y, z);
             if (x < 4)
@@ -162,7 +184,7 @@ void KeccakFCodeGen::genDeclarationsSheets(ostream& fout, const string& prefixSy
 {
     for(unsigned int z=0; z<interleavingFactor; z++) {
         fout << "    ";
-        fout << (outputMacros ? "V" : "UINT") << dec << wordSize << " ";
+        fout << getWordType() << " ";
         for(unsigned int x=0; x<5; x++) {
             fout << buildWordName(prefixSymbol, x, z);
             if (x < 4)
@@ -505,7 +527,7 @@ void KeccakFCodeGen::genCopyFromStateAndXor(ostream& fout, unsigned int bitsToXo
     for(unsigned int y=0; y<5; y++)
     for(unsigned int x=0; x<5; x++)
     for(unsigned int z=0; z<interleavingFactor; z++) {
-        if (outputMacros) {
+        if (outputMacros && (SIMDInstructionSet == KeccakFCodeGenNoSIMD)) {
             fout << "    " << buildWordName(A, x, y, z);
             fout << " = ";
             if (i*wordSize < bitsToXor)
@@ -523,12 +545,16 @@ void KeccakFCodeGen::genCopyFromStateAndXor(ostream& fout, unsigned int bitsToXo
         }
         else {
             fout << "    " << buildWordName(A, x, y, z);
-            fout << " = " << state << "[";
-            fout.width(2); fout.fill(' '); fout << dec << i << "]";
-            if (i*wordSize < bitsToXor) {
-                fout << "^" << input << "[";
-                fout.width(2); fout.fill(' '); fout << dec << i << "]";
-            }
+            stringstream stateWord, inputWord;
+            stateWord << state << "[";
+            stateWord.width(2); stateWord.fill(' '); stateWord << dec << i << "]";
+            inputWord << input << "[";
+            inputWord.width(2); inputWord.fill(' '); inputWord << dec << i << "]";
+            fout << " = ";
+            if (i*wordSize < bitsToXor)
+                fout << strXOR(stateWord.str(), inputWord.str());
+            else
+                fout << stateWord.str();
         }
         fout << "; \\" << endl;
         i++;
@@ -543,7 +569,7 @@ void KeccakFCodeGen::genCopyToState(ostream& fout, string A, string state, strin
     for(unsigned int y=0; y<5; y++)
     for(unsigned int x=0; x<5; x++)
     for(unsigned int z=0; z<interleavingFactor; z++) {
-        if (outputMacros) {
+        if (outputMacros && (SIMDInstructionSet == KeccakFCodeGenNoSIMD)) {
             fout << "    STORE" << dec << wordSize << "(" << state << "[";
             fout.width(2); fout.fill(' '); fout << dec << i << "], ";
             fout << buildWordName(A, x, y, z);
@@ -639,10 +665,155 @@ void KeccakFCodeGen::genMacroFile(ostream& fout, bool laneComplementing) const
     genCopyStateVariables(fout);
 }
 
+void KeccakFCodeGen::genKernelMacroFile(ostream& fout, bool laneComplementing) const
+{
+    genMacroFile(fout, laneComplementing);
+    fout << "#define prepareThetaOf(A) \\" << endl;
+    genCodeForPrepareTheta(fout, "A##", "C");
+}
+
+void genKeccakFKernels(const string& directory)
+{
+    const string macroNames[] = { "declareABCDE", "prepareTheta", "prepareThetaOf",
+        "thetaRhoPiChiIotaPrepareTheta", "thetaRhoPiChiIota",
+        "copyFromStateAndXor576bits", "copyFromStateAndXor832bits",
+        "copyFromStateAndXor1024bits", "copyFromStateAndXor1088bits",
+        "copyFromStateAndXor1152bits", "copyFromStateAndXor1344bits",
+        "copyFromState", "copyToState", "copyStateVariables", "UseBebigokimisa" };
+    const unsigned int nrMacroNames = sizeof(macroNames)/sizeof(macroNames[0]);
+    stringstream table;
+
+    string indexFileName = directory + "/KeccakF-kernels.inc";
+    ofstream findex(indexFileName.c_str());
+    if (!findex)
+        throw KeccakException("genKeccakFKernels: could not open " + indexFileName);
+    findex << "// Code automatically generated by KeccakTools!" << endl;
+    findex << "// It is included by Keccak-fGenerated.cpp, which defines KeccakFGeneratedKernels()." << endl;
+    findex << endl;
+    for(unsigned int width=200; width<=1600; width*=2)
+    for(unsigned int scheduleType=1; scheduleType<=2; scheduleType++)
+    for(unsigned int laneComplementing=0; laneComplementing<=1; laneComplementing++) {
+        KeccakFCodeGen keccakF(width);
+        keccakF.setScheduleType(scheduleType);
+
+        stringstream suffix;
+        suffix << "-s" << dec << scheduleType << (laneComplementing ? "-lc" : "");
+        string fileName = keccakF.buildFileName("", suffix.str() + ".macros");
+        string pathName = directory + "/" + fileName;
+        ofstream fout(pathName.c_str());
+        if (!fout)
+            throw KeccakException("genKeccakFKernels: could not open " + pathName);
+        keccakF.genKernelMacroFile(fout, laneComplementing != 0);
+
+        stringstream space;
+        space << "KeccakF" << dec << width << "_s" << scheduleType << (laneComplementing ? "_lc" : "");
+        findex << "namespace " << space.str() << " {" << endl;
+        if (laneComplementing)
+            findex << "#define UseBebigokimisa" << endl;
+        findex << "#include \"" << fileName << "\"" << endl;
+        findex << "KeccakFGeneratedKernels(UINT" << dec << width/25 << ", " << (laneComplementing ? "true" : "false") << ")" << endl;
+        for(unsigned int i=0; i<nrMacroNames; i++)
+            findex << "#undef " << macroNames[i] << endl;
+        findex << "}" << endl;
+        findex << endl;
+
+        for(unsigned int earlyParity=0; earlyParity<=1; earlyParity++) {
+            table << "    { " << dec << width << ", " << scheduleType << ", ";
+            table << (laneComplementing ? "true" : "false") << ", ";
+            table << (earlyParity ? "true" : "false") << ", ";
+            table << space.str() << "::" << (earlyParity ? "permuteWithEarlyParity" : "permuteWithoutEarlyParity");
+            table << " }," << endl;
+        }
+    }
+    findex << "static const KeccakFGeneratedKernelEntry generatedKernels[] = {" << endl;
+    findex << table.str();
+    findex << "};" << endl;
+    findex << endl;
+
+    const KeccakFCodeGenSIMD instructionSets[3] = { KeccakFCodeGenSSE2, KeccakFCodeGenAVX2, KeccakFCodeGenAVX512 };
+    const string instructionSetNames[3] = { "sse2", "avx2", "avx512" };
+    const string vectorTypes[3] = { "__m128i", "__m256i", "__m512i" };
+    const string targets[3] = { "KeccakFGenerated_TARGET_SSE2", "KeccakFGenerated_TARGET_AVX2", "KeccakFGenerated_TARGET_AVX512" };
+    stringstream parallelTable;
+    findex << "#ifdef KeccakFGenerated_x86" << endl;
+    for(unsigned int i=0; i<3; i++) {
+        KeccakFCodeGen keccakF(1600);
+        keccakF.setSIMDInstructionSet(instructionSets[i]);
+
+        string fileName = keccakF.buildFileName("", "-" + instructionSetNames[i] + ".macros");
+        string pathName = directory + "/" + fileName;
+        ofstream fout(pathName.c_str());
+        if (!fout)
+            throw KeccakException("genKeccakFKernels: could not open " + pathName);
+        keccakF.genKernelMacroFile(fout);
+
+        string space = "KeccakF1600_" + instructionSetNames[i];
+        findex << "namespace " << space << " {" << endl;
+        findex << "#include \"" << fileName << "\"" << endl;
+        findex << "KeccakFGeneratedParallelKernel(" << vectorTypes[i] << ", " << dec << keccakF.getNumberOfInstances();
+        findex << ", " << targets[i] << ")" << endl;
+        for(unsigned int j=0; j<nrMacroNames; j++)
+            findex << "#undef " << macroNames[j] << endl;
+        findex << "}" << endl;
+        findex << endl;
+
+        parallelTable << "    { " << (unsigned int)instructionSets[i] << ", " << dec << keccakF.getNumberOfInstances() << ", ";
+        parallelTable << space << "::permute }," << endl;
+    }
+    findex << "#endif" << endl;
+    findex << endl;
+    findex << "static const KeccakFGeneratedParallelKernelEntry generatedParallelKernels[] = {" << endl;
+    findex << "#ifdef KeccakFGenerated_x86" << endl;
+    findex << parallelTable.str();
+    findex << "#endif" << endl;
+    findex << "    { 0, 0, 0 }" << endl;
+    findex << "};" << endl;
+}
+
+string KeccakFCodeGen::getWordType() const
+{
+    stringstream str;
+
+    switch(SIMDInstructionSet) {
+        case KeccakFCodeGenSSE2:
+            return "__m128i";
+        case KeccakFCodeGenAVX2:
+            return "__m256i";
+        case KeccakFCodeGenAVX512:
+            return "__m512i";
+        default:
+            str << (outputMacros ? "V" : "UINT") << dec << wordSize;
+            return str.str();
+    }
+}
+
+string KeccakFCodeGen::strSIMD(const string& operation) const
+{
+    switch(SIMDInstructionSet) {
+        case KeccakFCodeGenSSE2:
+            return "_mm_" + operation + "_si128";
+        case KeccakFCodeGenAVX2:
+            return "_mm256_" + operation + "_si256";
+        default:
+            return "_mm512_" + operation + "_si512";
+    }
+}
+
 string KeccakFCodeGen::strROL(const string& symbol, unsigned int amount) const
 {
     stringstream str;
 
+    if ((SIMDInstructionSet != KeccakFCodeGenNoSIMD) && (amount > 0)) {
+        if (SIMDInstructionSet == KeccakFCodeGenAVX512)
+            str << "_mm512_rol_epi64(" << symbol << ", " << dec << amount << ")";
+        else {
+            string prefix = (SIMDInstructionSet == KeccakFCodeGenSSE2) ? "_mm_" : "_mm256_";
+            str << strSIMD("or") << "(";
+            str << prefix << "slli_epi64(" << symbol << ", " << dec << amount << "), ";
+            str << prefix << "srli_epi64(" << symbol << ", " << dec << (64-amount) << "))";
+        }
+        return str.str();
+    }
     if (amount > 0)
         str << "ROL" << dec << wordSize << "(";
     str << symbol;
@@ -657,7 +828,9 @@ string KeccakFCodeGen::strXOR(const string& A, const string& B) const
 {
     stringstream str;
 
-    if (outputMacros) {
+    if (SIMDInstructionSet != KeccakFCodeGenNoSIMD)
+        str << strSIMD("xor") << "(" << A << ", " << B << ")";
+    else if (outputMacros) {
         str << "XOR" << dec << wordSize << "(";
         str << A << ", " << B << ")";
     }
@@ -670,7 +843,9 @@ string KeccakFCodeGen::strXOReq(const string& A, const string& B) const
 {
     stringstream str;
 
-    if (outputMacros) {
+    if (SIMDInstructionSet != KeccakFCodeGenNoSIMD)
+        str << A << " = " << strXOR(A, B);
+    else if (outputMacros) {
         str << "XOReq" << dec << wordSize << "(";
         str << A << ", " << B << ")";
     }
@@ -683,7 +858,30 @@ string KeccakFCodeGen::strANDORnot(const string& A, const string& B, bool LC1, b
 {
     stringstream str;
 
-    if (outputMacros) {
+    if (SIMDInstructionSet != KeccakFCodeGenNoSIMD) {
+        // andnot(X, Y) computes (~X)&Y; the other cases use De Morgan's laws
+        if (!LOR) {
+            if (LC1 && LC2)
+                str << strNOT(strSIMD("or") + "(" + A + ", " + B + ")");
+            else if (LC1)
+                str << strSIMD("andnot") << "(" << A << ", " << B << ")";
+            else if (LC2)
+                str << strSIMD("andnot") << "(" << B << ", " << A << ")";
+            else
+                str << strSIMD("and") << "(" << A << ", " << B << ")";
+        }
+        else {
+            if (LC1 && LC2)
+                str << strNOT(strSIMD("and") + "(" + A + ", " + B + ")");
+            else if (LC1)
+                str << strNOT(strSIMD("andnot") + "(" + B + ", " + A + ")");
+            else if (LC2)
+                str << strNOT(strSIMD("andnot") + "(" + A + ", " + B + ")");
+            else
+                str << strSIMD("or") << "(" << A << ", " << B << ")";
+        }
+    }
+    else if (outputMacros) {
         str << (LOR ? "OR" : "AND") << (LC1 ? "n" : "u") << (LC2 ? "n" : "u")
             << dec << wordSize << "(";
         str << A << ", " << B;
@@ -703,7 +901,13 @@ string KeccakFCodeGen::strNOT(const string& A, bool complement) const
 {
     stringstream str;
 
-    if (outputMacros) {
+    if (SIMDInstructionSet != KeccakFCodeGenNoSIMD) {
+        if (complement)
+            str << strXOR(A, strConst("~0ULL"));
+        else
+            str << A;
+    }
+    else if (outputMacros) {
         if (complement)
             str << "NOT" << dec << wordSize << "(";
         str << A;
@@ -726,7 +930,13 @@ string KeccakFCodeGen::strNOT(const string& A, bool complement) const
 
 string KeccakFCodeGen::strConst(const string& A) const
 {
-    if (outputMacros) {
+    if (SIMDInstructionSet == KeccakFCodeGenSSE2)
+        return "_mm_set1_epi64x((long long)" + A + ")";
+    else if (SIMDInstructionSet == KeccakFCodeGenAVX2)
+        return "_mm256_set1_epi64x((long long)" + A + ")";
+    else if (SIMDInstructionSet == KeccakFCodeGenAVX512)
+        return "_mm512_set1_epi64((long long)" + A + ")";
+    else if (outputMacros) {
         stringstream str;
 
         str << "CONST" << dec << wordSize << "(";
@@ -21,6 +21,18 @@ http://creativecommons.org/publicdomain/zero/1.0/
 
 using namespace std;
 
+/** The instruction sets for which KeccakFCodeGen can generate code that
+  * computes several instances of Keccak-<i>f</i>[1600] in parallel,
+  * each 64-bit lane variable being a vector register that holds the same
+  * lane of 2 (SSE2), 4 (AVX2) or 8 (AVX-512) independent states.
+  */
+enum KeccakFCodeGenSIMD {
+    KeccakFCodeGenNoSIMD = 0,
+    KeccakFCodeGenSSE2 = 1,
+    KeccakFCodeGenAVX2 = 2,
+    KeccakFCodeGenAVX512 = 3
+};
+
 /**
   * Class implementing code generation for the Keccak-<i>f</i> permutations.
   */
@@ -48,6 +60,11 @@ protected:
       * It must be 1 or 2. By default, it is 1.
       */
     unsigned int scheduleType;
+    /** The instruction set used to compute several instances in parallel,
+      * or KeccakFCodeGenNoSIMD (the default) for one instance with
+      * regular operators or macros.
+      */
+    KeccakFCodeGenSIMD SIMDInstructionSet;
 public:
     /**
       * The constructor. See KeccakF() for more details.
@@ -85,6 +102,24 @@ public:
       * @param  aScheduleType   The schedule type, 1 or 2.
       */
     void setScheduleType(unsigned int aScheduleType);
+    /**
+      * Method to set the instruction set used to compute several instances
+      * in parallel. With an instruction set other than KeccakFCodeGenNoSIMD,
+      * the variables are of type __m128i, __m256i or __m512i, and the
+      * operations are written as the corresponding intrinsics, whatever
+      * outputMacros. The functions copyFromState(), copyToState(), etc.
+      * then work on arrays of such vectors.
+      * This is only available for 64-bit lanes without interleaving.
+      *
+      * @param  aSIMDInstructionSet The instruction set.
+      */
+    void setSIMDInstructionSet(KeccakFCodeGenSIMD aSIMDInstructionSet);
+    /**
+      * Method that returns the number of instances computed in parallel
+      * by the generated code, i.e., 1, or 2, 4 or 8 depending on
+      * the SIMD instruction set.
+      */
+    unsigned int getNumberOfInstances() const;
     /**
       * Method that displays the round constants.
       */
@@ -182,6 +217,17 @@ public:
       *                 straightforward code.
       */
     void genMacroFile(ostream& fout, bool laneComplementing=false) const;
+    /**
+      * Method that generates the macros of genMacroFile(), followed by
+      * a macro prepareThetaOf(A) that computes the sheet parities of any set
+      * of state variables, so that the rounds can also be computed without
+      * early parity.
+      * This is the file that KeccakFGenerated compiles into the tool.
+      *
+      * @param  fout    The output stream where the code is generated.
+      * @param  laneComplementing   As in genMacroFile().
+      */
+    void genKernelMacroFile(ostream& fout, bool laneComplementing=false) const;
     /**
       * Method that generates C code to compute four rounds in place.
       * See “Keccak implementation overview”, Section “Efficient in-place implementations”
@@ -213,6 +259,8 @@ protected:
     string buildWordName(const string& prefixSymbol, unsigned int x) const;
     void genDeclarationsLanes(ostream& fout, const string& prefixSymbol) const;
     void genDeclarationsSheets(ostream& fout, const string& prefixSymbol) const;
+    string getWordType() const;
+    string strSIMD(const string& operation) const;
     string strANDORnot(const string& A, const string& B, bool LC1, bool LC2, bool LOR) const;
     string strConst(const string& A) const;
     string strNOT(const string& A, bool complement=true) const;
@@ -222,4 +270,19 @@ protected:
     unsigned int schedule(unsigned int i) const;
 };
 
+/**
+  * Function that generates the C code compiled into KeccakFGenerated.
+  * For each width from 200 to 1600, each schedule type and each lane
+  * complementing option, it writes the output of
+  * KeccakFCodeGen::genKernelMacroFile() into a file in @a directory.
+  * For Keccak-<i>f</i>[1600], it also writes the code for 2, 4 and 8
+  * instances in parallel with SSE2, AVX2 and AVX-512.
+  * It also writes the file "KeccakF-kernels.inc", which instantiates
+  * the permutation functions from these macros and lists them in a table.
+  * This function is called by the generation stage of the makefile.
+  *
+  * @param  directory   The directory where the files are written.
+  */
+void genKeccakFKernels(const string& directory);
+
 #endif
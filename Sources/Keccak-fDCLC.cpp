@@ -221,41 +221,18 @@ void KeccakFDCLC::displayAll(ostream& fout, KeccakFPropagation *DC, KeccakFPropa
 
 void KeccakFDCLC::initializeLambdaLookupTables()
 {
+    const unsigned int tableSize = KeccakFDCLC::EndOfLambdaModes*laneSize*laneSize*nrRowsAndColumns*(1<<nrRowsAndColumns);
+    vector<SliceValue> dense;
     // lambdaRowToSlice
     {
         string fileName = buildFileName("", "-lambda.cache");
         ifstream fin(fileName.c_str(), ios::binary);
         if (!fin) {
-            for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++) {
-                vector<vector<vector<vector<SliceValue> > > > vvvv;
-                for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++) {
-                    vector<vector<vector<SliceValue> > > vvv;
-                    for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++) {
-                        vector<vector<SliceValue> > vv;
-                        for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-                            vector<SliceValue> v(1<<nrRowsAndColumns);
-                            for(RowValue row=0; row<(1<<nrRowsAndColumns); row++) {
-                                vector<LaneValue> state(nrRowsAndColumns*nrRowsAndColumns, 0);
-                                setRow(state, row, y, inputSlice);
-                                lambda(state,KeccakFDCLC::LambdaMode(m));
-                                v[row] = getSlice(state, outputSlice);
-                            }
-                            vv.push_back(v);
-                        }
-                        vvv.push_back(vv);
-                    }
-                    vvvv.push_back(vvv);
-                }
-                lambdaRowToSlice.push_back(vvvv);
-            }
+            computeRowToSlice(0, dense);
             ofstream fout(fileName.c_str(), ios::binary);
-            for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++)
-            for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++)
-            for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++)
-            for(unsigned int y=0; y<nrRowsAndColumns; y++)
-            for(RowValue row=0; row<(1<<nrRowsAndColumns); row++) {
+            for(unsigned int i=0; i<tableSize; i++) {
                 static unsigned char tmp[4];
-                SliceValue v = lambdaRowToSlice[m][outputSlice][inputSlice][y][row];
+                SliceValue v = dense[i];
                 tmp[0] =  v&0xFF;
                 tmp[1] = (v>>8)&0xFF;
                 tmp[2] = (v>>16)&0xFF;
@@ -264,55 +241,21 @@ void KeccakFDCLC::initializeLambdaLookupTables()
             }
         }
         else {
-            for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++) {
-                vector<vector<vector<vector<SliceValue> > > > vvvv;
-                for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++) {
-                    vector<vector<vector<SliceValue> > > vvv;
-                    for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++) {
-                        vector<vector<SliceValue> > vv;
-                        for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-                            vector<SliceValue> v(1<<nrRowsAndColumns);
-                            for(RowValue row=0; row<(1<<nrRowsAndColumns); row++) {
-                                static unsigned char tmp[4];
-                                fin.read((char *)tmp, 4);
-                                v[row]  = tmp[3];  v[row] <<= 8;
-                                v[row] ^= tmp[2];  v[row] <<= 8;
-                                v[row] ^= tmp[1];  v[row] <<= 8;
-                                v[row] ^= tmp[0];
-                            }
-                            vv.push_back(v);
-                        }
-                        vvv.push_back(vv);
-                    }
-                    vvvv.push_back(vvv);
-                }
-                lambdaRowToSlice.push_back(vvvv);
+            dense.resize(tableSize);
+            for(unsigned int i=0; i<tableSize; i++) {
+                static unsigned char tmp[4];
+                fin.read((char *)tmp, 4);
+                dense[i]  = tmp[3];  dense[i] <<= 8;
+                dense[i] ^= tmp[2];  dense[i] <<= 8;
+                dense[i] ^= tmp[1];  dense[i] <<= 8;
+                dense[i] ^= tmp[0];
             }
         }
+        buildRowToSliceTable(dense, lambdaRowToSlice);
     }
     // lambdaBeforeThetaRowToSlice
-    for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++) {
-        vector<vector<vector<vector<SliceValue> > > > vvvv;
-        for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++) {
-            vector<vector<vector<SliceValue> > > vvv;
-            for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++) {
-                vector<vector<SliceValue> > vv;
-                for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-                    vector<SliceValue> v(1<<nrRowsAndColumns);
-                    for(RowValue row=0; row<(1<<nrRowsAndColumns); row++) {
-                        vector<LaneValue> state(nrRowsAndColumns*nrRowsAndColumns, 0);
-                        setRow(state, row, y, inputSlice);
-                        lambdaBeforeTheta(state, KeccakFDCLC::LambdaMode(m));
-                        v[row] = getSlice(state, outputSlice);
-                    }
-                    vv.push_back(v);
-                }
-                vvv.push_back(vv);
-            }
-            vvvv.push_back(vvv);
-        }
-        lambdaBeforeThetaRowToSlice.push_back(vvvv);
-    }
+    computeRowToSlice(1, dense);
+    buildRowToSliceTable(dense, lambdaBeforeThetaRowToSlice);
     // thetaJustAfterChi
     for(unsigned int mode=0; mode<KeccakFDCLC::EndOfLambdaModes ; mode++) {
         if ((mode == Straight) || (mode == Dual))
@@ -328,57 +271,85 @@ void KeccakFDCLC::initializeLambdaLookupTables()
             thetaJustBeforeChi.push_back(true);
     }
     // lambdaAfterThetaRowToSlice
-    for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++) {
-        vector<vector<vector<vector<SliceValue> > > > vvvv;
+    computeRowToSlice(2, dense);
+    buildRowToSliceTable(dense, lambdaAfterThetaRowToSlice);
+}
+
+void KeccakFDCLC::computeRowToSlice(unsigned int part, vector<SliceValue>& dense) const
+{
+    dense.clear();
+    for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++)
+    for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++)
+    for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++)
+    for(unsigned int y=0; y<nrRowsAndColumns; y++)
+    for(RowValue row=0; row<(1<<nrRowsAndColumns); row++) {
+        vector<LaneValue> state(nrRowsAndColumns*nrRowsAndColumns, 0);
+        setRow(state, row, y, inputSlice);
+        if (part == 0)
+            lambda(state, KeccakFDCLC::LambdaMode(m));
+        else if (part == 1)
+            lambdaBeforeTheta(state, KeccakFDCLC::LambdaMode(m));
+        else
+            lambdaAfterTheta(state, KeccakFDCLC::LambdaMode(m));
+        dense.push_back(getSlice(state, outputSlice));
+    }
+}
+
+void KeccakFDCLC::buildRowToSliceTable(const vector<SliceValue>& dense, RowToSliceTable& table) const
+{
+    const unsigned int nrRows = 1<<nrRowsAndColumns;
+    table.offsets.clear();
+    table.contributions.clear();
+    for(unsigned int m=0; m<KeccakFDCLC::EndOfLambdaModes ; m++)
+    for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++)
+    for(unsigned int y=0; y<nrRowsAndColumns; y++)
+    for(RowValue row=0; row<nrRows; row++) {
+        table.offsets.push_back((UINT32)table.contributions.size());
         for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++) {
-            vector<vector<vector<SliceValue> > > vvv;
-            for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++) {
-                vector<vector<SliceValue> > vv;
-                for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-                    vector<SliceValue> v(1<<nrRowsAndColumns);
-                    for(RowValue row=0; row<(1<<nrRowsAndColumns); row++) {
-                        vector<LaneValue> state(nrRowsAndColumns*nrRowsAndColumns, 0);
-                        setRow(state, row, y, inputSlice);
-                        lambdaAfterTheta(state, KeccakFDCLC::LambdaMode(m));
-                        v[row] = getSlice(state, outputSlice);
-                    }
-                    vv.push_back(v);
-                }
-                vvv.push_back(vv);
+            SliceValue v = dense[(((m*laneSize + outputSlice)*laneSize + inputSlice)*nrRowsAndColumns + y)*nrRows + row];
+            if (v != 0) {
+                SliceContribution c;
+                c.outputSlice = outputSlice;
+                c.value = v;
+                table.contributions.push_back(c);
             }
-            vvvv.push_back(vvv);
         }
-        lambdaAfterThetaRowToSlice.push_back(vvvv);
     }
+    table.offsets.push_back((UINT32)table.contributions.size());
 }
 
-void KeccakFDCLC::lambda(const vector<SliceValue>& in, vector<SliceValue>& out, LambdaMode mode) const
+void KeccakFDCLC::applyRowToSlice(const RowToSliceTable& table, const vector<SliceValue>& in, vector<SliceValue>& out, LambdaMode mode) const
 {
     // This assumes that 'in' has size equal to 'laneSize'
     out.assign(laneSize, 0);
-    for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++)
-    for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-        RowValue row = getRowFromSlice(in[inputSlice], y);
-        for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++)
-            out[outputSlice] ^= lambdaRowToSlice[mode][outputSlice][inputSlice][y][row];
+    const UINT32 *offsets = &table.offsets[0] + mode*laneSize*nrRowsAndColumns*(1<<nrRowsAndColumns);
+    const SliceContribution *contributions = &table.contributions[0];
+    for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++) {
+        if (in[inputSlice] == 0)
+            continue;
+        for(unsigned int y=0; y<nrRowsAndColumns; y++) {
+            RowValue row = getRowFromSlice(in[inputSlice], y);
+            if (row == 0)
+                continue;
+            unsigned int i = (inputSlice*nrRowsAndColumns + y)*(1<<nrRowsAndColumns) + row;
+            for(UINT32 j=offsets[i]; j<offsets[i+1]; j++)
+                out[contributions[j].outputSlice] ^= contributions[j].value;
+        }
     }
 }
 
+void KeccakFDCLC::lambda(const vector<SliceValue>& in, vector<SliceValue>& out, LambdaMode mode) const
+{
+    applyRowToSlice(lambdaRowToSlice, in, out, mode);
+}
+
 void KeccakFDCLC::lambdaBeforeTheta(const vector<SliceValue>& in, vector<SliceValue>& out, LambdaMode mode) const
 {
     if (thetaJustAfterChi[mode]) {
         out = in;
     }
-    else {
-        // This assumes that 'in' has size equal to 'laneSize'
-        out.assign(laneSize, 0);
-        for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++)
-        for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-            RowValue row = getRowFromSlice(in[inputSlice], y);
-            for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++)
-                out[outputSlice] ^= lambdaBeforeThetaRowToSlice[mode][outputSlice][inputSlice][y][row];
-        }
-    }
+    else
+        applyRowToSlice(lambdaBeforeThetaRowToSlice, in, out, mode);
 }
 
 void KeccakFDCLC::lambdaAfterTheta(const vector<SliceValue>& in, vector<SliceValue>& out, LambdaMode mode) const
@@ -386,16 +357,8 @@ void KeccakFDCLC::lambdaAfterTheta(const vector<SliceValue>& in, vector<SliceVal
     if (thetaJustBeforeChi[mode]) {
         out = in;
     }
-    else {
-        // This assumes that 'in' has size equal to 'laneSize'
-        out.assign(laneSize, 0);
-        for(unsigned int inputSlice=0; inputSlice<laneSize; inputSlice++)
-        for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-            RowValue row = getRowFromSlice(in[inputSlice], y);
-            for(unsigned int outputSlice=0; outputSlice<laneSize; outputSlice++)
-                out[outputSlice] ^= lambdaAfterThetaRowToSlice[mode][outputSlice][inputSlice][y][row];
-        }
-    }
+    else
+        applyRowToSlice(lambdaAfterThetaRowToSlice, in, out, mode);
 }
 
 void KeccakFDCLC::checkDCTrail(const Trail& trail, KeccakFPropagation *DC) const
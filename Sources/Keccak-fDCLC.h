@@ -17,6 +17,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #define _KECCAKFDCLC_H_
 
 #include <string>
+#include "cachelineallocator.h"
 #include "Keccak-fParts.h"
 #include "Keccak-fTrails.h"
 
@@ -97,29 +98,43 @@ public:
       */
     vector<bool> thetaJustBeforeChi;
 private:
+    /** This structure contains the contribution of an input row
+      * to a single output slice.
+      */
+    struct SliceContribution {
+        unsigned int outputSlice;
+        SliceValue value;
+    };
+    /** This structure contains the contribution of every input row
+      * to the output slices of a linear function, for every λ mode.
+      *
+      * The non-zero contributions of the row with value B located at row iy
+      * in slice iz are stored contiguously in
+      * contributions[offsets[i]] to contributions[offsets[i+1]-1], with
+      * i = ((mode*laneSize + iz)*5 + iy)*32 + B.
+      * Output slices that the row does not reach are not stored,
+      * so only the relevant output slices are visited.
+      * Both arrays start on a cache line.
+      */
+    struct RowToSliceTable {
+        vector<UINT32, CacheLineAllocator<UINT32> > offsets;
+        vector<SliceContribution, CacheLineAllocator<SliceContribution> > contributions;
+    };
     /** For λ mode (see LambdaMode), this attribute contains
-      * the contribution of an input row to an output slice via the linear
+      * the contribution of an input row to the output slices via the linear
       * function λ.
       *
-      * The indexes are as follows, from outer to inner:
-      * - the λ mode (λ, its inverse, its transpose, the transpose of its inverse)
-      * - the output slice index (oz)
-      * - the input slice index (iz)
-      * - the input row index (iy)
-      * - the input row value input[iy,iz]
-      *
       * So, given a row value B located at row iy in slice 0&lt;=iz&lt;laneSize,
       * its linear contribution to the output of the λ function in Straight mode is given
-      * by lambdaRowToSlice[(int)Straight][oz][iz][iy][B], where oz is
-      * varied from 0 to laneSize-1 to see all the output slices.
+      * by the contributions at index ((Straight*laneSize + iz)*5 + iy)*32 + B.
       */
-    vector<vector<vector<vector<vector<SliceValue> > > > > lambdaRowToSlice;
+    RowToSliceTable lambdaRowToSlice;
     /** Same as lambdaRowToSlice, but only for the linear part before θ.
       */
-    vector<vector<vector<vector<vector<SliceValue> > > > > lambdaBeforeThetaRowToSlice;
+    RowToSliceTable lambdaBeforeThetaRowToSlice;
     /** Same as lambdaRowToSlice, but only for the linear part after θ.
       */
-    vector<vector<vector<vector<vector<SliceValue> > > > > lambdaAfterThetaRowToSlice;
+    RowToSliceTable lambdaAfterThetaRowToSlice;
 public:
     /** In this context, λ represents the linear operations in Keccak-<i>f</i>
       * between two applications of χ.
@@ -284,6 +299,20 @@ public:
 private:
     void initializeAll();
     void initializeLambdaLookupTables();
+    /** This method computes the contribution of every input row to every output slice,
+      * in the order of the "-lambda.cache" file: λ mode, output slice, input slice,
+      * input row index and input row value.
+      * @param   part   0 for λ, 1 for the part before θ and 2 for the part after θ.
+      * @param   dense  The output table.
+      */
+    void computeRowToSlice(unsigned int part, vector<SliceValue>& dense) const;
+    /** This method builds a RowToSliceTable from the output of computeRowToSlice().
+      */
+    void buildRowToSliceTable(const vector<SliceValue>& dense, RowToSliceTable& table) const;
+    /** This method applies a linear function to a state represented as slices
+      * using the given table, visiting only the non-zero input rows.
+      */
+    void applyRowToSlice(const RowToSliceTable& table, const vector<SliceValue>& in, vector<SliceValue>& out, LambdaMode mode) const;
 };
 
 template<class Lane>
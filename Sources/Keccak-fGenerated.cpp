@@ -0,0 +1,315 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <sstream>
+#include <string.h>
+#include "Keccak-fGenerated.h"
+#include "Keccak-fUnrolled.h"
+
+using namespace std;
+
+struct KeccakFGeneratedKernelEntry {
+    unsigned int width;
+    unsigned int scheduleType;
+    bool laneComplementing;
+    bool earlyParity;
+    KeccakFGeneratedKernel kernel;
+};
+
+struct KeccakFGeneratedParallelKernelEntry {
+    unsigned int SIMDInstructionSet;
+    unsigned int parallelism;
+    KeccakFGeneratedParallelKernel kernel;
+};
+
+#ifdef KeccakTools_GeneratedKernels
+
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KeccakFGenerated_x86
+#define KeccakFGenerated_TARGET_SSE2 __attribute__((target("sse2")))
+#define KeccakFGenerated_TARGET_AVX2 __attribute__((target("avx2")))
+#define KeccakFGenerated_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+// Operations used by the generated code
+#define ROL8(a, offset) ((UINT8)(((UINT8)(a) << (offset)) ^ ((UINT8)(a) >> (8-(offset)))))
+#define ROL16(a, offset) ((UINT16)(((UINT16)(a) << (offset)) ^ ((UINT16)(a) >> (16-(offset)))))
+#define ROL32(a, offset) ((UINT32)(((UINT32)(a) << (offset)) ^ ((UINT32)(a) >> (32-(offset)))))
+#define ROL64(a, offset) ((UINT64)(((UINT64)(a) << (offset)) ^ ((UINT64)(a) >> (64-(offset)))))
+
+static inline unsigned int generatedRoundIndex(int roundIndex)
+{
+    return (unsigned int)(((roundIndex % 255) + 255) % 255);
+}
+
+// The lanes complemented by the lane complementing transform between rounds,
+// as in KeccakFCodeGen::genMacroFile(), i.e., be, bi, go, ki, mi and sa.
+template<class Word>
+static inline void complementLanes(Word *words)
+{
+    const unsigned int complementedLanes[6] = { 1, 2, 8, 12, 17, 20 };
+    for(unsigned int i=0; i<6; i++)
+        words[complementedLanes[i]] = (Word)~words[complementedLanes[i]];
+}
+
+// Defines, from the macros of one generated file, the functions
+// permuteWithEarlyParity() and permuteWithoutEarlyParity().
+// The rounds are computed two by two, from A to E and back to A.
+#define KeccakFGeneratedKernels(Word, laneComplementing) \
+    void permuteWithEarlyParity(UINT8 *state, int startRoundIndex, unsigned int nrRounds) \
+    { \
+        Word words[25]; \
+        unsigned int i; \
+        declareABCDE \
+        \
+        KeccakFUnrolled<Word, 8*sizeof(Word)>::fromBytesToLanes(state, words); \
+        if (laneComplementing) \
+            complementLanes(words); \
+        copyFromState(A, words) \
+        prepareTheta \
+        for(i=0; i+1<nrRounds; i+=2) { \
+            thetaRhoPiChiIotaPrepareTheta(generatedRoundIndex(startRoundIndex+(int)i), A, E) \
+            thetaRhoPiChiIotaPrepareTheta(generatedRoundIndex(startRoundIndex+(int)i+1), E, A) \
+        } \
+        if (i < nrRounds) { \
+            thetaRhoPiChiIotaPrepareTheta(generatedRoundIndex(startRoundIndex+(int)i), A, E) \
+            copyStateVariables(A, E) \
+        } \
+        copyToState(words, A) \
+        if (laneComplementing) \
+            complementLanes(words); \
+        KeccakFUnrolled<Word, 8*sizeof(Word)>::fromLanesToBytes(words, state); \
+    } \
+    \
+    void permuteWithoutEarlyParity(UINT8 *state, int startRoundIndex, unsigned int nrRounds) \
+    { \
+        Word words[25]; \
+        unsigned int i; \
+        declareABCDE \
+        \
+        KeccakFUnrolled<Word, 8*sizeof(Word)>::fromBytesToLanes(state, words); \
+        if (laneComplementing) \
+            complementLanes(words); \
+        copyFromState(A, words) \
+        for(i=0; i+1<nrRounds; i+=2) { \
+            prepareThetaOf(A) \
+            thetaRhoPiChiIota(generatedRoundIndex(startRoundIndex+(int)i), A, E) \
+            prepareThetaOf(E) \
+            thetaRhoPiChiIota(generatedRoundIndex(startRoundIndex+(int)i+1), E, A) \
+        } \
+        if (i < nrRounds) { \
+            prepareThetaOf(A) \
+            thetaRhoPiChiIota(generatedRoundIndex(startRoundIndex+(int)i), A, E) \
+            copyStateVariables(A, E) \
+        } \
+        copyToState(words, A) \
+        if (laneComplementing) \
+            complementLanes(words); \
+        KeccakFUnrolled<Word, 8*sizeof(Word)>::fromLanesToBytes(words, state); \
+    }
+
+// Defines, from the macros of one file generated for Vector, a SIMD type
+// holding N lanes, the function permute() that processes N states in parallel.
+#define KeccakFGeneratedParallelKernel(Vector, N, TARGET) \
+    TARGET void permute(UINT8 * const * states, int startRoundIndex, unsigned int nrRounds) \
+    { \
+        UINT64 lanes[25][N]; \
+        Vector words[25]; \
+        unsigned int i; \
+        declareABCDE \
+        \
+        for(i=0; i<25; i++) \
+            for(unsigned int j=0; j<N; j++) \
+                memcpy(&lanes[i][j], states[j]+8*i, 8); \
+        memcpy(words, lanes, sizeof(words)); \
+        copyFromState(A, words) \
+        prepareTheta \
+        for(i=0; i+1<nrRounds; i+=2) { \
+            thetaRhoPiChiIotaPrepareTheta(generatedRoundIndex(startRoundIndex+(int)i), A, E) \
+            thetaRhoPiChiIotaPrepareTheta(generatedRoundIndex(startRoundIndex+(int)i+1), E, A) \
+        } \
+        if (i < nrRounds) { \
+            thetaRhoPiChiIotaPrepareTheta(generatedRoundIndex(startRoundIndex+(int)i), A, E) \
+            copyStateVariables(A, E) \
+        } \
+        copyToState(words, A) \
+        memcpy(lanes, words, sizeof(words)); \
+        for(i=0; i<25; i++) \
+            for(unsigned int j=0; j<N; j++) \
+                memcpy(states[j]+8*i, &lanes[i][j], 8); \
+    }
+
+#include "KeccakF-kernels.inc"
+
+#else
+
+// Built without the generation stage of the makefile
+static const KeccakFGeneratedKernelEntry generatedKernels[] = {
+    { 0, 0, false, false, 0 }
+};
+
+static const KeccakFGeneratedParallelKernelEntry generatedParallelKernels[] = {
+    { 0, 0, 0 }
+};
+
+#endif
+
+static KeccakFGeneratedKernel findGeneratedKernel(unsigned int width, unsigned int scheduleType, bool laneComplementing, bool earlyParity)
+{
+    for(unsigned int i=0; i<sizeof(generatedKernels)/sizeof(generatedKernels[0]); i++) {
+        const KeccakFGeneratedKernelEntry& entry = generatedKernels[i];
+        if ((entry.width == width) && (entry.scheduleType == scheduleType)
+                && (entry.laneComplementing == laneComplementing) && (entry.earlyParity == earlyParity))
+            return entry.kernel;
+    }
+    return 0;
+}
+
+KeccakFGenerated::KeccakFGenerated(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds,
+        unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity)
+    : KeccakF(aWidth, aStartRoundIndex, aNrRounds), scheduleType(aScheduleType),
+    laneComplementing(aLaneComplementing), earlyParity(anEarlyParity)
+{
+    kernel = findGeneratedKernel(width, scheduleType, laneComplementing, earlyParity);
+    if (kernel == 0)
+        throw KeccakException("KeccakFGenerated: the requested variant was not generated into this build.");
+}
+
+KeccakFGenerated::KeccakFGenerated(unsigned int aWidth, unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity)
+    : KeccakF(aWidth), scheduleType(aScheduleType),
+    laneComplementing(aLaneComplementing), earlyParity(anEarlyParity)
+{
+    kernel = findGeneratedKernel(width, scheduleType, laneComplementing, earlyParity);
+    if (kernel == 0)
+        throw KeccakException("KeccakFGenerated: the requested variant was not generated into this build.");
+}
+
+void KeccakFGenerated::operator()(UINT8 * state) const
+{
+    kernel(state, startRoundIndex, nrRounds);
+}
+
+string KeccakFGenerated::getName() const
+{
+    stringstream a;
+    a << KeccakF::getName() << "-gen-s" << dec << scheduleType;
+    if (laneComplementing)
+        a << "-lc";
+    if (earlyParity)
+        a << "-ep";
+    return a.str();
+}
+
+bool KeccakFGenerated::isAvailable(unsigned int aWidth, unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity)
+{
+    return findGeneratedKernel(aWidth, aScheduleType, aLaneComplementing, anEarlyParity) != 0;
+}
+
+KeccakFGeneratedKernel KeccakFGenerated::getKernel(unsigned int aWidth, unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity)
+{
+    return findGeneratedKernel(aWidth, aScheduleType, aLaneComplementing, anEarlyParity);
+}
+
+static const KeccakFGeneratedParallelKernelEntry *findGeneratedParallelKernel(KeccakFCodeGenSIMD SIMDInstructionSet)
+{
+    for(unsigned int i=0; generatedParallelKernels[i].kernel != 0; i++)
+        if (generatedParallelKernels[i].SIMDInstructionSet == (unsigned int)SIMDInstructionSet)
+            return &generatedParallelKernels[i];
+    return 0;
+}
+
+static bool isSIMDInstructionSetSupported(KeccakFCodeGenSIMD SIMDInstructionSet)
+{
+    switch(SIMDInstructionSet) {
+#ifdef KeccakFGenerated_x86
+        case KeccakFCodeGenSSE2:
+            return __builtin_cpu_supports("sse2");
+#endif
+        case KeccakFCodeGenAVX2:
+            return isKeccakFParallelBackendSupported(KeccakFParallelAVX2);
+        case KeccakFCodeGenAVX512:
+            return isKeccakFParallelBackendSupported(KeccakFParallelAVX512);
+        default:
+            return false;
+    }
+}
+
+static string getSIMDInstructionSetName(KeccakFCodeGenSIMD SIMDInstructionSet)
+{
+    switch(SIMDInstructionSet) {
+        case KeccakFCodeGenSSE2:
+            return "sse2";
+        case KeccakFCodeGenAVX2:
+            return "avx2";
+        case KeccakFCodeGenAVX512:
+            return "avx512";
+        default:
+            return "scalar";
+    }
+}
+
+KeccakFGeneratedParallel::KeccakFGeneratedParallel(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds, KeccakFCodeGenSIMD aSIMDInstructionSet)
+    : KeccakF(aWidth, aStartRoundIndex, aNrRounds), SIMDInstructionSet(aSIMDInstructionSet)
+{
+    const KeccakFGeneratedParallelKernelEntry *entry = findGeneratedParallelKernel(SIMDInstructionSet);
+    if ((width != 1600) || (entry == 0) || !isSIMDInstructionSetSupported(SIMDInstructionSet))
+        throw KeccakException("KeccakFGeneratedParallel: the requested variant is not available.");
+    parallelism = entry->parallelism;
+    kernel = entry->kernel;
+}
+
+KeccakFGeneratedParallel::KeccakFGeneratedParallel(unsigned int aWidth, KeccakFCodeGenSIMD aSIMDInstructionSet)
+    : KeccakF(aWidth), SIMDInstructionSet(aSIMDInstructionSet)
+{
+    const KeccakFGeneratedParallelKernelEntry *entry = findGeneratedParallelKernel(SIMDInstructionSet);
+    if ((width != 1600) || (entry == 0) || !isSIMDInstructionSetSupported(SIMDInstructionSet))
+        throw KeccakException("KeccakFGeneratedParallel: the requested variant is not available.");
+    parallelism = entry->parallelism;
+    kernel = entry->kernel;
+}
+
+void KeccakFGeneratedParallel::permuteN(UINT8 * const * states, size_t n) const
+{
+    size_t i = 0;
+    for( ; i+parallelism<=n; i+=parallelism)
+        kernel(states+i, startRoundIndex, nrRounds);
+    for( ; i<n; i++)
+        (*this)(states[i]);
+}
+
+string KeccakFGeneratedParallel::getName() const
+{
+    return KeccakF::getName() + "-gen-" + getSIMDInstructionSetName(SIMDInstructionSet);
+}
+
+bool KeccakFGeneratedParallel::isAvailable(KeccakFCodeGenSIMD aSIMDInstructionSet)
+{
+    return (findGeneratedParallelKernel(aSIMDInstructionSet) != 0) && isSIMDInstructionSetSupported(aSIMDInstructionSet);
+}
+
+KeccakFGeneratedParallelKernel KeccakFGeneratedParallel::getKernel(KeccakFCodeGenSIMD aSIMDInstructionSet, unsigned int& aParallelism)
+{
+    const KeccakFGeneratedParallelKernelEntry *entry = findGeneratedParallelKernel(aSIMDInstructionSet);
+    if ((entry == 0) || !isSIMDInstructionSetSupported(aSIMDInstructionSet))
+        return 0;
+    aParallelism = entry->parallelism;
+    return entry->kernel;
+}
+
+string KeccakFGeneratedParallel::getInstructionSetName(KeccakFCodeGenSIMD aSIMDInstructionSet)
+{
+    return getSIMDInstructionSetName(aSIMDInstructionSet);
+}
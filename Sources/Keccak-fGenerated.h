@@ -0,0 +1,162 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFGENERATED_H_
+#define _KECCAKFGENERATED_H_
+
+#include "Keccak-f.h"
+#include "Keccak-fCodeGen.h"
+
+/** Type of the functions compiled from the code generated by KeccakFCodeGen.
+  * They apply @a nrRounds rounds starting from @a startRoundIndex onto
+  * a state given as an array of bytes.
+  */
+typedef void (*KeccakFGeneratedKernel)(UINT8 *state, int startRoundIndex, unsigned int nrRounds);
+
+/** Type of the functions compiled from the code generated by KeccakFCodeGen
+  * for several instances in parallel (see KeccakFCodeGen::setSIMDInstructionSet()).
+  * They apply @a nrRounds rounds starting from @a startRoundIndex onto
+  * as many states as the instruction set allows.
+  */
+typedef void (*KeccakFGeneratedParallelKernel)(UINT8 * const * states, int startRoundIndex, unsigned int nrRounds);
+
+/**
+  * Class implementing Keccak-<i>f</i> (or a range of its rounds) with the
+  * plane-per-plane code produced by KeccakFCodeGen::genKernelMacroFile().
+  * The code is generated and compiled into the tool by the makefile,
+  * see genKeccakFKernels(), for the widths 200 to 1600 and for each
+  * combination of the generation options: the schedule type
+  * (see KeccakFCodeGen::setScheduleType()), lane complementing
+  * and early parity (see KeccakFCodeGen::genCodePlanePerPlane()).
+  * If the tool was built without the generation stage, no variant is
+  * available and the constructor throws a KeccakException.
+  * The inverse is inherited from KeccakF.
+  */
+class KeccakFGenerated : public KeccakF {
+protected:
+    /** The schedule type, 1 or 2. */
+    unsigned int scheduleType;
+    /** Whether the generated code uses the lane complementing transform. */
+    bool laneComplementing;
+    /** Whether the sheet parities are computed as the output of χ is computed. */
+    bool earlyParity;
+    /** The compiled function implementing this variant. */
+    KeccakFGeneratedKernel kernel;
+public:
+    /**
+      * The constructor.
+      *
+      * @param  aWidth      The width of the permutation, from 200 to 1600.
+      * @param  aStartRoundIndex    The index of the first round to perform.
+      * @param  aNrRounds   The desired number of rounds.
+      * @param  aScheduleType   The schedule type of the generated code, 1 or 2.
+      * @param  aLaneComplementing  Whether the generated code uses lane complementing.
+      * @param  anEarlyParity   Whether the generated code uses early parity.
+      */
+    KeccakFGenerated(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds,
+        unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity);
+    /**
+      * The constructor, with the nominal number of rounds.
+      * See KeccakFGenerated(unsigned int, int, unsigned int, unsigned int, bool, bool).
+      */
+    KeccakFGenerated(unsigned int aWidth, unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity);
+    /**
+      * Method that applies the permutation onto the parameter @a state.
+      */
+    void operator()(UINT8 * state) const;
+    /**
+      * Method that returns a short string that uniquely identifies the instance,
+      * e.g., "KeccakF-1600-24-gen-s1-lc-ep".
+      */
+    string getName() const;
+    /**
+      * Function that tells whether the variant with the given width and
+      * generation options was compiled into the tool.
+      */
+    static bool isAvailable(unsigned int aWidth, unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity);
+    /**
+      * Function that returns the compiled function implementing the variant
+      * with the given width and generation options, or 0 if this variant
+      * was not compiled into the tool.
+      */
+    static KeccakFGeneratedKernel getKernel(unsigned int aWidth, unsigned int aScheduleType, bool aLaneComplementing, bool anEarlyParity);
+};
+
+/**
+  * Class implementing Keccak-<i>f</i>[1600] (or a range of its rounds) whose
+  * permuteN() uses the code produced by KeccakFCodeGen for several
+  * instances in parallel with SSE2, AVX2 or AVX-512 intrinsics
+  * (see KeccakFCodeGen::setSIMDInstructionSet()).
+  * Like KeccakFGenerated, this code is generated and compiled into the tool
+  * by the makefile. The states are processed by groups of 2, 4 or 8,
+  * and the remaining ones, as well as operator() and the inverse,
+  * use the implementation of KeccakF.
+  */
+class KeccakFGeneratedParallel : public KeccakF {
+protected:
+    /** The instruction set of the generated code. */
+    KeccakFCodeGenSIMD SIMDInstructionSet;
+    /** The number of states processed by one call to the kernel. */
+    unsigned int parallelism;
+    /** The compiled function implementing this variant. */
+    KeccakFGeneratedParallelKernel kernel;
+public:
+    /**
+      * The constructor.
+      *
+      * @param  aWidth      The width of the permutation, which must be 1600.
+      * @param  aStartRoundIndex    The index of the first round to perform.
+      * @param  aNrRounds   The desired number of rounds.
+      * @param  aSIMDInstructionSet The instruction set of the generated code,
+      *                     which must be supported by the processor.
+      */
+    KeccakFGeneratedParallel(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds, KeccakFCodeGenSIMD aSIMDInstructionSet);
+    /**
+      * The constructor, with the nominal number of rounds.
+      */
+    KeccakFGeneratedParallel(unsigned int aWidth, KeccakFCodeGenSIMD aSIMDInstructionSet);
+    /**
+      * Method that applies the permutation onto @a n states,
+      * by groups of getParallelism() states with the generated code.
+      */
+    void permuteN(UINT8 * const * states, size_t n) const;
+    using KeccakF::permuteN;
+    /**
+      * Method that returns the number of states processed in parallel.
+      */
+    unsigned int getParallelism() const { return parallelism; }
+    /**
+      * Method that returns a short string that uniquely identifies the instance,
+      * e.g., "KeccakF-1600-24-gen-avx2".
+      */
+    string getName() const;
+    /**
+      * Function that tells whether the code for the given instruction set
+      * was compiled into the tool and can run on the processor.
+      */
+    static bool isAvailable(KeccakFCodeGenSIMD aSIMDInstructionSet);
+    /**
+      * Function that returns the compiled function for the given instruction set
+      * and sets @a aParallelism to the number of states it processes,
+      * or returns 0 if this code was not compiled into the tool or cannot run on the processor.
+      */
+    static KeccakFGeneratedParallelKernel getKernel(KeccakFCodeGenSIMD aSIMDInstructionSet, unsigned int& aParallelism);
+    /**
+      * Function that returns the name of the instruction set, e.g., "avx2".
+      */
+    static string getInstructionSetName(KeccakFCodeGenSIMD aSIMDInstructionSet);
+};
+
+#endif
@@ -0,0 +1,160 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <sstream>
+#include "Keccak-fInterleaved.h"
+
+using namespace std;
+
+KeccakFInterleaved::KeccakFInterleaved(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds)
+    : KeccakF(aWidth, aStartRoundIndex, aNrRounds)
+{
+    initializeInterleavingTables();
+}
+
+KeccakFInterleaved::KeccakFInterleaved(unsigned int aWidth)
+    : KeccakF(aWidth)
+{
+    initializeInterleavingTables();
+}
+
+void KeccakFInterleaved::initializeInterleavingTables()
+{
+    if (laneSize != 32*interleavingFactor)
+        throw KeccakException("KeccakFInterleaved requires 64-bit lanes, i.e., a width of 1600.");
+
+    // Same mapping as KeccakFCodeGen::genCodePlanePerPlane()
+    const unsigned int wordSize = laneSize/interleavingFactor;
+    for(unsigned int x=0; x<5; x++)
+    for(unsigned int y=0; y<5; y++) {
+        unsigned int xprime, yprime;
+        inversePi(x, y, xprime, yprime);
+        for(unsigned int zeta=0; zeta<interleavingFactor; zeta++) {
+            unsigned int rModS = rhoOffsets[index(xprime, yprime)] % interleavingFactor;
+            unsigned int zetaprime = (interleavingFactor + zeta - rModS) % interleavingFactor;
+            unsigned int i = interleavingFactor*index(x, y) + zeta;
+            sourceWord[i] = interleavingFactor*index(xprime, yprime) + zetaprime;
+            thetaEffectWord[i] = interleavingFactor*xprime + zetaprime;
+            wordRotation[i] = (rhoOffsets[index(xprime, yprime)] / interleavingFactor) % wordSize
+                + ((zeta < rModS) ? 1 : 0);
+        }
+    }
+
+    // Same mapping as KeccakFCodeGen::genRoundConstants()
+    for(unsigned int zeta=0; zeta<interleavingFactor; zeta++)
+        interleavedRoundConstants[zeta].assign(roundConstants.size(), 0);
+    for(unsigned int i=0; i<roundConstants.size(); i++)
+        for(unsigned int z=0; z<laneSize; z++)
+            if ((roundConstants[i] & ((LaneValue)1 << z)) != 0)
+                interleavedRoundConstants[z%interleavingFactor][i] |= ((UINT32)1 << (z/interleavingFactor));
+}
+
+static inline UINT32 ROL32(UINT32 a, unsigned int offset)
+{
+    return (offset == 0) ? a : ((a << offset) | (a >> (32-offset)));
+}
+
+/** Function that gathers the even bits of @a a into its low half
+  * and its odd bits into its high half.
+  */
+static inline UINT32 separateEvenOdd(UINT32 a)
+{
+    UINT32 t;
+    t = (a ^ (a >> 1)) & 0x22222222UL;  a = a ^ t ^ (t << 1);
+    t = (a ^ (a >> 2)) & 0x0C0C0C0CUL;  a = a ^ t ^ (t << 2);
+    t = (a ^ (a >> 4)) & 0x00F000F0UL;  a = a ^ t ^ (t << 4);
+    t = (a ^ (a >> 8)) & 0x0000FF00UL;  a = a ^ t ^ (t << 8);
+    return a;
+}
+
+/** Function that is the inverse of separateEvenOdd().
+  */
+static inline UINT32 mergeEvenOdd(UINT32 a)
+{
+    UINT32 t;
+    t = (a ^ (a >> 8)) & 0x0000FF00UL;  a = a ^ t ^ (t << 8);
+    t = (a ^ (a >> 4)) & 0x00F000F0UL;  a = a ^ t ^ (t << 4);
+    t = (a ^ (a >> 2)) & 0x0C0C0C0CUL;  a = a ^ t ^ (t << 2);
+    t = (a ^ (a >> 1)) & 0x22222222UL;  a = a ^ t ^ (t << 1);
+    return a;
+}
+
+void KeccakFInterleaved::fromBytesToWords(const UINT8 *in, UINT32 *out)
+{
+    for(unsigned int i=0; i<25; i++) {
+        UINT32 low = (UINT32)in[8*i] | ((UINT32)in[8*i+1] << 8) | ((UINT32)in[8*i+2] << 16) | ((UINT32)in[8*i+3] << 24);
+        UINT32 high = (UINT32)in[8*i+4] | ((UINT32)in[8*i+5] << 8) | ((UINT32)in[8*i+6] << 16) | ((UINT32)in[8*i+7] << 24);
+        low = separateEvenOdd(low);
+        high = separateEvenOdd(high);
+        out[2*i] = (low & 0x0000FFFFUL) | (high << 16);
+        out[2*i+1] = (low >> 16) | (high & 0xFFFF0000UL);
+    }
+}
+
+void KeccakFInterleaved::fromWordsToBytes(const UINT32 *in, UINT8 *out)
+{
+    for(unsigned int i=0; i<25; i++) {
+        UINT32 low = mergeEvenOdd((in[2*i] & 0x0000FFFFUL) | (in[2*i+1] << 16));
+        UINT32 high = mergeEvenOdd((in[2*i] >> 16) | (in[2*i+1] & 0xFFFF0000UL));
+        for(unsigned int j=0; j<4; j++) {
+            out[8*i+j] = (UINT8)(low >> (8*j));
+            out[8*i+4+j] = (UINT8)(high >> (8*j));
+        }
+    }
+}
+
+void KeccakFInterleaved::round(UINT32 *A, unsigned int ir) const
+{
+    UINT32 B[50], C[10], D[10];
+
+    // θ
+    for(unsigned int x=0; x<5; x++)
+        for(unsigned int zeta=0; zeta<2; zeta++)
+            C[2*x+zeta] = A[2*x+zeta] ^ A[2*x+10+zeta] ^ A[2*x+20+zeta] ^ A[2*x+30+zeta] ^ A[2*x+40+zeta];
+    for(unsigned int x=0; x<5; x++) {
+        D[2*x]   = C[2*((x+4)%5)]   ^ ROL32(C[2*((x+1)%5)+1], 1);
+        D[2*x+1] = C[2*((x+4)%5)+1] ^ C[2*((x+1)%5)];
+    }
+
+    // ρ and π
+    for(unsigned int i=0; i<50; i++)
+        B[i] = ROL32(A[sourceWord[i]] ^ D[thetaEffectWord[i]], wordRotation[i]);
+
+    // χ
+    for(unsigned int y=0; y<5; y++)
+        for(unsigned int x=0; x<5; x++)
+            for(unsigned int zeta=0; zeta<2; zeta++)
+                A[2*(x+5*y)+zeta] = B[2*(x+5*y)+zeta] ^ ((~B[2*((x+1)%5+5*y)+zeta]) & B[2*((x+2)%5+5*y)+zeta]);
+
+    // ι
+    A[0] ^= interleavedRoundConstants[0][ir];
+    A[1] ^= interleavedRoundConstants[1][ir];
+}
+
+void KeccakFInterleaved::operator()(UINT8 * state) const
+{
+    UINT32 A[50];
+    fromBytesToWords(state, A);
+    for(int i=startRoundIndex; i<startRoundIndex+(int)nrRounds; i++)
+        round(A, (unsigned int)(((i % 255) + 255) % 255));
+    fromWordsToBytes(A, state);
+}
+
+string KeccakFInterleaved::getName() const
+{
+    stringstream a;
+    a << KeccakF::getName() << "-int2";
+    return a.str();
+}
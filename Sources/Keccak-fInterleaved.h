@@ -0,0 +1,84 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFINTERLEAVED_H_
+#define _KECCAKFINTERLEAVED_H_
+
+#include "Keccak-f.h"
+
+/**
+  * Class implementing Keccak-<i>f</i>[1600] (or a range of its rounds)
+  * with the lanes bit-interleaved in two 32-bit words, as in the code
+  * produced by KeccakFCodeGen with an interleaving factor of 2.
+  * Bit z of a lane goes to bit z/2 of word z%2, so that a lane rotation
+  * becomes two 32-bit rotations and a possible swap of the two words.
+  * This avoids 64-bit shifts, which are costly on 32-bit platforms.
+  * The state is converted to and from the interleaved representation
+  * in operator(), so the byte interface is the same as KeccakF.
+  * The inverse is inherited from KeccakF.
+  */
+class KeccakFInterleaved : public KeccakF {
+protected:
+    /** The interleaving factor, i.e., the number of words per lane. */
+    static const unsigned int interleavingFactor = 2;
+    /** For each word after ρ and π, the index of the word before ρ and π
+      * that it comes from. Word zeta of lane i has index 2*i+zeta. */
+    unsigned int sourceWord[50];
+    /** For each word after ρ and π, the index of the θ-effect word
+      * to add to its source word. */
+    unsigned int thetaEffectWord[50];
+    /** For each word after ρ and π, the 32-bit rotation amount. */
+    unsigned int wordRotation[50];
+    /** The round constants for ι, interleaved, for word 0 and word 1. */
+    vector<UINT32> interleavedRoundConstants[interleavingFactor];
+public:
+    /**
+      * The constructor.
+      *
+      * @param  aWidth      The width of the permutation, which must be 1600.
+      * @param  aStartRoundIndex    The index of the first round to perform.
+      * @param  aNrRounds   The desired number of rounds.
+      */
+    KeccakFInterleaved(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds);
+    /**
+      * The constructor, with the nominal number of rounds.
+      *
+      * @param  aWidth      The width of the permutation, which must be 1600.
+      */
+    KeccakFInterleaved(unsigned int aWidth);
+    /**
+      * Method that applies the permutation onto the parameter @a state.
+      */
+    void operator()(UINT8 * state) const;
+    /**
+      * Method that returns a short string that uniquely identifies the instance.
+      */
+    string getName() const;
+    /**
+      * Function that converts a state given as an array of 200 bytes into
+      * 50 interleaved 32-bit words, word zeta of lane i being at index 2*i+zeta.
+      */
+    static void fromBytesToWords(const UINT8 *in, UINT32 *out);
+    /**
+      * Function that converts 50 interleaved 32-bit words into a state
+      * given as an array of 200 bytes.
+      */
+    static void fromWordsToBytes(const UINT32 *in, UINT8 *out);
+protected:
+    void initializeInterleavingTables();
+    void round(UINT32 *A, unsigned int ir) const;
+};
+
+#endif
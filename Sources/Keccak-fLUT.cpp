@@ -0,0 +1,284 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include "Keccak-fLUT.h"
+#include "threads.h"
+
+using namespace std;
+
+KeccakFLUT::KeccakFLUT(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds)
+    : KeccakF(aWidth, aStartRoundIndex, aNrRounds)
+{
+    initializeTables();
+}
+
+KeccakFLUT::KeccakFLUT(unsigned int aWidth)
+    : KeccakF(aWidth)
+{
+    initializeTables();
+}
+
+void KeccakFLUT::initializeTables()
+{
+    if ((width < 25) || (width > 200))
+        throw KeccakException("KeccakFLUT: the width must be between 25 and 200.");
+    rowsPerChunk = (laneSize >= 2) ? 2 : 1;
+    nrChunks = 5*laneSize/rowsPerChunk;
+    planesPerWord = 64/(5*laneSize);
+    nrWords = (5 + planesPerWord - 1)/planesPerWord;
+    nrBytes = (width + 7)/8;
+    nrLaneWords = (width + 63)/64;
+    chunkWord.resize(nrChunks);
+    chunkShift.resize(nrChunks);
+    for(unsigned int c=0; c<nrChunks; c++) {
+        unsigned int y = c/(laneSize/rowsPerChunk);
+        unsigned int z = (c%(laneSize/rowsPerChunk))*rowsPerChunk;
+        getPlanePosition(0, y, z, chunkWord[c], chunkShift[c]);
+    }
+    if (!retrieveTables())
+        generateTables();
+}
+
+string KeccakFLUT::getTablesFileName() const
+{
+    stringstream a;
+    a << "KeccakF-" << dec << width << "-rounds.LUT";
+    return a.str();
+}
+
+UINT64 KeccakFLUT::getTablesSize() const
+{
+    UINT64 chunkValues = (UINT64)1 << (5*rowsPerChunk);
+    return nrChunks*chunkValues*nrWords + 1024 + 255 + nrBytes*256*nrWords + nrChunks*chunkValues*nrLaneWords;
+}
+
+void KeccakFLUT::setTablePointers(const UINT64 *tables)
+{
+    UINT64 chunkValues = (UINT64)1 << (5*rowsPerChunk);
+    lambdaTable = tables;
+    chiTable = lambdaTable + nrChunks*chunkValues*nrWords;
+    iotaTable = chiTable + 1024;
+    inputTable = iotaTable + 255;
+    outputTable = inputTable + nrBytes*256*nrWords;
+}
+
+void KeccakFLUT::getPlanePosition(unsigned int x, unsigned int y, unsigned int z, unsigned int& word, unsigned int& bit) const
+{
+    word = y/planesPerWord;
+    bit = (y%planesPerWord)*5*laneSize + 5*z + x;
+}
+
+bool KeccakFLUT::retrieveTables()
+{
+    if (!mappedTables.open(getTablesFileName(), "KeccakFLUT", width, 0, tablesVersion))
+        return false;
+    if (mappedTables.getSize() != getTablesSize()*sizeof(UINT64)) {
+        mappedTables.close();
+        return false;
+    }
+    setTablePointers((const UINT64 *)mappedTables.getData());
+    return true;
+}
+
+void KeccakFLUT::generateTables()
+{
+    const unsigned int chunkBits = 5*rowsPerChunk;
+    const UINT64 chunkValues = (UINT64)1 << chunkBits;
+
+    // Images by π∘ρ∘θ of the single-bit states, plane per plane, indexed by (x+5y)*laneSize+z
+    vector<UINT64> images(width*nrWords, 0);
+    for(unsigned int y=0; y<5; y++)
+    for(unsigned int x=0; x<5; x++)
+    for(unsigned int z=0; z<laneSize; z++) {
+        vector<LaneValue> A(25, 0);
+        A[index(x, y)] = (LaneValue)1 << z;
+        theta(A);
+        rho(A);
+        pi(A);
+        UINT64 *image = &images[(index(x, y)*laneSize + z)*nrWords];
+        for(unsigned int Y=0; Y<5; Y++)
+        for(unsigned int X=0; X<5; X++)
+        for(unsigned int Z=0; Z<laneSize; Z++)
+            if ((A[index(X, Y)] >> Z) & 1) {
+                unsigned int word, bit;
+                getPlanePosition(X, Y, Z, word, bit);
+                image[word] |= (UINT64)1 << bit;
+            }
+    }
+
+    generatedTables.assign(getTablesSize(), 0);
+    setTablePointers(&generatedTables[0]);
+    UINT64 *lambda = &generatedTables[0];
+    UINT64 *chi = lambda + nrChunks*chunkValues*nrWords;
+    UINT64 *iota = chi + 1024;
+    UINT64 *input = iota + 255;
+    UINT64 *output = input + nrBytes*256*nrWords;
+
+    // π∘ρ∘θ and the output conversion, chunk per chunk in parallel, by linearity
+    parallelFor(0, nrChunks, [&](UINT64 begin, UINT64 end) {
+        for(UINT64 c=begin; c<end; c++) {
+            unsigned int y = (unsigned int)c/(laneSize/rowsPerChunk);
+            unsigned int zChunk = ((unsigned int)c%(laneSize/rowsPerChunk))*rowsPerChunk;
+            UINT64 *lambdaEntries = lambda + c*chunkValues*nrWords;
+            UINT64 *outputEntries = output + c*chunkValues*nrLaneWords;
+            for(UINT64 v=1; v<chunkValues; v++) {
+                unsigned int j = 0;
+                while(((v >> j) & 1) == 0)
+                    j++;
+                unsigned int x = j%5;
+                unsigned int z = zChunk + j/5;
+                UINT64 previous = v & (v-1);
+                const UINT64 *image = &images[(index(x, y)*laneSize + z)*nrWords];
+                for(unsigned int w=0; w<nrWords; w++)
+                    lambdaEntries[v*nrWords+w] = lambdaEntries[previous*nrWords+w] ^ image[w];
+                unsigned int laneBit = index(x, y)*laneSize + z;
+                for(unsigned int w=0; w<nrLaneWords; w++)
+                    outputEntries[v*nrLaneWords+w] = outputEntries[previous*nrLaneWords+w];
+                outputEntries[v*nrLaneWords+laneBit/64] ^= (UINT64)1 << (laneBit%64);
+            }
+        }
+    });
+
+    // χ on two rows
+    for(unsigned int v=0; v<1024; v++) {
+        UINT64 result = 0;
+        for(unsigned int r=0; r<2; r++) {
+            unsigned int row = (v >> (5*r)) & 0x1F;
+            for(unsigned int x=0; x<5; x++) {
+                unsigned int bit = ((row >> x) ^ ((~row >> ((x+1)%5)) & (row >> ((x+2)%5)))) & 1;
+                result |= (UINT64)bit << (5*r+x);
+            }
+        }
+        chi[v] = result;
+    }
+
+    // ι, on the lane (0, 0) in the first plane
+    for(unsigned int i=0; i<255; i++)
+        for(unsigned int z=0; z<laneSize; z++)
+            if ((getRoundConstant(i) >> z) & 1) {
+                unsigned int word, bit;
+                getPlanePosition(0, 0, z, word, bit);
+                iota[i] |= (UINT64)1 << bit;
+            }
+
+    // Input conversion, byte per byte
+    for(unsigned int b=0; b<nrBytes; b++)
+    for(unsigned int v=0; v<256; v++)
+        for(unsigned int j=0; j<8; j++)
+            if (((v >> j) & 1) && (8*b+j < width)) {
+                unsigned int lane = (8*b+j)/laneSize;
+                unsigned int word, bit;
+                getPlanePosition(lane%5, lane/5, (8*b+j)%laneSize, word, bit);
+                input[(b*256+v)*nrWords+word] |= (UINT64)1 << bit;
+            }
+
+    if (MappedTable::save(getTablesFileName(), "KeccakFLUT", width, 0, tablesVersion,
+            &generatedTables[0], generatedTables.size()*sizeof(UINT64)) && retrieveTables())
+        vector<UINT64>().swap(generatedTables);
+}
+
+void KeccakFLUT::fromBytesToPlanes(const UINT8 *state, UINT64 *planes) const
+{
+    for(unsigned int w=0; w<nrWords; w++)
+        planes[w] = 0;
+    for(unsigned int b=0; b<nrBytes; b++) {
+        const UINT64 *entry = inputTable + (b*256 + state[b])*nrWords;
+        for(unsigned int w=0; w<nrWords; w++)
+            planes[w] ^= entry[w];
+    }
+}
+
+void KeccakFLUT::fromPlanesToBytes(const UINT64 *planes, UINT8 *state) const
+{
+    const unsigned int chunkBits = 5*rowsPerChunk;
+    const UINT64 chunkMask = ((UINT64)1 << chunkBits) - 1;
+    UINT64 lanes[4] = { 0, 0, 0, 0 };
+    for(unsigned int c=0; c<nrChunks; c++) {
+        UINT64 v = (planes[chunkWord[c]] >> chunkShift[c]) & chunkMask;
+        const UINT64 *entry = outputTable + ((c << chunkBits) + v)*nrLaneWords;
+        for(unsigned int w=0; w<nrLaneWords; w++)
+            lanes[w] ^= entry[w];
+    }
+    for(unsigned int b=0; b<nrBytes; b++)
+        state[b] = (UINT8)(lanes[b/8] >> (8*(b%8)));
+}
+
+// The rounds, with the geometry fixed at compile time by the lane size
+template<unsigned int laneSize>
+static void forwardOnPlanesFixed(UINT64 *planes, const UINT64 *lambdaTable, const UINT64 *chiTable, const UINT64 *iotaTable,
+    int startRoundIndex, unsigned int nrRounds)
+{
+    const unsigned int rowsPerChunk = (laneSize >= 2) ? 2 : 1;
+    const unsigned int chunksPerPlane = laneSize/rowsPerChunk;
+    const unsigned int nrChunks = 5*chunksPerPlane;
+    const unsigned int chunkBits = 5*rowsPerChunk;
+    const UINT64 chunkMask = ((UINT64)1 << chunkBits) - 1;
+    const unsigned int planesPerWord = 64/(5*laneSize);
+    const unsigned int nrWords = (5 + planesPerWord - 1)/planesPerWord;
+    UINT64 B[nrWords];
+    for(int i=startRoundIndex; i<startRoundIndex+(int)nrRounds; i++) {
+        // π∘ρ∘θ
+        for(unsigned int w=0; w<nrWords; w++)
+            B[w] = 0;
+        for(unsigned int c=0; c<nrChunks; c++) {
+            const unsigned int word = (c/chunksPerPlane)/planesPerWord;
+            const unsigned int shift = ((c/chunksPerPlane)%planesPerWord)*5*laneSize + (c%chunksPerPlane)*chunkBits;
+            UINT64 v = (planes[word] >> shift) & chunkMask;
+            const UINT64 *entry = lambdaTable + ((c << chunkBits) + v)*nrWords;
+            for(unsigned int w=0; w<nrWords; w++)
+                B[w] ^= entry[w];
+        }
+        // χ
+        for(unsigned int w=0; w<nrWords; w++)
+            planes[w] = 0;
+        for(unsigned int c=0; c<nrChunks; c++) {
+            const unsigned int word = (c/chunksPerPlane)/planesPerWord;
+            const unsigned int shift = ((c/chunksPerPlane)%planesPerWord)*5*laneSize + (c%chunksPerPlane)*chunkBits;
+            UINT64 v = (B[word] >> shift) & chunkMask;
+            planes[word] |= chiTable[v] << shift;
+        }
+        // ι
+        planes[0] ^= iotaTable[((i % 255) + 255) % 255];
+    }
+}
+
+void KeccakFLUT::forwardOnPlanes(UINT64 *planes) const
+{
+    switch(laneSize) {
+    case 1:
+        forwardOnPlanesFixed<1>(planes, lambdaTable, chiTable, iotaTable, startRoundIndex, nrRounds);
+        break;
+    case 2:
+        forwardOnPlanesFixed<2>(planes, lambdaTable, chiTable, iotaTable, startRoundIndex, nrRounds);
+        break;
+    case 4:
+        forwardOnPlanesFixed<4>(planes, lambdaTable, chiTable, iotaTable, startRoundIndex, nrRounds);
+        break;
+    case 8:
+        forwardOnPlanesFixed<8>(planes, lambdaTable, chiTable, iotaTable, startRoundIndex, nrRounds);
+        break;
+    }
+}
+
+void KeccakFLUT::operator()(UINT8 * state) const
+{
+    UINT64 planes[5];
+    fromBytesToPlanes(state, planes);
+    forwardOnPlanes(planes);
+    fromPlanesToBytes(planes, state);
+}
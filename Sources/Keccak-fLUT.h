@@ -0,0 +1,130 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFLUT_H_
+#define _KECCAKFLUT_H_
+
+#include <vector>
+#include "Keccak-f.h"
+#include "mappedtable.h"
+
+using namespace std;
+
+/**
+  * Class implementing Keccak-<i>f</i> (or a range of its rounds) with
+  * look-up tables, for the small widths for which a table of the whole
+  * permutation, as in KeccakF25LUT, is not possible. It is intended for
+  * exhaustive studies of Keccak-<i>f</i>[50] and Keccak-<i>f</i>[100],
+  * and works for the widths 25 to 200.
+  *
+  * The state is represented plane per plane in 64-bit words, the bit
+  * (x, y, z) being at position 5z+x of plane y, so that the rows are
+  * groups of 5 consecutive bits. A word contains as many whole planes as
+  * possible (e.g., 6 planes of 10 bits for the width 50, 3 planes of 20 bits
+  * for the width 100). The planes are cut into chunks of one or two rows.
+  * - The linear part π∘ρ∘θ is computed by XORing, for each chunk of the input,
+  *   the image of its value read in a table.
+  * - χ is computed by looking up each chunk in a table of 1024 entries.
+  * - ι adds a precomputed value to the first word.
+  * The conversions from and to the byte representation are also done with tables.
+  *
+  * The tables are generated in parallel, saved to a file with a versioned
+  * header and then mapped into memory, see MappedTable.
+  * The inverse is inherited from KeccakF.
+  */
+class KeccakFLUT : public KeccakF {
+protected:
+    /** The number of planes in a 64-bit word. */
+    unsigned int planesPerWord;
+    /** The number of 64-bit words of the state represented plane per plane. */
+    unsigned int nrWords;
+    /** The number of rows in a chunk, 1 or 2. */
+    unsigned int rowsPerChunk;
+    /** The number of chunks in the state. */
+    unsigned int nrChunks;
+    /** The number of bytes of the state. */
+    unsigned int nrBytes;
+    /** The number of 64-bit words of the state represented lane per lane. */
+    unsigned int nrLaneWords;
+    /** For each chunk, the index of the word that contains it. */
+    vector<unsigned int> chunkWord;
+    /** For each chunk, its position in the word. */
+    vector<unsigned int> chunkShift;
+    /** The table for π∘ρ∘θ, indexed by chunk, chunk value and word. */
+    const UINT64 *lambdaTable;
+    /** The table for χ on two rows. */
+    const UINT64 *chiTable;
+    /** The table for ι, indexed by round index. */
+    const UINT64 *iotaTable;
+    /** The table from the byte representation, indexed by byte, byte value and word. */
+    const UINT64 *inputTable;
+    /** The table to the byte representation, indexed by chunk, chunk value and lane word. */
+    const UINT64 *outputTable;
+    /** The file containing the tables, mapped into memory. */
+    MappedTable mappedTables;
+    /** The tables, if they could not be mapped from disk. */
+    vector<UINT64> generatedTables;
+    /** The version of the format of the table file. */
+    static const unsigned int tablesVersion = 1;
+public:
+    /**
+      * The constructor. See KeccakF() for more details.
+      * The tables are mapped from disk, or generated and saved if necessary.
+      *
+      * @param  aWidth      The width of the permutation, from 25 to 200.
+      * @param  aStartRoundIndex    The index of the first round to perform.
+      * @param  aNrRounds   The desired number of rounds.
+      */
+    KeccakFLUT(unsigned int aWidth, int aStartRoundIndex, unsigned int aNrRounds);
+    /**
+      * The constructor, with the nominal number of rounds.
+      */
+    KeccakFLUT(unsigned int aWidth);
+    /**
+      * Method that applies the permutation onto the parameter @a state.
+      */
+    void operator()(UINT8 * state) const;
+    /**
+      * Method that returns the number of 64-bit words of the state
+      * represented plane per plane.
+      */
+    unsigned int getNumberOfPlaneWords() const { return nrWords; }
+    /**
+      * Method that converts a state given as an array of bytes into
+      * getNumberOfPlaneWords() words, plane per plane.
+      */
+    void fromBytesToPlanes(const UINT8 *state, UINT64 *planes) const;
+    /**
+      * Method that converts a state represented plane per plane
+      * into an array of bytes.
+      */
+    void fromPlanesToBytes(const UINT64 *planes, UINT8 *state) const;
+    /**
+      * Method that applies the rounds onto a state represented plane per plane.
+      * Exhaustive searches can work in this representation to avoid the
+      * conversions of operator().
+      */
+    void forwardOnPlanes(UINT64 *planes) const;
+protected:
+    void initializeTables();
+    string getTablesFileName() const;
+    bool retrieveTables();
+    void generateTables();
+    void setTablePointers(const UINT64 *tables);
+    UINT64 getTablesSize() const;
+    void getPlanePosition(unsigned int x, unsigned int y, unsigned int z, unsigned int& word, unsigned int& bit) const;
+};
+
+#endif
@@ -0,0 +1,239 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <string.h>
+#include "Keccak-fParallel.h"
+
+using namespace std;
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <immintrin.h>
+#include <intrin.h>
+#define KeccakFParallel_x86
+#define KeccakFParallel_TARGET_AVX2
+#define KeccakFParallel_TARGET_AVX512
+#elif (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+#include <immintrin.h>
+#define KeccakFParallel_x86
+#define KeccakFParallel_TARGET_AVX2 __attribute__((target("avx2")))
+#define KeccakFParallel_TARGET_AVX512 __attribute__((target("avx512f")))
+#endif
+
+#ifdef KeccakFParallel_x86
+
+/*
+ * The round function, written once with operation macros.
+ * A holds the 25 lanes of the state, B, C and D are temporary lanes,
+ * and XOR, ROL, CHI, CONST are the operations on the SIMD type.
+ * CHI(a, b, c) computes a ^ (~b & c).
+ */
+#define KeccakF1600Parallel_round(rc) \
+    { \
+        for(unsigned int x=0; x<5; x++) \
+            C[x] = XOR(XOR(XOR(A[x], A[x+5]), XOR(A[x+10], A[x+15])), A[x+20]); \
+        for(unsigned int x=0; x<5; x++) \
+            D[x] = XOR(C[(x+4)%5], ROL(C[(x+1)%5], 1)); \
+        B[ 0] = XOR(A[ 0], D[0]); \
+        B[10] = ROL(XOR(A[ 1], D[1]),  1); \
+        B[20] = ROL(XOR(A[ 2], D[2]), 62); \
+        B[ 5] = ROL(XOR(A[ 3], D[3]), 28); \
+        B[15] = ROL(XOR(A[ 4], D[4]), 27); \
+        B[16] = ROL(XOR(A[ 5], D[0]), 36); \
+        B[ 1] = ROL(XOR(A[ 6], D[1]), 44); \
+        B[11] = ROL(XOR(A[ 7], D[2]),  6); \
+        B[21] = ROL(XOR(A[ 8], D[3]), 55); \
+        B[ 6] = ROL(XOR(A[ 9], D[4]), 20); \
+        B[ 7] = ROL(XOR(A[10], D[0]),  3); \
+        B[17] = ROL(XOR(A[11], D[1]), 10); \
+        B[ 2] = ROL(XOR(A[12], D[2]), 43); \
+        B[12] = ROL(XOR(A[13], D[3]), 25); \
+        B[22] = ROL(XOR(A[14], D[4]), 39); \
+        B[23] = ROL(XOR(A[15], D[0]), 41); \
+        B[ 8] = ROL(XOR(A[16], D[1]), 45); \
+        B[18] = ROL(XOR(A[17], D[2]), 15); \
+        B[ 3] = ROL(XOR(A[18], D[3]), 21); \
+        B[13] = ROL(XOR(A[19], D[4]),  8); \
+        B[14] = ROL(XOR(A[20], D[0]), 18); \
+        B[24] = ROL(XOR(A[21], D[1]),  2); \
+        B[ 9] = ROL(XOR(A[22], D[2]), 61); \
+        B[19] = ROL(XOR(A[23], D[3]), 56); \
+        B[ 4] = ROL(XOR(A[24], D[4]), 14); \
+        for(unsigned int y=0; y<25; y+=5) { \
+            A[y+0] = CHI(B[y+0], B[y+1], B[y+2]); \
+            A[y+1] = CHI(B[y+1], B[y+2], B[y+3]); \
+            A[y+2] = CHI(B[y+2], B[y+3], B[y+4]); \
+            A[y+3] = CHI(B[y+3], B[y+4], B[y+0]); \
+            A[y+4] = CHI(B[y+4], B[y+0], B[y+1]); \
+        } \
+        A[0] = XOR(A[0], CONST(rc)); \
+    }
+
+#define XOR(a, b) _mm256_xor_si256(a, b)
+#define ROL(a, o) _mm256_or_si256(_mm256_slli_epi64(a, o), _mm256_srli_epi64(a, 64-(o)))
+#define CHI(a, b, c) _mm256_xor_si256(a, _mm256_andnot_si256(b, c))
+#define CONST(c) _mm256_set1_epi64x((long long)(c))
+
+KeccakFParallel_TARGET_AVX2
+static void KeccakF1600times4_AVX2(UINT8 * const * states, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds)
+{
+    __m256i A[25], B[25], C[5], D[5];
+    UINT64 lanes[4];
+
+    for(unsigned int i=0; i<25; i++) {
+        for(unsigned int j=0; j<4; j++)
+            memcpy(&lanes[j], states[j]+8*i, 8);
+        A[i] = _mm256_loadu_si256((const __m256i*)lanes);
+    }
+    for(int i=startRoundIndex; i<startRoundIndex+(int)nrRounds; i++)
+        KeccakF1600Parallel_round(roundConstants[((i % 255) + 255) % 255])
+    for(unsigned int i=0; i<25; i++) {
+        _mm256_storeu_si256((__m256i*)lanes, A[i]);
+        for(unsigned int j=0; j<4; j++)
+            memcpy(states[j]+8*i, &lanes[j], 8);
+    }
+}
+
+#undef XOR
+#undef ROL
+#undef CHI
+#undef CONST
+
+#define XOR(a, b) _mm512_xor_si512(a, b)
+#define ROL(a, o) _mm512_rol_epi64(a, o)
+#define CHI(a, b, c) _mm512_ternarylogic_epi64(a, b, c, 0xD2)
+#define CONST(c) _mm512_set1_epi64((long long)(c))
+
+KeccakFParallel_TARGET_AVX512
+static void KeccakF1600times8_AVX512(UINT8 * const * states, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds)
+{
+    __m512i A[25], B[25], C[5], D[5];
+    UINT64 lanes[8];
+
+    for(unsigned int i=0; i<25; i++) {
+        for(unsigned int j=0; j<8; j++)
+            memcpy(&lanes[j], states[j]+8*i, 8);
+        A[i] = _mm512_loadu_si512((const void*)lanes);
+    }
+    for(int i=startRoundIndex; i<startRoundIndex+(int)nrRounds; i++)
+        KeccakF1600Parallel_round(roundConstants[((i % 255) + 255) % 255])
+    for(unsigned int i=0; i<25; i++) {
+        _mm512_storeu_si512((void*)lanes, A[i]);
+        for(unsigned int j=0; j<8; j++)
+            memcpy(states[j]+8*i, &lanes[j], 8);
+    }
+}
+
+#undef XOR
+#undef ROL
+#undef CHI
+#undef CONST
+
+#if defined(_MSC_VER)
+static bool isOSSupportingXState(UINT64 mask)
+{
+    return (_xgetbv(0) & mask) == mask;
+}
+
+static bool isCPUIDBitSet(int leaf, int subleaf, int reg, int bit)
+{
+    int info[4];
+    __cpuidex(info, leaf, subleaf);
+    return ((info[reg] >> bit) & 1) != 0;
+}
+#endif
+
+static bool detectAVX2()
+{
+#if defined(_MSC_VER)
+    return isCPUIDBitSet(1, 0, 2, 27) && isOSSupportingXState(0x06) && isCPUIDBitSet(7, 0, 1, 5);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx2") != 0;
+#endif
+}
+
+static bool detectAVX512()
+{
+#if defined(_MSC_VER)
+    return isCPUIDBitSet(1, 0, 2, 27) && isOSSupportingXState(0xE6) && isCPUIDBitSet(7, 0, 1, 16);
+#else
+    __builtin_cpu_init();
+    return __builtin_cpu_supports("avx512f") != 0;
+#endif
+}
+
+#endif
+
+bool isKeccakFParallelBackendSupported(KeccakFParallelBackend backend)
+{
+#ifdef KeccakFParallel_x86
+    static const bool AVX2 = detectAVX2();
+    static const bool AVX512 = detectAVX512();
+    if (backend == KeccakFParallelAVX2)
+        return AVX2;
+    else if (backend == KeccakFParallelAVX512)
+        return AVX512;
+#endif
+    return (backend == KeccakFParallelScalar);
+}
+
+KeccakFParallelBackend getKeccakFParallelBackend()
+{
+    if (isKeccakFParallelBackendSupported(KeccakFParallelAVX512))
+        return KeccakFParallelAVX512;
+    else if (isKeccakFParallelBackendSupported(KeccakFParallelAVX2))
+        return KeccakFParallelAVX2;
+    else
+        return KeccakFParallelScalar;
+}
+
+unsigned int getKeccakFParallelism(KeccakFParallelBackend backend)
+{
+    switch(backend) {
+    case KeccakFParallelAVX2:
+        return 4;
+    case KeccakFParallelAVX512:
+        return 8;
+    default:
+        return 1;
+    }
+}
+
+string getKeccakFParallelBackendName(KeccakFParallelBackend backend)
+{
+    switch(backend) {
+    case KeccakFParallelAVX2:
+        return "AVX2";
+    case KeccakFParallelAVX512:
+        return "AVX-512";
+    default:
+        return "scalar";
+    }
+}
+
+void KeccakF1600Parallel(KeccakFParallelBackend backend, UINT8 * const * states, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds)
+{
+#ifdef KeccakFParallel_x86
+    if (backend == KeccakFParallelAVX2) {
+        KeccakF1600times4_AVX2(states, roundConstants, startRoundIndex, nrRounds);
+        return;
+    }
+    else if (backend == KeccakFParallelAVX512) {
+        KeccakF1600times8_AVX512(states, roundConstants, startRoundIndex, nrRounds);
+        return;
+    }
+#endif
+    throw Exception("KeccakF1600Parallel: backend " + getKeccakFParallelBackendName(backend) + " not available.");
+}
@@ -0,0 +1,72 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFPARALLEL_H_
+#define _KECCAKFPARALLEL_H_
+
+#include <string>
+#include "types.h"
+
+/**
+  * The implementations available to apply Keccak-<i>p</i>[1600] onto several
+  * independent states at once, each one using SIMD registers that hold
+  * the same lane of several states.
+  */
+enum KeccakFParallelBackend {
+    /** One state at a time, see KeccakFUnrolled. */
+    KeccakFParallelScalar = 0,
+    /** Four states at a time in 256-bit AVX2 registers. */
+    KeccakFParallelAVX2 = 1,
+    /** Eight states at a time in 512-bit AVX-512 registers. */
+    KeccakFParallelAVX512 = 2
+};
+
+/**
+  * Function that returns the fastest backend supported by the processor
+  * and by the operating system. The detection is done only once.
+  */
+KeccakFParallelBackend getKeccakFParallelBackend();
+
+/**
+  * Function that tells whether the given backend is supported
+  * by the processor and by the operating system.
+  */
+bool isKeccakFParallelBackendSupported(KeccakFParallelBackend backend);
+
+/**
+  * Function that returns the number of states that the given backend
+  * processes at once.
+  */
+unsigned int getKeccakFParallelism(KeccakFParallelBackend backend);
+
+/**
+  * Function that returns the name of the given backend.
+  */
+std::string getKeccakFParallelBackendName(KeccakFParallelBackend backend);
+
+/**
+  * Function that applies the given range of rounds of Keccak-<i>f</i>[1600]
+  * onto getKeccakFParallelism(backend) states at once, using the given backend.
+  * The backend must be supported (see isKeccakFParallelBackendSupported()).
+  *
+  * @param  backend     The backend to use.
+  * @param  states      Pointers to the states, each as an array of 200 bytes.
+  * @param  roundConstants  The 255 round constants, as in KeccakF::getRoundConstant().
+  * @param  startRoundIndex The index of the first round to perform.
+  * @param  nrRounds        The number of rounds to perform.
+  */
+void KeccakF1600Parallel(KeccakFParallelBackend backend, UINT8 * const * states, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds);
+
+#endif
@@ -17,11 +17,13 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #include <fstream>
 #include <iostream>
 #include <math.h>
+#include <sstream>
 #include "Keccak-fDCLC.h"
 #include "Keccak-fDisplay.h"
 #include "Keccak-fParity.h"
 #include "Keccak-fPropagation.h"
 #include "Keccak-fTrails.h"
+#include "threads.h"
 
 const RowValue maskRowValue = 0x1F;
 
@@ -77,9 +79,7 @@ KeccakFPropagation::KeccakFPropagation(const KeccakFDCLC& aParent, KeccakFPropag
     reverseLambdaMode((aDCorLC == DC) ? KeccakFDCLC::Inverse : KeccakFDCLC::Dual)
 {
     initializeAffine();
-    initializeWeight();
-    initializeMinReverseWeight();
-    initializeChiCompatibilityTable();
+    initializeSliceTables();
 }
 
 void KeccakFPropagation::initializeAffine()
@@ -163,24 +163,53 @@ void KeccakFPropagation::initializeAffine()
     }
 }
 
-void KeccakFPropagation::initializeWeight()
+void KeccakFPropagation::initializeSliceTables()
 {
-    for(SliceValue slice=0; slice<=maxSliceValue; slice++) {
-        unsigned int weightOfThisSlice = weightOfSlice(slice);
-        weightPerSlice.push_back(weightOfThisSlice);
+    const UINT64 nrSlices = (UINT64)maxSliceValue + 1;
+    const UINT64 size = 2*nrSlices + 32*32;
+    stringstream fileName;
+    fileName << "KeccakF-" << dec << parent.getWidth() << "-" << name << "-slices.cache";
+    if (!mappedSliceTables.open(fileName.str(), "KeccakFPropagationSlices", parent.getWidth(), getPropagationType(), sliceTablesVersion)
+            || (mappedSliceTables.getSize() != size)) {
+        sliceTables.resize(size);
+        initializeWeight(&sliceTables[0]);
+        initializeMinReverseWeight(&sliceTables[nrSlices]);
+        initializeChiCompatibilityTable(&sliceTables[2*nrSlices]);
+        MappedTable::save(fileName.str(), "KeccakFPropagationSlices", parent.getWidth(), getPropagationType(), sliceTablesVersion,
+            &sliceTables[0], size);
+        if (mappedSliceTables.open(fileName.str(), "KeccakFPropagationSlices", parent.getWidth(), getPropagationType(), sliceTablesVersion)
+                && (mappedSliceTables.getSize() == size))
+            vector<unsigned char>().swap(sliceTables);
+        else
+            mappedSliceTables.close();
     }
+    const unsigned char *tables = mappedSliceTables.isOpen() ?
+        (const unsigned char *)mappedSliceTables.getData() : &sliceTables[0];
+    weightPerSlice = tables;
+    minReverseWeightPerSlice = tables + nrSlices;
+    chiCompatibilityTable = tables + 2*nrSlices;
 }
 
-void KeccakFPropagation::initializeMinReverseWeight()
+void KeccakFPropagation::initializeWeight(unsigned char *table) const
 {
-    for(SliceValue slice=0; slice<=maxSliceValue; slice++) {
-        unsigned int minReverseWeight = 0;
-        for(unsigned int y=0; y<nrRowsAndColumns; y++) {
-            RowValue row = getRowFromSlice(slice, y);
-            minReverseWeight += reverseRowOutputListPerInput[row].minWeight;
+    parallelFor(0, (UINT64)maxSliceValue+1, [this, table](UINT64 begin, UINT64 end) {
+        for(UINT64 slice=begin; slice<end; slice++)
+            table[slice] = (unsigned char)weightOfSlice((SliceValue)slice);
+    });
+}
+
+void KeccakFPropagation::initializeMinReverseWeight(unsigned char *table) const
+{
+    parallelFor(0, (UINT64)maxSliceValue+1, [this, table](UINT64 begin, UINT64 end) {
+        for(UINT64 slice=begin; slice<end; slice++) {
+            unsigned int minReverseWeight = 0;
+            for(unsigned int y=0; y<nrRowsAndColumns; y++) {
+                RowValue row = getRowFromSlice((SliceValue)slice, y);
+                minReverseWeight += reverseRowOutputListPerInput[row].minWeight;
+            }
+            table[slice] = (unsigned char)minReverseWeight;
         }
-        minReverseWeightPerSlice.push_back(minReverseWeight);
-    }
+    });
 }
 
 KeccakFPropagation::DCorLC KeccakFPropagation::getPropagationType() const
@@ -560,13 +589,12 @@ UINT64 KeccakFPropagation::displayTrailsAndCheck(const string& fileNameIn, ostre
     return totalCount;
 }
 
-void KeccakFPropagation::initializeChiCompatibilityTable()
+void KeccakFPropagation::initializeChiCompatibilityTable(unsigned char *table) const
 {
-    chiCompatibilityTable.assign(32*32, false);
     for(RowValue a=0; a<32; a++) for(RowValue b=0; b<32; b++) {
         const vector<RowValue>& values = directRowOutputListPerInput[a].values;
-        chiCompatibilityTable[a+32*b] =
-            find(values.begin(), values.end(), b) != values.end();
+        table[a+32*b] =
+            (find(values.begin(), values.end(), b) != values.end()) ? 1 : 0;
     }
 }
 
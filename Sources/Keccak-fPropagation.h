@@ -20,6 +20,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #include "Keccak-fAffineBases.h"
 #include "Keccak-fDCLC.h"
 #include "Keccak-fParts.h"
+#include "mappedtable.h"
 using namespace std;
 
 class ReverseStateIterator;
@@ -71,17 +72,28 @@ protected:
       */
     KeccakFDCLC::LambdaMode reverseLambdaMode;
 private:
-    /** This attribute contains the propagation weight of every possible slice value.
+    /** The version of the format of the slice tables cache file.
       */
-    vector<unsigned char> weightPerSlice;
-    /** This attribute contains the minimum reverse weight of every possible slice value.
+    static const unsigned int sliceTablesVersion = 1;
+    /** This attribute maps the cache file containing weightPerSlice,
+      * minReverseWeightPerSlice and chiCompatibilityTable, in this order.
       */
-    vector<unsigned char> minReverseWeightPerSlice;
-    /** This vector tells whether a pattern x at the input of χ is compatible
+    MappedTable mappedSliceTables;
+    /** This attribute contains the same tables as mappedSliceTables,
+      * in case the cache file could not be written or mapped.
+      */
+    vector<unsigned char> sliceTables;
+    /** This attribute points to the propagation weight of every possible slice value.
+      */
+    const unsigned char *weightPerSlice;
+    /** This attribute points to the minimum reverse weight of every possible slice value.
+      */
+    const unsigned char *minReverseWeightPerSlice;
+    /** This table tells whether a pattern x at the input of χ is compatible
       * with output y. This can be found in chiCompatibilityTable[x+32*y].
       * See also isChiCompatible().
       */
-    vector<bool> chiCompatibilityTable;
+    const unsigned char *chiCompatibilityTable;
 public:
     /** This type allows one to specify the type of propagation: differential (DC) or linear (LC). */
     enum DCorLC { DC = 0, LC };
@@ -275,7 +287,7 @@ public:
       */
     inline bool isChiCompatible(const RowValue& beforeChi, const RowValue& afterChi) const
     {
-        return chiCompatibilityTable[beforeChi+32*afterChi];
+        return chiCompatibilityTable[beforeChi+32*afterChi] != 0;
     }
     /** This method returns true iff the given state before χ is compatible with the given state after χ.
       * @param   beforeChi  The state value at the input of χ.
@@ -434,15 +446,20 @@ private:
     /** This method initializes affinePerInput.
       */
     void initializeAffine();
-    /** This method initializes weightPerSlice.
+    /** This method maps weightPerSlice, minReverseWeightPerSlice and chiCompatibilityTable
+      * from the file "KeccakF-<i>width</i>-DC-slices.cache" (or "-LC-"),
+      * after computing and saving them if the file does not exist or does not match.
+      */
+    void initializeSliceTables();
+    /** This method computes the weight of every slice value into @a table.
       */
-    void initializeWeight();
-    /** This method initializes minReverseWeightPerSlice.
+    void initializeWeight(unsigned char *table) const;
+    /** This method computes the minimum reverse weight of every slice value into @a table.
       */
-    void initializeMinReverseWeight();
-    /** This method initializes chiCompatibilityTable.
+    void initializeMinReverseWeight(unsigned char *table) const;
+    /** This method computes the χ compatibility of every pair of rows into @a table.
       */
-    void initializeChiCompatibilityTable();
+    void initializeChiCompatibilityTable(unsigned char *table) const;
     unsigned int weightOfSlice(SliceValue slice) const;
 };
 
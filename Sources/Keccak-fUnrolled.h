@@ -0,0 +1,360 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _KECCAKFUNROLLED_H_
+#define _KECCAKFUNROLLED_H_
+
+#include "types.h"
+
+/**
+  * Class template implementing the Keccak-<i>f</i> round function
+  * with the lane size fixed at compile time.
+  * The state is a plain array of 25 words on the stack, the ρ offsets are
+  * compile-time constants and the θ, ρ, π, χ and ι steps are fully unrolled,
+  * so that applying the permutation or its inverse does not require any
+  * heap allocation.
+  * The round constants and the range of rounds are given at run time,
+  * as they depend on the KeccakF instance (see KeccakP or KeccakFanyRounds).
+  *
+  * @param  Word        An unsigned integer type that can hold one lane.
+  * @param  laneSize    The lane size, i.e., the width divided by 25.
+  */
+template<class Word, unsigned int laneSize>
+class KeccakFUnrolled {
+public:
+    /**
+      * Function that returns a word whose first laneSize bits are 1 and all others 0.
+      */
+    static inline Word mask()
+    {
+        return (Word)((~(UINT64)0) >> (64-laneSize));
+    }
+    /**
+      * Function that translates a lane along the z-axis by a compile-time offset.
+      * The offset is first reduced modulo laneSize.
+      */
+    template<unsigned int offset>
+    static inline Word ROL(Word a)
+    {
+        return (Word)(((a << (offset%laneSize)) | (a >> ((laneSize - offset%laneSize)%laneSize))) & mask());
+    }
+    /**
+      * Function that applies one round onto the 25 lanes in @a A.
+      *
+      * @param  A       The state as an array of 25 lanes,
+      *                 numbered as in KeccakF::index().
+      * @param  roundConstant   The round constant to add in ι.
+      */
+    static inline void round(Word *A, Word roundConstant)
+    {
+        Word B[25], C[5], D[5];
+
+        // θ
+        for(unsigned int x=0; x<5; x++)
+            C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+        D[0] = C[4] ^ ROL<1>(C[1]);
+        D[1] = C[0] ^ ROL<1>(C[2]);
+        D[2] = C[1] ^ ROL<1>(C[3]);
+        D[3] = C[2] ^ ROL<1>(C[4]);
+        D[4] = C[3] ^ ROL<1>(C[0]);
+
+        // ρ and π
+        B[ 0] = ROL< 0>(A[ 0] ^ D[0]);
+        B[10] = ROL< 1>(A[ 1] ^ D[1]);
+        B[20] = ROL<62>(A[ 2] ^ D[2]);
+        B[ 5] = ROL<28>(A[ 3] ^ D[3]);
+        B[15] = ROL<27>(A[ 4] ^ D[4]);
+        B[16] = ROL<36>(A[ 5] ^ D[0]);
+        B[ 1] = ROL<44>(A[ 6] ^ D[1]);
+        B[11] = ROL< 6>(A[ 7] ^ D[2]);
+        B[21] = ROL<55>(A[ 8] ^ D[3]);
+        B[ 6] = ROL<20>(A[ 9] ^ D[4]);
+        B[ 7] = ROL< 3>(A[10] ^ D[0]);
+        B[17] = ROL<10>(A[11] ^ D[1]);
+        B[ 2] = ROL<43>(A[12] ^ D[2]);
+        B[12] = ROL<25>(A[13] ^ D[3]);
+        B[22] = ROL<39>(A[14] ^ D[4]);
+        B[23] = ROL<41>(A[15] ^ D[0]);
+        B[ 8] = ROL<45>(A[16] ^ D[1]);
+        B[18] = ROL<15>(A[17] ^ D[2]);
+        B[ 3] = ROL<21>(A[18] ^ D[3]);
+        B[13] = ROL< 8>(A[19] ^ D[4]);
+        B[14] = ROL<18>(A[20] ^ D[0]);
+        B[24] = ROL< 2>(A[21] ^ D[1]);
+        B[ 9] = ROL<61>(A[22] ^ D[2]);
+        B[19] = ROL<56>(A[23] ^ D[3]);
+        B[ 4] = ROL<14>(A[24] ^ D[4]);
+
+        // χ
+        for(unsigned int y=0; y<25; y+=5) {
+            A[y+0] = (Word)(B[y+0] ^ ((~B[y+1]) & B[y+2]));
+            A[y+1] = (Word)(B[y+1] ^ ((~B[y+2]) & B[y+3]));
+            A[y+2] = (Word)(B[y+2] ^ ((~B[y+3]) & B[y+4]));
+            A[y+3] = (Word)(B[y+3] ^ ((~B[y+4]) & B[y+0]));
+            A[y+4] = (Word)(B[y+4] ^ ((~B[y+0]) & B[y+1]));
+        }
+
+        // ι
+        A[0] ^= roundConstant;
+    }
+    /**
+      * Function that translates a lane along the z-axis by an offset
+      * given at run time, between 0 and laneSize-1.
+      */
+    static inline Word ROL(Word a, unsigned int offset)
+    {
+        return (Word)(((a << offset) | (a >> ((laneSize - offset)%laneSize))) & mask());
+    }
+    /**
+      * Structure that holds the schedule of θ<sup>-1</sup> on the column parities.
+      * Seen as polynomials in x and z, θ multiplies the column parities by
+      * M = 1 + x + x<sup>-1</sup>z. Since M<sup>2<sup>k</sup></sup> =
+      * 1 + x<sup>2<sup>k</sup></sup> + x<sup>-2<sup>k</sup></sup>z<sup>2<sup>k</sup></sup>
+      * and M<sup>15·laneSize</sup> = 1, the inverse of M is the product of the
+      * factors M<sup>2<sup>k</sup></sup> for the bits k set in 15·laneSize-1.
+      * Entry i of the schedule is one such factor, with
+      * xOffset[i] = 2<sup>k</sup> mod 5 and zOffset[i] = 2<sup>k</sup> mod laneSize.
+      */
+    struct InverseThetaSchedule {
+        unsigned int count;
+        unsigned int xOffset[16];
+        unsigned int zOffset[16];
+    };
+    /**
+      * Function that returns the θ<sup>-1</sup> schedule for this lane size.
+      */
+    static const InverseThetaSchedule& getInverseThetaSchedule()
+    {
+        static const InverseThetaSchedule schedule = buildInverseThetaSchedule();
+        return schedule;
+    }
+    /**
+      * Function that applies θ<sup>-1</sup> onto the 25 lanes in @a A.
+      * It computes the column parities after θ, recovers the column parities
+      * before θ using the schedule, and adds the corresponding θ-effect
+      * to each column.
+      */
+    static inline void inverseTheta(Word *A)
+    {
+        const InverseThetaSchedule& schedule = getInverseThetaSchedule();
+        Word C[5], P[5], D[5];
+
+        for(unsigned int x=0; x<5; x++)
+            C[x] = A[x] ^ A[x+5] ^ A[x+10] ^ A[x+15] ^ A[x+20];
+        for(unsigned int i=0; i<schedule.count; i++) {
+            unsigned int xOff = schedule.xOffset[i];
+            unsigned int zOff = schedule.zOffset[i];
+            for(unsigned int x=0; x<5; x++)
+                P[x] = C[x];
+            for(unsigned int x=0; x<5; x++)
+                C[x] = P[x] ^ P[(x+5-xOff)%5] ^ ROL(P[(x+xOff)%5], zOff);
+        }
+        D[0] = C[4] ^ ROL<1>(C[1]);
+        D[1] = C[0] ^ ROL<1>(C[2]);
+        D[2] = C[1] ^ ROL<1>(C[3]);
+        D[3] = C[2] ^ ROL<1>(C[4]);
+        D[4] = C[3] ^ ROL<1>(C[0]);
+        for(unsigned int y=0; y<25; y+=5)
+            for(unsigned int x=0; x<5; x++)
+                A[x+y] ^= D[x];
+    }
+    /**
+      * Function that applies the inverse of one round onto the 25 lanes in @a A.
+      *
+      * @param  A       The state as an array of 25 lanes,
+      *                 numbered as in KeccakF::index().
+      * @param  roundConstant   The round constant to add in ι.
+      */
+    static inline void inverseRound(Word *A, Word roundConstant)
+    {
+        Word B[25];
+
+        // ι
+        A[0] ^= roundConstant;
+
+        // χ^-1, on each plane, following the sequence of KeccakF::inverseChi()
+        for(unsigned int y=0; y<25; y+=5) {
+            Word C[5] = { A[y+0], A[y+1], A[y+2], A[y+3], A[y+4] };
+            B[y+0] = (Word)(C[0] ^ (C[2] & (~C[1])));
+            B[y+3] = (Word)(C[3] ^ (B[y+0] & (~C[4])));
+            B[y+1] = (Word)(C[1] ^ (B[y+3] & (~C[2])));
+            B[y+4] = (Word)(C[4] ^ (B[y+1] & (~C[0])));
+            B[y+2] = (Word)(C[2] ^ (B[y+4] & (~C[3])));
+            B[y+0] = (Word)(C[0] ^ (B[y+2] & (~C[1])));
+        }
+
+        // π^-1 and ρ^-1
+        A[ 0] = ROL<64>(B[ 0]);
+        A[ 1] = ROL<63>(B[10]);
+        A[ 2] = ROL< 2>(B[20]);
+        A[ 3] = ROL<36>(B[ 5]);
+        A[ 4] = ROL<37>(B[15]);
+        A[ 5] = ROL<28>(B[16]);
+        A[ 6] = ROL<20>(B[ 1]);
+        A[ 7] = ROL<58>(B[11]);
+        A[ 8] = ROL< 9>(B[21]);
+        A[ 9] = ROL<44>(B[ 6]);
+        A[10] = ROL<61>(B[ 7]);
+        A[11] = ROL<54>(B[17]);
+        A[12] = ROL<21>(B[ 2]);
+        A[13] = ROL<39>(B[12]);
+        A[14] = ROL<25>(B[22]);
+        A[15] = ROL<23>(B[23]);
+        A[16] = ROL<19>(B[ 8]);
+        A[17] = ROL<49>(B[18]);
+        A[18] = ROL<43>(B[ 3]);
+        A[19] = ROL<56>(B[13]);
+        A[20] = ROL<46>(B[14]);
+        A[21] = ROL<62>(B[24]);
+        A[22] = ROL< 3>(B[ 9]);
+        A[23] = ROL< 8>(B[19]);
+        A[24] = ROL<50>(B[ 4]);
+
+        // θ^-1
+        inverseTheta(A);
+    }
+    /**
+      * Function that applies π onto the 25 lanes in @a A.
+      */
+    static void pi(Word *A)
+    {
+        Word a[25];
+        for(unsigned int i=0; i<25; i++)
+            a[i] = A[i];
+        for(unsigned int x=0; x<5; x++)
+            for(unsigned int y=0; y<5; y++)
+                A[y+5*((2*x+3*y)%5)] = a[x+5*y];
+    }
+    /**
+      * Function that applies π<sup>-1</sup> onto the 25 lanes in @a A.
+      */
+    static void inversePi(Word *A)
+    {
+        Word a[25];
+        for(unsigned int i=0; i<25; i++)
+            a[i] = A[i];
+        for(unsigned int x=0; x<5; x++)
+            for(unsigned int y=0; y<5; y++)
+                A[x+5*y] = a[y+5*((2*x+3*y)%5)];
+    }
+    /**
+      * Function that applies the given range of rounds onto the 25 lanes in @a A.
+      *
+      * @param  A       The state as an array of 25 lanes.
+      * @param  roundConstants  The 255 round constants, as in KeccakF::getRoundConstant().
+      * @param  startRoundIndex The index of the first round to perform.
+      * @param  nrRounds        The number of rounds to perform.
+      */
+    static void forward(Word *A, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds)
+    {
+        for(int i=startRoundIndex; i<startRoundIndex+(int)nrRounds; i++)
+            round(A, (Word)roundConstants[((i % 255) + 255) % 255]);
+    }
+    /**
+      * Function that applies the inverse of the given range of rounds
+      * onto the 25 lanes in @a A.
+      *
+      * @param  A       The state as an array of 25 lanes.
+      * @param  roundConstants  The 255 round constants, as in KeccakF::getRoundConstant().
+      * @param  startRoundIndex The index of the first round of the range.
+      * @param  nrRounds        The number of rounds in the range.
+      */
+    static void inverse(Word *A, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds)
+    {
+        for(int i=startRoundIndex+(int)nrRounds-1; i>=startRoundIndex; i--)
+            inverseRound(A, (Word)roundConstants[((i % 255) + 255) % 255]);
+    }
+    /**
+      * Function that converts a state given as an array of bytes into 25 lanes.
+      */
+    static void fromBytesToLanes(const UINT8 *in, Word *out)
+    {
+        if (laneSize < 8) {
+            for(unsigned int i=0; i<25; i++)
+                out[i] = (Word)((in[i*laneSize/8] >> ((i*laneSize) % 8)) & mask());
+        }
+        else {
+            for(unsigned int i=0; i<25; i++) {
+                UINT64 lane = 0;
+                for(unsigned int j=0; j<(laneSize/8); j++)
+                    lane |= (UINT64)in[i*(laneSize/8)+j] << (8*j);
+                out[i] = (Word)lane;
+            }
+        }
+    }
+    /**
+      * Function that converts 25 lanes into a state given as an array of bytes.
+      */
+    static void fromLanesToBytes(const Word *in, UINT8 *out)
+    {
+        if (laneSize < 8) {
+            for(unsigned int i=0; i<(25*laneSize+7)/8; i++)
+                out[i] = 0;
+            for(unsigned int i=0; i<25; i++)
+                out[i*laneSize/8] |= (UINT8)(in[i] << ((i*laneSize) % 8));
+        }
+        else {
+            for(unsigned int i=0; i<25; i++)
+                for(unsigned int j=0; j<(laneSize/8); j++)
+                    out[i*(laneSize/8)+j] = (UINT8)((UINT64)in[i] >> (8*j));
+        }
+    }
+    /**
+      * Function that applies the given range of rounds, or their inverse,
+      * onto a state given as an array of bytes.
+      *
+      * @param  state   The state as an array of ceil(25*laneSize/8) bytes.
+      * @param  roundConstants  The 255 round constants.
+      * @param  startRoundIndex The index of the first round of the range.
+      * @param  nrRounds        The number of rounds in the range.
+      * @param  inverseRounds   If true, the inverse of the rounds is applied.
+      * @param  twisted If true, π<sup>-1</sup> is applied before the rounds
+      *                 and π after them, as in KeccakPStar.
+      */
+    static void permute(UINT8 *state, const UINT64 *roundConstants, int startRoundIndex, unsigned int nrRounds, bool inverseRounds = false, bool twisted = false)
+    {
+        Word A[25];
+        fromBytesToLanes(state, A);
+        if (twisted)
+            inversePi(A);
+        if (inverseRounds)
+            inverse(A, roundConstants, startRoundIndex, nrRounds);
+        else
+            forward(A, roundConstants, startRoundIndex, nrRounds);
+        if (twisted)
+            pi(A);
+        fromLanesToBytes(A, state);
+    }
+protected:
+    static InverseThetaSchedule buildInverseThetaSchedule()
+    {
+        InverseThetaSchedule schedule;
+        schedule.count = 0;
+        unsigned int exponent = 15*laneSize - 1;
+        unsigned int xOffset = 1, zOffset = 1%laneSize;
+        for(unsigned int k=0; (exponent >> k) != 0; k++) {
+            if (((exponent >> k) & 1) != 0) {
+                schedule.xOffset[schedule.count] = xOffset;
+                schedule.zOffset[schedule.count] = zOffset;
+                schedule.count++;
+            }
+            xOffset = (2*xOffset) % 5;
+            zOffset = (2*zOffset) % laneSize;
+        }
+        return schedule;
+    }
+};
+
+#endif
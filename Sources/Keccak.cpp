@@ -16,11 +16,12 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #include <iostream>
 #include <sstream>
 #include "Keccak.h"
+#include "Keccak-fAutotune.h"
 
 using namespace std;
 
 Keccak::Keccak(unsigned int aRate, unsigned int aCapacity)
-    : Sponge(new KeccakF(aRate+aCapacity), new MultiRatePadding(), aRate)
+    : Sponge(new KeccakFTuned(aRate+aCapacity), new MultiRatePadding(), aRate)
 {
 }
 
@@ -38,7 +39,7 @@ string Keccak::getDescription() const
 }
 
 ReducedRoundKeccak::ReducedRoundKeccak(unsigned int aRate, unsigned int aCapacity, int aStartRoundIndex, unsigned int aNrRounds)
-    : Sponge(new KeccakFanyRounds(aRate+aCapacity, aStartRoundIndex, aNrRounds), new MultiRatePadding(), aRate),
+    : Sponge(new KeccakFTuned(aRate+aCapacity, aStartRoundIndex, aNrRounds), new MultiRatePadding(), aRate),
     nrRounds(aNrRounds),
     startRoundIndex(aStartRoundIndex)
 {
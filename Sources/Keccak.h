@@ -25,7 +25,8 @@ http://creativecommons.org/publicdomain/zero/1.0/
 class Keccak : public Sponge {
 public:
     /**
-      * The constructor. It dynamically allocates a KeccakF permutation.
+      * The constructor. It dynamically allocates a KeccakFTuned permutation,
+      * i.e., the implementation of Keccak-<i>f</i> chosen by the autotuner for the host.
       *
       * @param  aRate       The desired rate (in bits) of the Keccak sponge
       *                     function.
@@ -55,7 +56,7 @@ protected:
     unsigned int startRoundIndex;
 public:
     /**
-      * The constructor. It dynamically allocates a KeccakF permutation
+      * The constructor. It dynamically allocates a KeccakFTuned permutation
       * with a chosen number of rounds, starting from a chosen round index.
       *
       * @param  aRate       The desired rate (in bits) of the Keccak sponge
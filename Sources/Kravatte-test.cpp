@@ -329,8 +329,81 @@ void printKravatteTestVectors()
 }
 #endif
 
+/**
+ * Checks Farfalle::operator(), which processes the layers in batches,
+ * against the straightforward block-by-block definition of Farfalle,
+ * on strings long enough to span several compression chunks.
+ */
+static void checkFarfalleLayers(bool multiThreaded)
+{
+    IterableTransformation<KeccakP>    p(1600, 6);
+    KravatteCompressionRollingFunction roll_c;
+    KravatteExpansionRollingFunction   roll_e;
+    Farfalle                           F(p, p, p, p, roll_c, roll_e, multiThreaded);
+    const unsigned int                 b = F.width();
+
+    vector<UINT8> K(32), M1(Farfalle::compressionChunkBlocks * b / 8 + 1234), M2(3 * b / 8);
+    generateSimpleRawMaterial(&K[0], (unsigned int)K.size(), 0x12, 0x34);
+    generateSimpleRawMaterial(&M1[0], (unsigned int)M1.size(), 0x56, 0x78);
+    generateSimpleRawMaterial(&M2[0], (unsigned int)M2.size(), 0x9A, 0xBC);
+    BitStrings Mseq = BitString(&M2[0], (unsigned int)M2.size() * 8 - 3) * BitString(&M1[0], (unsigned int)M1.size() * 8);
+    const unsigned int n = 5 * b + 17, q = 21;
+
+    BitString    k = p(BitString(K) || BitString::pad10(b, (unsigned int)K.size() * 8));
+    BitString    x = BitString::zeroes(b);
+    unsigned int I = 0;
+    for (unsigned int j = 0; j < Mseq.size(); j++)
+    {
+        unsigned int mu = (Mseq[j].size() + b) / b;
+        BitString M = Mseq[j] || BitString::pad10(mu * b, Mseq[j].size());
+        for (unsigned int i = 0; i < mu; i++)
+        {
+            x = x ^ p(BitString::substring(M, i * b, b) ^ roll_c(k, I + i));
+        }
+        I = I + mu + 1;
+    }
+    BitString kp = roll_c(k, I);
+    BitString y = p(x);
+    BitString z;
+    for (unsigned int j = 0; j * b < n + q; j++)
+    {
+        z = z || (p(roll_e(y, j)) ^ kp);
+    }
+
+    Farfalle_assert(F(BitString(K), Mseq, n, q) == BitString::substring(z, q, n));
+}
+
+/**
+ * Checks that absorbing the strings one at a time into a FarfalleState,
+ * as done by the SANE and SANSE modes, gives the same outputs as Farfalle::operator().
+ */
+static void checkFarfalleState(void)
+{
+    IterableTransformation<KeccakP>    p(1600, 6);
+    KravatteCompressionRollingFunction roll_c;
+    KravatteExpansionRollingFunction   roll_e;
+    Farfalle                           F(p, p, p, p, roll_c, roll_e);
+
+    UINT8 K[32], M[300];
+    generateSimpleRawMaterial(K, sizeof(K), 0x11, 0x22);
+    generateSimpleRawMaterial(M, sizeof(M), 0x33, 0x44);
+
+    BitStrings    history;
+    FarfalleState state = F.start(BitString(K, sizeof(K) * 8));
+    for (unsigned int j = 0; j < 20; j++)
+    {
+        BitString Mj(M, (j * 113) % (sizeof(M) * 8));
+        history = Mj * history;
+        F.absorb(state, Mj);
+        Farfalle_assert(F.squeeze(state, 200, j) == F(BitString(K, sizeof(K) * 8), history, 200, j));
+    }
+}
+
 void testKravatte(void)
 {
+    checkFarfalleLayers(false);
+    checkFarfalleLayers(true);
+    checkFarfalleState();
 
 #ifndef KeccakP1600_excluded
 #ifdef OUTPUT
@@ -18,40 +18,26 @@
 #define ROL64(a, offset) ((((UINT64)a) << offset) ^ (((UINT64)a) >> (64 - offset)))
 
 /* KravatteCompressionRollingFunction */
-BitString KravatteCompressionRollingFunction::operator()(const BitString &k, unsigned int i) const
+void KravatteCompressionRollingFunction::step(BitString &k) const
 {
-	vector<UINT8> kp(k.array(), k.array() + k.size() / 8);
-	UINT64 *lanes = reinterpret_cast<UINT64 *>(kp.data());
+	UINT64 *lanes = reinterpret_cast<UINT64 *>(k.array());
+	UINT64 x0 = lanes[5 * 4    ];
+	UINT64 x1 = lanes[5 * 4 + 1];
 
-	for (unsigned int j = 0; j < i; j++)
-	{
-		UINT64 x0 = lanes[5 * 4    ];
-		UINT64 x1 = lanes[5 * 4 + 1];
-
-		std::rotate(&lanes[5 * 4], &lanes[5 * 4 + 1], &lanes[5 * 5]);
-		lanes[5 * 4 + 4] = (ROL64(x0, 7) ^ x1 ^ (x1 >> 3));
-	}
-
-	return BitString(kp);
+	std::rotate(&lanes[5 * 4], &lanes[5 * 4 + 1], &lanes[5 * 5]);
+	lanes[5 * 4 + 4] = (ROL64(x0, 7) ^ x1 ^ (x1 >> 3));
 }
 
 /* KravatteExpansionRollingFunction */
-BitString KravatteExpansionRollingFunction::operator()(const BitString &k, unsigned int i) const
+void KravatteExpansionRollingFunction::step(BitString &k) const
 {
-	vector<UINT8> kp(k.array(), k.array() + k.size() / 8);
-	UINT64 *lanes = reinterpret_cast<UINT64 *>(kp.data());
-
-	for (unsigned int j = 0; j < i; j++)
-	{
-		UINT64 x0 = lanes[5 * 3    ];
-		UINT64 x1 = lanes[5 * 3 + 1];
-		UINT64 x2 = lanes[5 * 3 + 2];
-
-		std::rotate(&lanes[5 * 3], &lanes[5 * 3 + 1], &lanes[5 * 5]);
-		lanes[5 * 4 + 4] = (ROL64(x0, 7) ^ ROL64(x1, 18) ^ (x2 & (x1 >> 1)));
-	}
+	UINT64 *lanes = reinterpret_cast<UINT64 *>(k.array());
+	UINT64 x0 = lanes[5 * 3    ];
+	UINT64 x1 = lanes[5 * 3 + 1];
+	UINT64 x2 = lanes[5 * 3 + 2];
 
-	return BitString(kp);
+	std::rotate(&lanes[5 * 3], &lanes[5 * 3 + 1], &lanes[5 * 5]);
+	lanes[5 * 4 + 4] = (ROL64(x0, 7) ^ ROL64(x1, 18) ^ (x2 & (x1 >> 1)));
 }
 
 /* Kravatte Achouffe instantiation parameters */
@@ -82,14 +68,14 @@ Farfalle make_Short_Kravatte()
 	return Farfalle(KravatteParams::p_b, KravatteParams::p_c, KravatteParams::p_identity, KravatteParams::p_e, KravatteParams::roll_c, KravatteParams::roll_e);
 }
 
-Farfalle make_Kravatte()
+Farfalle make_Kravatte(bool multiThreaded = true)
 {
-	return Farfalle(KravatteParams::p_b, KravatteParams::p_c, KravatteParams::p_d, KravatteParams::p_e, KravatteParams::roll_c, KravatteParams::roll_e);
+	return Farfalle(KravatteParams::p_b, KravatteParams::p_c, KravatteParams::p_d, KravatteParams::p_e, KravatteParams::roll_c, KravatteParams::roll_e, multiThreaded);
 }
 
 /* Kravatte */
-Kravatte::Kravatte()
-	: Farfalle(make_Kravatte())
+Kravatte::Kravatte(bool multiThreaded)
+	: Farfalle(make_Kravatte(multiThreaded))
 {
 }
 
@@ -29,19 +29,19 @@ using namespace std;
 class KravatteCompressionRollingFunction : public BaseRollingFunction
 {
 	public:
-		BitString operator()(const BitString &k, unsigned int i) const;
+		void step(BitString &k) const;
 };
 
 class KravatteExpansionRollingFunction : public BaseRollingFunction
 {
 	public:
-		BitString operator()(const BitString &k, unsigned int i) const;
+		void step(BitString &k) const;
 };
 
 class Kravatte : public Farfalle
 {
 	public:
-		Kravatte();
+		Kravatte(bool multiThreaded = true);
 };
 
 class KravatteSANE : public FarfalleSANE
@@ -0,0 +1,99 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <iostream>
+#include <sstream>
+#include "ParallelHash.h"
+#include "ParallelHash-test.h"
+
+using namespace std;
+
+static vector<UINT8> fromHex(const string& hex)
+{
+    vector<UINT8> result;
+    for(unsigned int i=0; i+1<hex.size(); i+=2)
+        result.push_back((UINT8)stoul(hex.substr(i, 2), 0, 16));
+    return result;
+}
+
+static vector<UINT8> fromString(const string& s)
+{
+    return vector<UINT8>(s.begin(), s.end());
+}
+
+static void checkSample(unsigned int sample, unsigned int securityStrength, const string& X, unsigned int B,
+    const string& S, const string& expected)
+{
+    unsigned int L = 2*securityStrength;
+    if (ParallelHash::hash(securityStrength, fromHex(X), B, L, fromString(S)) != fromHex(expected)) {
+        stringstream str;
+        str << "ParallelHash" << dec << securityStrength << " does not match sample #" << sample << ".";
+        throw Exception(str.str());
+    }
+}
+
+static void checkSplitting(unsigned int securityStrength, unsigned int B, bool xof)
+{
+    vector<UINT8> X(3*(1 << 20) + 17);
+    for(unsigned int i=0; i<X.size(); i++)
+        X[i] = (UINT8)(i*7 + (i >> 11));
+    unsigned int L = xof ? 0 : 2*securityStrength;
+    vector<UINT8> expected;
+    {
+        ParallelHash parallelHash(securityStrength, B, L, fromString("split"), false);
+        parallelHash.absorb(X);
+        parallelHash.squeeze(expected, 2*securityStrength/8);
+    }
+    const unsigned int pieceSizes[] = { 1, 1000, B+1, 1 << 20 };
+    for(unsigned int p=0; p<sizeof(pieceSizes)/sizeof(pieceSizes[0]); p++) {
+        ParallelHash parallelHash(securityStrength, B, L, fromString("split"), true);
+        for(unsigned int i=0; i<X.size(); i+=pieceSizes[p])
+            parallelHash.absorb(&X[i], min((size_t)pieceSizes[p], X.size() - i));
+        vector<UINT8> output;
+        for(unsigned int i=0; i<2*securityStrength/8; i+=8)
+            parallelHash.squeeze(output, 8);
+        if (output != expected) {
+            stringstream str;
+            str << "ParallelHash" << (xof ? "XOF" : "") << dec << securityStrength << " with B=" << B
+                << " gives a different output when absorbing per " << pieceSizes[p] << " bytes.";
+            throw Exception(str.str());
+        }
+    }
+}
+
+void testParallelHash()
+{
+    const string X24 = "000102030405060710111213141516172021222324252627";
+    const string X72 = "000102030405060708090A0B101112131415161718191A1B202122232425262728292A2B"
+        "303132333435363738393A3B404142434445464748494A4B505152535455565758595A5B";
+    checkSample(1, 128, X24, 8, "",
+        "BA8DC1D1D979331D3F813603C67F72609AB5E44B94A0B8F9AF46514454A2B4F5");
+    checkSample(2, 128, X24, 8, "Parallel Data",
+        "FC484DCB3F84DCEEDC353438151BEE58157D6EFED0445A81F165E495795B7206");
+    checkSample(3, 128, X72, 12, "Parallel Data",
+        "F7FD5312896C6685C828AF7E2ADB97E393E7F8D54E3C2EA4B95E5ACA3796E8FC");
+    checkSample(4, 256, X24, 8, "",
+        "BC1EF124DA34495E948EAD207DD9842235DA432D2BBC54B4C110E64C45110553"
+        "1B7F2A3E0CE055C02805E7C2DE1FB746AF97A1DD01F43B824E31B87612410429");
+    checkSample(5, 256, X24, 8, "Parallel Data",
+        "CDF15289B54F6212B4BC270528B49526006DD9B54E2B6ADD1EF6900DDA3963BB"
+        "33A72491F236969CA8AFAEA29C682D47A393C065B38E29FAE651A2091C833110");
+    checkSample(6, 256, X72, 12, "Parallel Data",
+        "69D0FCB764EA055DD09334BC6021CB7E4B61348DFF375DA262671CDEC3EFFA8D"
+        "1B4568A6CCE16B1CAD946DDDE27F6CE2B8DEE4CD1B24851EBF00EB90D43813E9");
+    checkSplitting(128, 8192, false);
+    checkSplitting(256, 1000, true);
+    cout << "ParallelHash: OK" << endl;
+}
@@ -0,0 +1,28 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _PARALLELHASHTEST_H_
+#define _PARALLELHASHTEST_H_
+
+/**
+  * Function that checks ParallelHash128 and ParallelHash256 against the
+  * samples published by NIST for SP 800-185, and checks that the output
+  * does not depend on how the input is split into calls to absorb()
+  * or on the number of threads.
+  * It throws an Exception in case of mismatch.
+  */
+void testParallelHash();
+
+#endif
@@ -0,0 +1,191 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include "ParallelHash.h"
+#include "threads.h"
+
+using namespace std;
+
+vector<UINT8> leftEncode(UINT64 x)
+{
+    vector<UINT8> encoding = rightEncode(x);
+    encoding.insert(encoding.begin(), encoding.back());
+    encoding.pop_back();
+    return encoding;
+}
+
+vector<UINT8> rightEncode(UINT64 x)
+{
+    vector<UINT8> encoding;
+    do {
+        encoding.insert(encoding.begin(), (UINT8)(x & 0xFF));
+        x >>= 8;
+    } while(x > 0);
+    encoding.push_back((UINT8)encoding.size());
+    return encoding;
+}
+
+vector<UINT8> encodeString(const vector<UINT8>& s)
+{
+    vector<UINT8> encoding = leftEncode((UINT64)s.size()*8);
+    encoding.insert(encoding.end(), s.begin(), s.end());
+    return encoding;
+}
+
+vector<UINT8> bytepad(const vector<UINT8>& x, unsigned int w)
+{
+    vector<UINT8> padded = leftEncode(w);
+    padded.insert(padded.end(), x.begin(), x.end());
+    padded.resize(((padded.size() + w - 1)/w)*w, 0);
+    return padded;
+}
+
+CSHAKE::CSHAKE(unsigned int securityStrength, const vector<UINT8>& N, const vector<UINT8>& S)
+    : f(1600), sponge(&f, &pad, 1600 - 2*securityStrength), isSHAKE(N.empty() && S.empty()), squeezing(false)
+{
+    if ((securityStrength != 128) && (securityStrength != 256))
+        throw SpongeException("The security strength of cSHAKE must be 128 or 256.");
+    if (!isSHAKE) {
+        vector<UINT8> prefix = encodeString(N);
+        vector<UINT8> encodedS = encodeString(S);
+        prefix.insert(prefix.end(), encodedS.begin(), encodedS.end());
+        prefix = bytepad(prefix, (1600 - 2*securityStrength)/8);
+        sponge.absorb(prefix, (unsigned int)prefix.size()*8);
+    }
+}
+
+void CSHAKE::absorb(const UINT8 *input, UINT64 lengthInBytes)
+{
+    if (squeezing)
+        throw SpongeException("The absorbing phase is over.");
+    const UINT64 maxChunkSize = 1 << 28;
+    while(lengthInBytes > 0) {
+        unsigned int count = (lengthInBytes > maxChunkSize) ? (unsigned int)maxChunkSize : (unsigned int)lengthInBytes;
+        sponge.absorb(input, count*8);
+        input += count;
+        lengthInBytes -= count;
+    }
+}
+
+void CSHAKE::absorb(const vector<UINT8>& input)
+{
+    if (!input.empty())
+        absorb(&input[0], input.size());
+}
+
+void CSHAKE::switchToSqueezingPhase()
+{
+    // SHAKE appends the bits 1111, and cSHAKE the bits 00.
+    const UINT8 suffix = isSHAKE ? 0x0F : 0x00;
+    sponge.absorb(&suffix, isSHAKE ? 4 : 2);
+    squeezing = true;
+}
+
+void CSHAKE::squeeze(UINT8 *output, unsigned int lengthInBytes)
+{
+    if (!squeezing)
+        switchToSqueezingPhase();
+    sponge.squeeze(output, lengthInBytes*8);
+}
+
+void CSHAKE::squeeze(vector<UINT8>& output, unsigned int lengthInBytes)
+{
+    if (!squeezing)
+        switchToSqueezingPhase();
+    sponge.squeeze(output, lengthInBytes*8);
+}
+
+static const vector<UINT8> parallelHashName = { 'P', 'a', 'r', 'a', 'l', 'l', 'e', 'l', 'H', 'a', 's', 'h' };
+
+static unsigned int getBlocksPerBatch(unsigned int blockSize, bool multiThreaded)
+{
+    unsigned int blocksPerBatch = (blockSize > 0) ? (1 << 19)/blockSize : 0;
+    if (blocksPerBatch < 8)
+        blocksPerBatch = 8;
+    if (multiThreaded)
+        blocksPerBatch *= getNumberOfThreads();
+    return blocksPerBatch;
+}
+
+ParallelHash::ParallelHash(unsigned int aSecurityStrength, unsigned int aBlockSize, unsigned int aOutputLengthInBits,
+    const vector<UINT8>& aCustomization, bool aMultiThreaded)
+    : securityStrength(aSecurityStrength), blockSize(aBlockSize), outputLengthInBits(aOutputLengthInBits),
+    f(1600), blockHasher(&f, &pad, 1600 - 2*aSecurityStrength, aMultiThreaded),
+    outer(aSecurityStrength, parallelHashName, aCustomization),
+    // Each block is hashed with SHAKE, i.e., followed by the bits 1111.
+    blocks(&blockHasher, aBlockSize, 0x0F, 4, 2*aSecurityStrength, getBlocksPerBatch(aBlockSize, aMultiThreaded),
+        [this](const vector<UINT8>& blockValue) { outer.absorb(blockValue); }),
+    squeezing(false), squeezedBytes(0)
+{
+    if (blockSize == 0)
+        throw SpongeException("The block size of ParallelHash must be strictly positive.");
+    if ((outputLengthInBits % 8) != 0)
+        throw SpongeException("The output length of ParallelHash must be a multiple of 8.");
+    outer.absorb(leftEncode(blockSize));
+}
+
+void ParallelHash::absorb(const UINT8 *input, UINT64 lengthInBytes)
+{
+    if (squeezing)
+        throw SpongeException("The absorbing phase is over.");
+    blocks.absorb(input, lengthInBytes);
+}
+
+void ParallelHash::absorb(const vector<UINT8>& input)
+{
+    if (!input.empty())
+        absorb(&input[0], input.size());
+}
+
+void ParallelHash::finish()
+{
+    blocks.flush();
+    outer.absorb(rightEncode(blocks.getNumberOfLeaves()));
+    outer.absorb(rightEncode(outputLengthInBits));
+    squeezing = true;
+}
+
+void ParallelHash::squeeze(UINT8 *output, unsigned int lengthInBytes)
+{
+    if (!squeezing)
+        finish();
+    if ((outputLengthInBits > 0) && (squeezedBytes + lengthInBytes > outputLengthInBits/8))
+        throw SpongeException("ParallelHash cannot give more than L bits of output.");
+    outer.squeeze(output, lengthInBytes);
+    squeezedBytes += lengthInBytes;
+}
+
+void ParallelHash::squeeze(vector<UINT8>& output, unsigned int lengthInBytes)
+{
+    vector<UINT8>::size_type previousSize = output.size();
+    output.resize(previousSize + lengthInBytes);
+    try {
+        squeeze(output.data() + previousSize, lengthInBytes);
+    }
+    catch(...) {
+        output.resize(previousSize);
+        throw;
+    }
+}
+
+vector<UINT8> ParallelHash::hash(unsigned int securityStrength, const vector<UINT8>& X, unsigned int B,
+    unsigned int L, const vector<UINT8>& S)
+{
+    ParallelHash parallelHash(securityStrength, B, L, S);
+    parallelHash.absorb(X);
+    vector<UINT8> output;
+    parallelHash.squeeze(output, L/8);
+    return output;
+}
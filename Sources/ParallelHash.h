@@ -0,0 +1,192 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _PARALLELHASH_H_
+#define _PARALLELHASH_H_
+
+#include <string>
+#include <vector>
+#include "Keccak-f.h"
+#include "padding.h"
+#include "sponge.h"
+#include "spongebatch.h"
+#include "types.h"
+
+using namespace std;
+
+/**
+  * Function that returns left_encode(@a x) as defined in NIST SP 800-185:
+  * the number of bytes of @a x, followed by the bytes of @a x
+  * in big-endian order without leading zeroes (but at least one byte).
+  */
+vector<UINT8> leftEncode(UINT64 x);
+
+/**
+  * Function that returns right_encode(@a x) as defined in NIST SP 800-185:
+  * the bytes of @a x as in leftEncode(), followed by their number.
+  */
+vector<UINT8> rightEncode(UINT64 x);
+
+/**
+  * Function that returns encode_string(@a s) as defined in NIST SP 800-185,
+  * i.e., left_encode(|@a s| in bits) || @a s.
+  */
+vector<UINT8> encodeString(const vector<UINT8>& s);
+
+/**
+  * Function that returns bytepad(@a x, @a w) as defined in NIST SP 800-185,
+  * i.e., left_encode(@a w) || @a x padded with zeroes to a multiple of @a w bytes.
+  */
+vector<UINT8> bytepad(const vector<UINT8>& x, unsigned int w);
+
+/**
+  * Class that implements cSHAKE128 and cSHAKE256 as defined in NIST SP 800-185.
+  * When both the function name <i>N</i> and the customization string <i>S</i>
+  * are empty, it is equal to SHAKE128 or SHAKE256.
+  * The objects cannot be copied, as their sponge refers to their own
+  * permutation and padding rule.
+  */
+class CSHAKE {
+protected:
+    /** The permutation Keccak-<i>f</i>[1600]. */
+    KeccakF f;
+    /** The padding rule pad10*1. */
+    MultiRatePadding pad;
+    /** The underlying sponge function. */
+    Sponge sponge;
+    /** Whether <i>N</i> and <i>S</i> are empty, i.e., whether this is SHAKE. */
+    bool isSHAKE;
+    /** Boolean indicating whether the output is being squeezed. */
+    bool squeezing;
+public:
+    /**
+      * The constructor.
+      *
+      * @param  securityStrength    128 or 256.
+      * @param  N   The function name <i>N</i>.
+      * @param  S   The customization string <i>S</i>.
+      */
+    CSHAKE(unsigned int securityStrength, const vector<UINT8>& N = vector<UINT8>(), const vector<UINT8>& S = vector<UINT8>());
+    /**
+      * Method that absorbs the next bytes of the input <i>X</i>.
+      *
+      * @pre This function must be used before squeeze() only.
+      */
+    void absorb(const UINT8 *input, UINT64 lengthInBytes);
+    /**
+      * Method that absorbs the next bytes of the input <i>X</i>.
+      *
+      * @pre This function must be used before squeeze() only.
+      */
+    void absorb(const vector<UINT8>& input);
+    /**
+      * Method that gives the next bytes of output.
+      */
+    void squeeze(UINT8 *output, unsigned int lengthInBytes);
+    /**
+      * Method that gives the next bytes of output, appended to @a output.
+      */
+    void squeeze(vector<UINT8>& output, unsigned int lengthInBytes);
+protected:
+    void switchToSqueezingPhase();
+private:
+    CSHAKE(const CSHAKE&);
+    CSHAKE& operator=(const CSHAKE&);
+};
+
+/**
+  * Class that implements ParallelHash128 and ParallelHash256, and their
+  * XOF variants, as defined in NIST SP 800-185.
+  *
+  * The input <i>X</i> is cut into blocks of <i>B</i> bytes, and each block
+  * is hashed with SHAKE128 or SHAKE256 into a value of 256 or 512 bits.
+  * The blocks are buffered and hashed together with SpongeBatch, so that
+  * several of them are permuted at once with the SIMD backends of
+  * KeccakF::permuteN() and spread over several threads.
+  * The block values are absorbed in order into the outer cSHAKE
+  * as soon as each batch is done, so the memory use does not depend
+  * on the length of <i>X</i>.
+  * The objects cannot be copied, for the same reason as CSHAKE.
+  */
+class ParallelHash {
+protected:
+    /** The security strength, 128 or 256. */
+    unsigned int securityStrength;
+    /** The block size <i>B</i> in bytes. */
+    unsigned int blockSize;
+    /** The output length <i>L</i> in bits, or 0 for the XOF variant. */
+    unsigned int outputLengthInBits;
+    /** The permutation Keccak-<i>f</i>[1600] used by the block hashes. */
+    KeccakF f;
+    /** The padding rule pad10*1. */
+    MultiRatePadding pad;
+    /** The object that hashes the blocks in batches. */
+    SpongeBatch blockHasher;
+    /** The outer cSHAKE with <i>N</i> = "ParallelHash". */
+    CSHAKE outer;
+    /** The blocks not yet hashed, whose values go to the outer cSHAKE. */
+    LeafBatchHasher blocks;
+    /** Boolean indicating whether the output is being squeezed. */
+    bool squeezing;
+    /** The number of bytes squeezed so far. */
+    UINT64 squeezedBytes;
+public:
+    /**
+      * The constructor.
+      *
+      * @param  aSecurityStrength   128 for ParallelHash128, 256 for ParallelHash256.
+      * @param  aBlockSize          The block size <i>B</i> in bytes.
+      * @param  aOutputLengthInBits The output length <i>L</i> in bits,
+      *                             or 0 for ParallelHashXOF128 or ParallelHashXOF256.
+      * @param  aCustomization      The customization string <i>S</i>.
+      * @param  aMultiThreaded      Whether the blocks may be hashed by several threads.
+      */
+    ParallelHash(unsigned int aSecurityStrength, unsigned int aBlockSize, unsigned int aOutputLengthInBits,
+        const vector<UINT8>& aCustomization = vector<UINT8>(), bool aMultiThreaded = true);
+    /**
+      * Method that absorbs the next bytes of the input <i>X</i>.
+      *
+      * @pre This function must be used before squeeze() only.
+      */
+    void absorb(const UINT8 *input, UINT64 lengthInBytes);
+    /**
+      * Method that absorbs the next bytes of the input <i>X</i>.
+      *
+      * @pre This function must be used before squeeze() only.
+      */
+    void absorb(const vector<UINT8>& input);
+    /**
+      * Method that gives the next bytes of output. The first call finishes
+      * the hashing of <i>X</i>. Except for the XOF variant, at most <i>L</i>
+      * bits can be squeezed in total.
+      */
+    void squeeze(UINT8 *output, unsigned int lengthInBytes);
+    /**
+      * Method that gives the next bytes of output, appended to @a output.
+      */
+    void squeeze(vector<UINT8>& output, unsigned int lengthInBytes);
+    /**
+      * Function that computes ParallelHash(<i>X</i>, <i>B</i>, <i>L</i>, <i>S</i>) in one call.
+      */
+    static vector<UINT8> hash(unsigned int securityStrength, const vector<UINT8>& X, unsigned int B,
+        unsigned int L, const vector<UINT8>& S = vector<UINT8>());
+protected:
+    void finish();
+private:
+    ParallelHash(const ParallelHash&);
+    ParallelHash& operator=(const ParallelHash&);
+};
+
+#endif
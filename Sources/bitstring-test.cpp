@@ -0,0 +1,273 @@
+/*
+ * KeccakTools
+ *
+ * The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+ * Michaël Peeters and Gilles Van Assche. For more information, feedback or
+ * questions, please refer to our website: http://keccak.noekeon.org/
+ *
+ * Implementation by the designers,
+ * hereby denoted as "the implementer".
+ *
+ * To the extent possible under law, the implementer has waived all copyright
+ * and related or neighboring rights to the source code in this file.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "bitstring.h"
+#include "bitstring-test.h"
+
+using namespace std;
+
+static_assert(is_nothrow_move_constructible<BitString>::value, "BitString must be nothrow move constructible.");
+static_assert(is_nothrow_move_assignable<BitString>::value, "BitString must be nothrow move assignable.");
+
+typedef vector<int> Bits;
+
+static Bits randomBits(unsigned int size)
+{
+    Bits bits(size);
+    for(unsigned int i=0; i<size; i++)
+        bits[i] = rand() & 1;
+    return bits;
+}
+
+static Bits concatenate(const Bits& a, const Bits& b)
+{
+    Bits c(a);
+    c.insert(c.end(), b.begin(), b.end());
+    return c;
+}
+
+static BitString toBitString(const Bits& bits)
+{
+    vector<UINT8> bytes((bits.size() + 7)/8, 0);
+    for(unsigned int i=0; i<bits.size(); i++)
+        bytes[i/8] |= UINT8(bits[i] << (i%8));
+    return BitString(bytes.data(), (unsigned int)bits.size());
+}
+
+static Bits toBits(const BitString& S)
+{
+    Bits bits(S.size());
+    const UINT8 *bytes = S.array();
+    for(unsigned int i=0; i<S.size(); i++)
+        bits[i] = (bytes[i/8] >> (i%8)) & 1;
+    return bits;
+}
+
+static void check(const BitString& S, const Bits& expected, const char *operation, unsigned int iteration)
+{
+    if (toBits(S) != expected) {
+        stringstream str;
+        str << "BitString: " << operation << " does not match the model at iteration " << dec << iteration << ".";
+        throw Exception(str.str());
+    }
+}
+
+static unsigned int randomSize(unsigned int iteration)
+{
+    // Sizes multiple of 64 and beyond the inline storage are drawn regularly
+    unsigned int maxSize = (iteration % 8 == 0) ? 4000 : 300;
+    unsigned int size = rand() % maxSize;
+    return (iteration % 3 == 0) ? size & ~63 : size;
+}
+
+static void checkConcatenation(const Bits& a, const Bits& b, unsigned int iteration)
+{
+    const BitString A = toBitString(a), B = toBitString(b);
+    const Bits ab = concatenate(a, b);
+
+    check(A || B, ab, "operator||", iteration);
+    check(BitString(A) || B, ab, "operator|| on an rvalue", iteration);
+    BitString C(A);
+    C.append(B);
+    check(C, ab, "append(BitString)", iteration);
+    for(unsigned int i=0; i<b.size(); i++)
+        C = move(C) || (unsigned int)b[i];
+    check(C, concatenate(ab, b), "append(bit)", iteration);
+
+    // Appending from any source index, so that both, either or none of source and destination are word-aligned
+    unsigned int index = b.empty() ? 0 : rand() % b.size();
+    unsigned int size = rand() % (b.size() - index + 1);
+    BitString D(A);
+    D.append(BitStringView(B, index, size));
+    check(D, concatenate(a, Bits(b.begin() + index, b.begin() + index + size)), "append(BitStringView)", iteration);
+}
+
+static void checkOverwrite(const Bits& a, const Bits& b, unsigned int iteration)
+{
+    const BitString A = toBitString(a), B = toBitString(b);
+
+    // Inside A if it fits, or extending A otherwise
+    unsigned int index = rand() % (a.size() + 70);
+    Bits expected(a);
+    if (index + b.size() > expected.size())
+        expected.resize(index + b.size(), 0);
+    for(unsigned int i=0; i<b.size(); i++)
+        expected[index + i] = b[i];
+    BitString C(A);
+    C.overwrite(B, index);
+    check(C, expected, "overwrite", iteration);
+}
+
+static void checkSubstringTruncateXor(const Bits& a, unsigned int iteration)
+{
+    const BitString A = toBitString(a);
+
+    unsigned int index = a.empty() ? 0 : rand() % a.size();
+    unsigned int size = rand() % (a.size() + 10);
+    unsigned int end = (index + size < a.size()) ? index + size : (unsigned int)a.size();
+    const Bits sub(a.begin() + index, a.begin() + end);
+    check(BitString::substring(A, index, size), sub, "substring", iteration);
+    check(BitString(BitStringView(A).substring(index, end - index)), sub, "BitStringView::substring", iteration);
+
+    unsigned int length = rand() % (a.size() + 1);
+    BitString T(A);
+    T.truncate(length);
+    check(T, Bits(a.begin(), a.begin() + length), "truncate", iteration);
+
+    const Bits b = randomBits((unsigned int)a.size());
+    const BitString B = toBitString(b);
+    Bits x(a.size());
+    for(unsigned int i=0; i<a.size(); i++)
+        x[i] = a[i] ^ b[i];
+    check(A ^ B, x, "operator^", iteration);
+    check(BitString(A) ^ BitString(B), x, "operator^ on rvalues", iteration);
+    BitString X(A);
+    X ^= B;
+    check(X, x, "operator^=", iteration);
+    if (!(X == toBitString(x)) || (!a.empty() && (X == A) != (x == a)))
+        throw Exception("BitString: operator== does not match the model.");
+}
+
+static void checkMoves(const Bits& a, unsigned int iteration)
+{
+    BitString A = toBitString(a);
+    BitString M(move(A));
+    check(M, a, "move constructor", iteration);
+    check(A, Bits(), "moved-from string", iteration);
+    BitString N(toBitString(randomBits(rand() % 3000)));
+    N = move(M);
+    check(N, a, "move assignment", iteration);
+    N = toBitString(a);
+    check(N, a, "move assignment from a temporary", iteration);
+}
+
+static void checkPadding(unsigned int iteration)
+{
+    unsigned int r = 2 + rand() % 1600;
+    unsigned int length = rand() % 3000;
+
+    BitString P = BitString::pad10(r, length);
+    Bits p(P.size(), 0);
+    p[0] = 1;
+    if (((length + P.size()) % r != 0) || (P.size() > r))
+        throw Exception("BitString: pad10 does not reach a multiple of r.");
+    check(P, p, "pad10", iteration);
+
+    BitString Q = BitString::pad101(r, length);
+    Bits q(Q.size(), 0);
+    q[0] = 1;
+    q.back() = 1;
+    if (((length + Q.size()) % r != 0) || (Q.size() < 2) || (Q.size() > r + 1))
+        throw Exception("BitString: pad101 does not reach a multiple of r.");
+    check(Q, q, "pad101", iteration);
+}
+
+static void checkViews(const Bits& a, unsigned int iteration)
+{
+    BitString A = toBitString(a);
+
+    // Views and blocks at any bit offset, including offsets that are not multiples of 8
+    unsigned int index = a.empty() ? 0 : rand() % a.size();
+    unsigned int size = rand() % (a.size() - index + 1);
+    const Bits sub(a.begin() + index, a.begin() + index + size);
+    BitStringView V(A, index, size);
+    check(BitString(V), sub, "BitStringView", iteration);
+    if (!(V == BitStringView(toBitString(sub))))
+        throw Exception("BitString: operator== on views does not match the model.");
+    unsigned int r = 1 + rand() % 100;
+    const Blocks blocks(A, r);
+    unsigned int i = a.empty() ? 0 : rand() % blocks.size();
+    unsigned int end = ((i + 1)*r < a.size()) ? (i + 1)*r : (unsigned int)a.size();
+    const Bits block(a.begin() + i*r, a.begin() + end);
+    check(BitString(blocks[i]), block, "Block", iteration);
+    check(BitString(blocks[i].view()), block, "Block::view", iteration);
+
+    // A view does not copy the bits, so it reads the changes made to its BitString in place
+    if (size > 0) {
+        const BitString flip(1 - a[index]);
+        A.overwrite(flip, index);
+        Bits modified(sub);
+        modified[0] = 1 - modified[0];
+        check(BitString(V), modified, "BitStringView after modifying its BitString", iteration);
+    }
+}
+
+static void checkBlocks()
+{
+    const Bits a = randomBits(203);
+    const Bits zeroes(13, 0);
+
+    // Assigning a block of a modifiable BitString modifies it in place
+    BitString S = toBitString(a);
+    Blocks blocks(S, 13);
+    BitStringView V(S, 13, 13);
+    blocks[1] = toBitString(zeroes);
+    Bits expected(a);
+    for(unsigned int i=13; i<26; i++)
+        expected[i] = 0;
+    check(S, expected, "assignment to a Block", 0);
+    check(BitString(V), zeroes, "BitStringView after assigning a Block", 0);
+
+    // Blocks on a const BitString copy it on the first assignment, and bits() then returns the copy
+    const BitString C = toBitString(a);
+    Blocks copyOnWrite(C, 13);
+    check(copyOnWrite.bits(), a, "Blocks::bits() before assignment", 0);
+    copyOnWrite[1] = toBitString(zeroes);
+    check(C, a, "const BitString after assigning a Block", 0);
+    check(copyOnWrite.bits(), expected, "Blocks::bits() after assignment", 0);
+    check(BitString(copyOnWrite[1]), zeroes, "Block after copy-on-write", 0);
+    copyOnWrite[2] = toBitString(zeroes);
+    for(unsigned int i=26; i<39; i++)
+        expected[i] = 0;
+    check(copyOnWrite.bits(), expected, "Blocks::bits() after a second assignment", 0);
+    check(C, a, "const BitString after a second assignment", 0);
+
+    // A Block built directly on a const BitString cannot be assigned
+    Block B(C, 13, 13);
+    bool thrown = false;
+    try {
+        B = toBitString(zeroes);
+    }
+    catch(Exception&) {
+        thrown = true;
+    }
+    if (!thrown)
+        throw Exception("BitString: assigning a Block on a const BitString does not throw.");
+    check(C, a, "const BitString after assigning a const Block", 0);
+}
+
+void testBitString()
+{
+    srand(0);
+    for(unsigned int iteration=0; iteration<2000; iteration++) {
+        const Bits a = randomBits(randomSize(iteration));
+        const Bits b = randomBits(randomSize(iteration/2));
+        check(toBitString(a), a, "construction", iteration);
+        checkConcatenation(a, b, iteration);
+        checkOverwrite(a, b, iteration);
+        checkSubstringTruncateXor(a, iteration);
+        checkMoves(a, iteration);
+        checkPadding(iteration);
+        checkViews(a, iteration);
+    }
+    checkBlocks();
+    cout << "BitString: OK" << endl;
+}
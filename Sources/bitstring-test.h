@@ -0,0 +1,28 @@
+/*
+ * KeccakTools
+ *
+ * The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+ * Michaël Peeters and Gilles Van Assche. For more information, feedback or
+ * questions, please refer to our website: http://keccak.noekeon.org/
+ *
+ * Implementation by the designers,
+ * hereby denoted as "the implementer".
+ *
+ * To the extent possible under law, the implementer has waived all copyright
+ * and related or neighboring rights to the source code in this file.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+#ifndef _BITSTRINGTEST_H_
+#define _BITSTRINGTEST_H_
+
+/**
+  * Function that checks BitString against a bit-per-element model:
+  * concatenation at all word alignments of source and destination,
+  * overwrite, substring, xor, truncate, moves and padding,
+  * views and blocks at any bit offset, and copy-on-write of Blocks.
+  * It throws an Exception in case of mismatch.
+  */
+void testBitString();
+
+#endif
@@ -14,13 +14,19 @@
  * http://creativecommons.org/publicdomain/zero/1.0/
  */
 
+#include <cstring>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 #include "bitstring.h"
 
 using namespace std;
 
+#if defined(__BYTE_ORDER__) && (__BYTE_ORDER__ == __ORDER_BIG_ENDIAN__)
+#error "BitString stores its bytes in 64-bit words and array() assumes a little-endian platform."
+#endif
+
 static UINT8 enc8(unsigned int x)
 {
     if (x > 255) {
@@ -32,23 +38,22 @@ static UINT8 enc8(unsigned int x)
         return UINT8(x);
 }
 
-static void Farfalle_assert(bool condition, const string &synopsis, const char *fct)
+static void Farfalle_fail(const char *synopsis, const char *fct)
 {
-    if ( !condition ) {
-        throw Exception(string(fct) + "(): " + synopsis);
-    }
+    throw Exception(string(fct) + "(): " + synopsis);
 }
 
+// The synopsis is only turned into a string on failure, as the checks are on the path of every operator
 #if defined(__GNUC__)
-#define assert(cond, msg)  Farfalle_assert(cond, msg, __PRETTY_FUNCTION__)
+#define assert(cond, msg)  do { if ( !(cond)) Farfalle_fail(msg, __PRETTY_FUNCTION__); } while ( 0 )
 #else
-#define assert(cond, msg)  Farfalle_assert(cond, msg, __FUNCTION__)
+#define assert(cond, msg)  do { if ( !(cond)) Farfalle_fail(msg, __FUNCTION__); } while ( 0 )
 #endif
 
-void BitString::truncateLastByte(void)
+void BitString::truncateLastWord(void)
 {
-    if ( vSize % 8 ) {
-        v[vSize / 8] &= (1 << (vSize % 8)) - 1;                      // zeroize exceeding bits (for operator==())
+    if ( vSize % 64 ) {
+        w[vSize / 64] &= (1ULL << (vSize % 64)) - 1;                 // zeroize exceeding bits (for operator==() and append())
     }
 }
 
@@ -59,83 +64,252 @@ void BitString::syncAlias(void)
     }
 }
 
+void BitString::reserve(unsigned int words)
+{
+    if ( words <= capacity ) {
+        return;
+    }
+    unsigned int  newCapacity = (words > 2 * capacity) ? words : 2 * capacity;
+    UINT64 *      newW        = new UINT64[newCapacity];
+    memcpy(newW, w, nrWords(vSize) * sizeof(UINT64));
+    if ( w != local ) {
+        delete[] w;
+    }
+    w        = newW;
+    capacity = newCapacity;
+}
+
+void BitString::resize(unsigned int size)
+{
+    unsigned int  oldWords = nrWords(vSize);
+    unsigned int  newWords = nrWords(size);
+
+    if ( newWords > oldWords ) {
+        reserve(newWords);
+        memset(w + oldWords, 0, (newWords - oldWords) * sizeof(UINT64));
+    }
+    vSize = size;
+    truncateLastWord();
+}
+
+void BitString::assign(const UINT8 *s, unsigned int size)
+{
+    reserve(nrWords(size));
+    vSize = size;
+    if ( size > 0 ) {
+        w[nrWords(size) - 1] = 0;
+        memcpy(w, s, (size + 7) / 8);
+    }
+    truncateLastWord();
+}
+
+void BitString::steal(BitString &S)
+{
+    // Does not allocate, except when both strings are aliased (the source then keeps its words)
+    if ( S.alias ) {
+        if ( alias ) {
+            reserve(nrWords(S.vSize));
+            memcpy(w, S.w, nrWords(S.vSize) * sizeof(UINT64));
+            vSize = S.vSize;
+            return;
+        }
+        alias   = S.alias;                                           // The string now follows this BitString
+        S.alias = NULL;
+    }
+    if ( S.w == S.local ) {                                          // Inline words always fit in w
+        memcpy(w, S.w, nrWords(S.vSize) * sizeof(UINT64));
+        vSize   = S.vSize;
+        S.vSize = 0;
+    }
+    else {
+        if ( w != local ) {
+            delete[] w;
+        }
+        w          = S.w;
+        capacity   = S.capacity;
+        vSize      = S.vSize;
+        S.w        = S.local;
+        S.capacity = inlineWords;
+        S.vSize    = 0;
+    }
+}
+
+UINT64 BitString::getWord(unsigned int index) const
+{
+    // Returns the 64 bits starting at bit index, with zeroes beyond the end of the string
+    unsigned int  i     = index / 64;
+    unsigned int  shift = index % 64;
+    unsigned int  n     = nrWords(vSize);
+    UINT64        x     = (i < n) ? (w[i] >> shift) : 0;
+
+    if ( shift && (i + 1 < n)) {
+        x |= w[i + 1] << (64 - shift);
+    }
+    return x;
+}
+
+void BitString::append(const BitString &S, unsigned int index, unsigned int size)
+{
+    if ( &S == this ) {
+        BitString  copy(S);
+        append(copy, index, size);
+        return;
+    }
+
+    unsigned int  offset = vSize;
+    resize(vSize + size);
+    if ( size == 0 ) {
+        return;
+    }
+
+    unsigned int   shift       = offset % 64;                        // bit position of the first bit in its destination word
+    unsigned int   sourceShift = index % 64;                         // bit position of the first bit in its source word
+    unsigned int   n           = nrWords(size);                      // number of 64-bit words to append
+    UINT64         lastMask    = (size % 64) ? (1ULL << (size % 64)) - 1 : ~0ULL;
+    UINT64 *       d           = w + offset / 64;
+    const UINT64 * s           = S.w + index / 64;
+
+    if ( (shift == 0) && (sourceShift == 0)) {
+        // Both aligned: copy whole words
+        memcpy(d, s, n * sizeof(UINT64));
+        truncateLastWord();
+    }
+    else if ( sourceShift == 0 ) {
+        // Shift-merge each source word into the two destination words it overlaps -- bits beyond offset are zero
+        for ( unsigned int j = 0; j + 1 < n; ++j ) {
+            d[j]     |= s[j] << shift;
+            d[j + 1]  = s[j] >> (64 - shift);
+        }
+        UINT64  x = s[n - 1] & lastMask;
+        d[n - 1] |= x << shift;
+        if ( shift + ((size - 1) % 64) + 1 > 64 ) {
+            d[n] = x >> (64 - shift);
+        }
+    }
+    else if ( shift == 0 ) {
+        // Gather each destination word from the two source words it overlaps
+        for ( unsigned int j = 0; j + 1 < n; ++j ) {
+            d[j] = (s[j] >> sourceShift) | (s[j + 1] << (64 - sourceShift));
+        }
+        d[n - 1] = S.getWord(index + (n - 1) * 64) & lastMask;
+    }
+    else {
+        for ( unsigned int k = 0; k < size; k += 64 ) {
+            unsigned int  length = (size - k < 64) ? size - k : 64;
+            UINT64        x      = S.getWord(index + k) & ((length < 64) ? (1ULL << length) - 1 : ~0ULL);
+            unsigned int  i      = k / 64;
+            d[i] |= x << shift;
+            if ( shift + length > 64 ) {
+                d[i + 1] |= x >> (64 - shift);
+            }
+        }
+    }
+}
+
 BitString::BitString()
-    : vSize(0), v(), alias(NULL)
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
 {}
 
 BitString::~BitString()
 {
     syncAlias();                                                     // Our last hope if BitString was modified via array()
+    if ( w != local ) {
+        delete[] w;
+    }
 }
 
 BitString::BitString(unsigned int bit)
-    : vSize(1), v(1, bit), alias(NULL)
+    : vSize(1), capacity(inlineWords), w(local), alias(NULL)
 {
     assert((0 == bit) || (1 == bit), "bit must be 0 or 1.");
+    w[0] = bit;
 }
 
 BitString::BitString(unsigned int size, UINT8 byte)
-    : vSize(size), v((size + 7) / 8, byte), alias(NULL)
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
 {
-    truncateLastByte();
+    reserve(nrWords(size));
+    vSize = size;
+    memset(w, byte, nrWords(size) * sizeof(UINT64));
+    truncateLastWord();
 }
 
 BitString::BitString(string &s)
-    : vSize(s.size() * 8), v(), alias(&s)
+    : vSize(0), capacity(inlineWords), w(local), alias(&s)
 {
-    v.assign(s.c_str(), s.c_str() + s.size());
+    assign((const UINT8 *)s.data(), s.size() * 8);
 }
 
 BitString::BitString(const string &s)
-    : vSize(s.size() * 8), v(), alias(NULL)
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
 {
-    v.assign(s.c_str(), s.c_str() + s.size());
+    assign((const UINT8 *)s.data(), s.size() * 8);
 }
 
 BitString::BitString(const string &s, unsigned int index, unsigned int size)
-    : vSize((index >= s.size() * 8) ? 0 : (size + index <= s.size() * 8) ? size : s.size() * 8 - index),
-    v(s.begin() + index / 8, s.begin() + index / 8 + ((vSize) + 7) / 8), // vSize must be initialized first! (better enable -Wreorder)
-    alias(NULL)
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
 {
     assert((index % 8) == 0, "This implementation only supports index that are multiple of 8.");
-    truncateLastByte();
+    if ( index < s.size() * 8 ) {
+        assign((const UINT8 *)s.data() + index / 8, (size + index <= s.size() * 8) ? size : s.size() * 8 - index);
+    }
 }
 
 BitString::BitString(const BitString &S)
-    : vSize(S.vSize), v(S.v), alias(NULL)                            // We don't copy the alias
-{}
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)          // We don't copy the alias
+{
+    reserve(nrWords(S.vSize));
+    memcpy(w, S.w, nrWords(S.vSize) * sizeof(UINT64));
+    vSize = S.vSize;
+}
+
+BitString::BitString(BitString &&S) noexcept
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)          // Takes over the alias of S, if any
+{
+    steal(S);
+}
 
 BitString::BitString(const BitString &S, unsigned int index, unsigned int size)
-    : vSize((index >= S.vSize) ? 0 : (size + index <= S.vSize) ? size : S.vSize - index),
-    v(S.v.begin() + index / 8, S.v.begin() + index / 8 + ((vSize) + 7) / 8),
-    alias(NULL)
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
 {
-    assert((index % 8) == 0, "This implementation only supports index that are multiple of 8.");
-    truncateLastByte();
+    if ( index < S.vSize ) {
+        append(S, index, (size + index <= S.vSize) ? size : S.vSize - index);
+    }
 }
 
 BitString::BitString(const vector<UINT8> &v)
-    : vSize(v.size() * 8), v(v), alias(NULL)
-{}
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
+{
+    assign(v.empty() ? NULL : &v[0], v.size() * 8);
+}
 
 BitString::BitString(const UINT8 *s, unsigned int size)
-    : vSize(size), v(s, s + (size + 7) / 8), alias(NULL)
-{}
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
+{
+    assign(s, size);
+}
+
+BitString::BitString(const BitStringView &V)
+    : vSize(0), capacity(inlineWords), w(local), alias(NULL)
+{
+    append(*V.S, V.index, V.vSize);
+}
 
 string BitString::str() const
 {
-    return string(v.begin(), v.end());
+    const char *s = (const char *)w;
+    return string(s, s + (vSize + 7) / 8);
 }
 
 UINT8 *BitString::array()
 {
     assert((vSize % 8) == 0, "Can't get array if BitString length is not a multiple of 8."); // Because caller may modify the array and break the invariant
-    return &v[0];
+    return (UINT8 *)w;
 }
 
 const UINT8 *BitString::array() const
 {
-    return &v[0];
+    return (const UINT8 *)w;
 }
 
 unsigned int BitString::size() const
@@ -154,21 +328,24 @@ BitString BitString::keypack(const BitString &K, unsigned int size)
 
 BitString BitString::substring(const BitString &K, unsigned int index, unsigned int size)
 {
-    unsigned int prependLength = (8 - index % 8) % 8;
-    BitString K2 = BitString::zeroes(prependLength) || K;
-    return BitString(K2, prependLength + index, size);
+    return BitString(BitStringView(K).substring(index, size));
 }
 
 BitString BitString::pad10(unsigned int r, unsigned int Mlen)
 {
     assert(0 < r, "r must be positive.");
-    return BitString(1) || BitString::zeroes(r - 1 - (Mlen % r));
+    BitString  Z = BitString::zeroes(r - (Mlen % r));
+    Z.w[0] |= 1;
+    return Z;
 }
 
 BitString BitString::pad101(unsigned int r, unsigned int Mlen)
 {
     assert(0 < r, "r must be positive.");
-    return BitString(1) || BitString::zeroes((2 * r - 2 - (Mlen % r)) % r) || BitString(1);
+    BitString  Z = BitString::zeroes((2 * r - 2 - (Mlen % r)) % r + 2);
+    Z.w[0] |= 1;
+    Z.w[(Z.vSize - 1) / 64] |= 1ULL << ((Z.vSize - 1) % 64);
+    return Z;
 }
 
 BitString BitString::zeroes(unsigned int size)
@@ -186,31 +363,32 @@ BitString &BitString::truncate(unsigned int size)
     if ( size > vSize ) {
         return *this;
     }
-    vSize = size;
-    v.resize((vSize + 7) / 8);
-    truncateLastByte();
+    resize(size);
     syncAlias();
     return *this;
 }
 
 BitString &BitString::overwrite(const BitString &S, unsigned int index)
 {
-    assert((index % 8) == 0, "This implementation only supports index that are multiple of 8.");
+    if ( &S == this ) {
+        return overwrite(BitString(S), index);
+    }
 
     if ( index + S.vSize > vSize ) {
-        vSize = index + S.vSize;
-        v.resize((vSize + 7) / 8);
+        resize(index + S.vSize);
     }
 
-    // Copy all complete bytes, i.e. (S.vSize/8) bytes, leaving (S.vSize%8)<8 bits left
-    copy(S.v.begin(), S.v.begin() + (S.vSize / 8), v.begin() + (index / 8));
-
-    // Copy the (S.vSize%8) remaining bits
-    if ( S.vSize % 8 ) {
-        UINT8  mask = (1 << (S.vSize % 8)) - 1;
-        UINT8  src  = S.v[S.vSize / 8];
-        UINT8 &dst  = v[(index / 8) + (S.vSize / 8)];
-        dst = (dst & ~mask) | (src & mask);
+    // Write each 64-bit word of S over the two destination words it overlaps, keeping the bits around
+    unsigned int  shift = index % 64;
+    for ( unsigned int k = 0; k < S.vSize; k += 64 ) {
+        unsigned int  length = (S.vSize - k < 64) ? S.vSize - k : 64;
+        UINT64        mask   = (length < 64) ? (1ULL << length) - 1 : ~0ULL;
+        UINT64        x      = S.w[k / 64] & mask;
+        unsigned int  i      = (index + k) / 64;
+        w[i] = (w[i] & ~(mask << shift)) | (x << shift);
+        if ( shift && (shift + length > 64)) {
+            w[i + 1] = (w[i + 1] & ~(mask >> (64 - shift))) | (x >> (64 - shift));
+        }
     }
 
     syncAlias();
@@ -218,85 +396,134 @@ BitString &BitString::overwrite(const BitString &S, unsigned int index)
     return *this;
 }
 
+BitString &BitString::append(unsigned int bit)
+{
+    assert((0 == bit) || (1 == bit), "bit must be 0 or 1.");
+
+    resize(vSize + 1);
+    w[(vSize - 1) / 64] |= (UINT64)bit << ((vSize - 1) % 64);
+    syncAlias();
+
+    return *this;
+}
+
+BitString &BitString::append(const BitString &S)
+{
+    append(S, 0, S.vSize);
+    syncAlias();
+
+    return *this;
+}
+
+BitString &BitString::append(const BitStringView &V)
+{
+    append(*V.S, V.index, V.vSize);
+    syncAlias();
+
+    return *this;
+}
+
 BitString &BitString::operator=(const BitString &A)
 {
     if ( this != &A ) {
+        reserve(nrWords(A.vSize));
+        memcpy(w, A.w, nrWords(A.vSize) * sizeof(UINT64));
         vSize = A.vSize;
-        v     = A.v;
     }
     syncAlias();
     return *this;
 }
 
-bool operator==(const BitString &A, const BitString &B)
+BitString &BitString::operator=(BitString &&A) noexcept
 {
-    return (A.vSize == B.vSize) && (A.v == B.v);
+    if ( this != &A ) {
+        steal(A);
+    }
+    syncAlias();
+    return *this;
 }
 
-BitString operator||(const BitString &A, unsigned int bit)
+BitString &BitString::operator^=(const BitString &A)
 {
-    assert((0 == bit) || (1 == bit), "bit must be 0 or 1.");
+    assert(vSize == A.vSize, "Cannot xor two BitString of different size.");
 
-    BitString  Z(A);
-    Z.v.resize((Z.vSize + 8) / 8);
-    Z.v[Z.vSize / 8] |= bit << (Z.vSize % 8);
-    Z.vSize++;
+    for ( unsigned int i = 0; i < nrWords(vSize); ++i ) {
+        w[i] ^= A.w[i];
+    }
+    syncAlias();
 
-    return Z;
+    return *this;
 }
 
-BitString operator||(const BitString &A, const BitString &B)
+bool operator==(const BitString &A, const BitString &B)
 {
-    // Allocate C
-    BitString  C(A.vSize + B.vSize, 0);
+    return (A.vSize == B.vSize) && (memcmp(A.w, B.w, BitString::nrWords(A.vSize) * sizeof(UINT64)) == 0);
+}
 
-    // Copy A into C
-    copy(A.v.begin(), A.v.end(), C.v.begin());
+BitString operator||(const BitString &A, unsigned int bit)
+{
+    BitString  Z(A);
+    Z.append(bit);
+    return Z;
+}
 
-    // Append B to C, starting from index A.vSize -- do it fast if possible, possibly with overflow
-    if ((A.vSize % 8) == 0 ) {
-        C.overwrite(B, A.vSize);
-    }
-    else {
-        // There are (A.vSize%8) bits in last byte -- append with shift -- TODO: fast copy with 32-bit
-        vector<UINT8>::iterator  c     = C.v.begin() + (A.vSize / 8);
-        unsigned int             nbits = (A.vSize % 8);
-        UINT8                    last  = *c & ((1 << (nbits)) - 1);  // last = -----xxx
-
-        for ( vector<UINT8>::const_iterator b = B.v.begin(); b != B.v.end();) {
-            *(c++) = last | (*b << nbits);                           // *c   = -----xxx | xxxxx---
-            last   = *(b++) >> (8 - nbits);                          // last = -----xxx
-        }
+BitString operator||(BitString &&A, unsigned int bit)
+{
+    A.append(bit);
+    return std::move(A);
+}
 
-        if ( c != C.v.end()) {
-            *(c++) = last;
-        }
-    }
+BitString operator||(const BitString &A, const BitString &B)
+{
+    BitString  C;
+    C.reserve(BitString::nrWords(A.vSize + B.vSize));
+    C.append(A);
+    C.append(B);
 
     return C;
 }
 
+BitString operator||(BitString &&A, const BitString &B)
+{
+    A.append(B);
+    return std::move(A);
+}
+
 BitString operator^(const BitString &A, const BitString &B)
 {
-    assert(A.vSize == B.vSize, "Cannot xor two BitString of different size.");
+    BitString  Z(A);
+    Z ^= B;
+    return Z;
+}
 
-    BitString                Z(A.vSize, (UINT8)0);
-    vector<UINT8>::iterator  z = Z.v.begin();
-    for ( vector<UINT8>::const_iterator a = A.v.begin(), b = B.v.begin(); a != A.v.end(); ++a, ++b, ++z ) {
-        *z = *a ^ *b;
-    }
+BitString operator^(BitString &&A, const BitString &B)
+{
+    A ^= B;
+    return std::move(A);
+}
 
-    return Z;
+BitString operator^(const BitString &A, BitString &&B)
+{
+    B ^= A;
+    return std::move(B);
+}
+
+BitString operator^(BitString &&A, BitString &&B)
+{
+    A ^= B;
+    return std::move(A);
 }
 
 ostream &operator<<(ostream &os, const BitString &S)
 {
-    for ( vector<UINT8>::const_iterator i = S.v.begin(); i != S.v.end();) {
+    const UINT8 *  bytes   = S.array();
+    unsigned int   nrBytes = (S.vSize + 7) / 8;
+    for ( unsigned int i = 0; i < nrBytes;) {
         os.width(2);
         os.fill('0');
-        os << hex << ((int)UINT8(*i));
+        os << hex << ((int)bytes[i]);
         ++i;
-        if ( i != S.v.end()) {
+        if ( i != nrBytes ) {
             os << " ";
         }
         else {
@@ -306,6 +533,53 @@ ostream &operator<<(ostream &os, const BitString &S)
     return os;
 }
 
+static BitString  dummy; // Not nice but nobody will notice
+
+BitStringView::BitStringView()
+    : S(&dummy), index(0), vSize(0)
+{}
+
+BitStringView::BitStringView(const BitString &S)
+    : S(&S), index(0), vSize(S.size())
+{}
+
+BitStringView::BitStringView(const BitString &S, unsigned int index, unsigned int size)
+    : S(&S), index((index >= S.size()) ? S.size() : index), vSize((index >= S.size()) ? 0 : (size + index <= S.size()) ? size : S.size() - index)
+{}
+
+unsigned int BitStringView::size() const
+{
+    return vSize;
+}
+
+const UINT8 *BitStringView::array() const
+{
+    assert((index % 8) == 0, "Can't get array if the view does not start at a multiple of 8.");
+    return S->array() + index / 8;
+}
+
+BitStringView BitStringView::substring(unsigned int index, unsigned int size) const
+{
+    BitStringView  V(*this);
+    V.index = this->index + ((index >= vSize) ? vSize : index);
+    V.vSize = (index >= vSize) ? 0 : (size + index <= vSize) ? size : vSize - index;
+    return V;
+}
+
+bool operator==(const BitStringView &A, const BitStringView &B)
+{
+    if ( A.vSize != B.vSize ) {
+        return false;
+    }
+    for ( unsigned int k = 0; k < A.vSize; k += 64 ) {
+        UINT64  mask = (A.vSize - k < 64) ? (1ULL << (A.vSize - k)) - 1 : ~0ULL;
+        if ( ((A.S->getWord(A.index + k) ^ B.S->getWord(B.index + k)) & mask) != 0 ) {
+            return false;
+        }
+    }
+    return true;
+}
+
 BitStrings::BitStrings()
 {
 }
@@ -350,37 +624,52 @@ BitStrings operator*(const BitString &A, const BitString &B)
 }
 
 Block::Block(BitString &S, unsigned int index, unsigned int r)
-    : B(S), alias(S), index(index), r(r)
+    : B(&S), alias(&S), owner(NULL), index(index), r(r)
 {
     assert(0 < r,             "r must be positive.");
     assert(index <= S.size(), "index must be less than or equal to bit string size.");
 }
 
-static BitString  dummy; // Not nice but nobody will notice
-
 Block::Block(const BitString &S, unsigned int index, unsigned int r)
-    : B(dummy), alias(S), index(index), r(r)
+    : B(NULL), alias(&S), owner(NULL), index(index), r(r)
 {
     assert(0 < r,             "r must be positive.");
     assert(index <= S.size(), "index must be less than or equal to bit string size.");
 }
 
+Block::Block(Blocks &owner, unsigned int index, unsigned int r)
+    : B(owner.target), alias(owner.source), owner(&owner), index(index), r(r)
+{
+    assert(0 < r,                         "r must be positive.");
+    assert(index <= owner.source->size(), "index must be less than or equal to bit string size.");
+}
+
 Block &Block::operator=(const BitString &S)
 {
     assert(S.size() <= r, "String size must be less than or equal to block size.");
-    B.overwrite(S, index);
+    if ( !B && owner ) {
+        B     = &owner->mutableBits();
+        alias = B;
+    }
+    assert(B != NULL, "Block is not mutable.");
+    B->overwrite(S, index);
 
     return *this;
 }
 
 Block::operator BitString() const
 {
-    return BitString(alias, index, r);
+    return BitString(view());
+}
+
+BitStringView Block::view() const
+{
+    return BitStringView(*alias, index, r);
 }
 
 unsigned int Block::size() const
 {
-    return alias.size() < (r + index) ? alias.size() - index : r;
+    return alias->size() < (r + index) ? alias->size() - index : r;
 }
 
 ostream &operator<<(ostream &os, const Block &B)
@@ -389,35 +678,45 @@ ostream &operator<<(ostream &os, const Block &B)
 }
 
 Blocks::Blocks(unsigned int r)
-    : alias(B), const_alias(B), r(r)
+    : target(&B), source(&B), r(r)
 {}
 
 Blocks::Blocks(BitString &S, unsigned int r)
-    : B(S), alias(S), const_alias(S), r(r)
+    : target(&S), source(&S), r(r)
 {}
 
 Blocks::Blocks(const BitString &S, unsigned int r)
-    : B(S), alias(B), const_alias(S), r(r)                           // B(S) done to allow using non-const operator[]
+    : target(NULL), source(&S), r(r)
 {}
 
+BitString &Blocks::mutableBits()
+{
+    if ( !target ) {
+        B      = *source;
+        target = &B;
+        source = &B;
+    }
+    return *target;
+}
+
 unsigned int Blocks::size() const
 {
-    return const_alias.size() > 0 ? (const_alias.size() + r - 1) / r : 1;
+    return source->size() > 0 ? (source->size() + r - 1) / r : 1;
 }
 
 BitString Blocks::bits() const
 {
-    return const_alias;
+    return *source;
 }
 
 Block Blocks::operator[](unsigned int i)
 {
-    return Block(alias, i * r, r);
+    return Block(*this, i * r, r);
 }
 
 Block Blocks::operator[](unsigned int i) const
 {
-    return Block(const_alias, i * r, r);
+    return Block(*source, i * r, r);
 }
 
 ostream &operator<<(ostream &os, const Blocks &B)
@@ -22,16 +22,33 @@
 
 using namespace std;
 
+class BitStringView;
+
 /**
- * Class implementing a simple bit string
+ * Class implementing a simple bit string.
+ * The bits are stored in 64-bit words, bit i being bit (i%64) of word i/64,
+ * so that array() gives the bytes of the string on a little-endian platform.
+ * Strings of up to 1600 bits are stored inline, without memory allocation.
+ * Moving a BitString does not allocate; a string bound with BitString(string &)
+ * follows the BitString it is moved to, unless the latter is itself bound to a string.
  */
 class BitString {
 protected:
-    unsigned int   vSize;                                            // size in bits -- invariant: v.size() == (vSize+7)/8
-    vector<UINT8>  v;                                                // vector storing bytes -- invariant: if (vSize%8), then (v[vSize/8] >> (vSize%8)) == 0
+    static const unsigned int inlineWords = 25;                      // number of words stored inline, i.e., 1600 bits
+    unsigned int   vSize;                                            // size in bits -- invariant: the bits of w[0 .. (vSize+63)/64 - 1] from index vSize are zero
+    unsigned int   capacity;                                         // number of words available in w
+    UINT64 *       w;                                                // points to local or to allocated words
+    UINT64         local[inlineWords];
     string *       alias;
-    void  truncateLastByte(void);
+    static unsigned int  nrWords(unsigned int size) { return (size + 63) / 64; }
+    void  truncateLastWord(void);
     void  syncAlias(void);
+    void  reserve(unsigned int words);
+    void  resize(unsigned int size);
+    void  assign(const UINT8 *s, unsigned int size);
+    void  steal(BitString &S);
+    UINT64  getWord(unsigned int index) const;
+    void  append(const BitString &S, unsigned int index, unsigned int size);
 public:
     BitString();
     ~BitString();
@@ -41,9 +58,11 @@ public:
     BitString(const string &s);
     BitString(const string &s, unsigned int index, unsigned int size);
     BitString(const BitString &S);
+    BitString(BitString &&S) noexcept;                               // The moved-from string is left empty
     BitString(const BitString &S, unsigned int index, unsigned int size);
     BitString(const vector<UINT8> &v);
     BitString(const UINT8 *s, unsigned int size);
+    explicit BitString(const BitStringView &V);                      // Makes an owning copy of the viewed bits
     string            str() const;
     UINT8 *           array();
     const UINT8 *     array() const;
@@ -56,20 +75,55 @@ public:
     static BitString  ones(unsigned int size);
     BitString &       truncate(unsigned int size);
     BitString &       overwrite(const BitString &S, unsigned int index);
+    BitString &       append(unsigned int bit);
+    BitString &       append(const BitString &S);
+    BitString &       append(const BitStringView &V);
     BitString &       operator=(const BitString &A);
+    BitString &       operator=(BitString &&A) noexcept;
+    BitString &       operator^=(const BitString &A);
     friend bool       operator==(const BitString &A, const BitString &B);
     friend BitString  operator||(const BitString &A, unsigned int bit);
     friend BitString  operator||(const BitString &A, const BitString &B);
     friend BitString  operator^(const BitString &A, const BitString &B);
     friend ostream &  operator<<(ostream &os, const BitString &S);
+    friend class      BitStringView;
+    friend bool       operator==(const BitStringView &A, const BitStringView &B);
 };
 
 bool                  operator==(const BitString &A, const BitString &B);
 BitString             operator||(const BitString &A, unsigned int bit);
+BitString             operator||(BitString &&A, unsigned int bit);
 BitString             operator||(const BitString &A, const BitString &B);
+BitString             operator||(BitString &&A, const BitString &B);
 BitString             operator^(const BitString &A, const BitString &B);
+BitString             operator^(BitString &&A, const BitString &B);
+BitString             operator^(const BitString &A, BitString &&B);
+BitString             operator^(BitString &&A, BitString &&B);
 ostream &             operator<<(ostream &os, const BitString &S);
 
+/**
+ * Class implementing a read-only view on a range of bits of a BitString, without copying them.
+ * The viewed BitString must outlive the view and must not be modified while the view is used.
+ * To modify the bits, make an owning copy with BitString(const BitStringView &).
+ */
+class BitStringView {
+protected:
+    const BitString *S;
+    unsigned int     index;                                          // index of the first bit in S
+    unsigned int     vSize;                                          // size in bits -- invariant: index + vSize <= S->size()
+public:
+    BitStringView();
+    BitStringView(const BitString &S);
+    BitStringView(const BitString &S, unsigned int index, unsigned int size);
+    unsigned int      size() const;
+    const UINT8 *     array() const;                                 // Only if the view starts at a multiple of 8; the bits after size() are those of S
+    BitStringView     substring(unsigned int index, unsigned int size) const;
+    friend class      BitString;
+    friend bool       operator==(const BitStringView &A, const BitStringView &B);
+};
+
+bool                  operator==(const BitStringView &A, const BitStringView &B);
+
 /**
  * Class implementing a string of bit strings
  */
@@ -90,43 +144,56 @@ class BitStrings
 
 BitStrings operator*(const BitString &A, const BitString &B);
 
+class Blocks;
+
 /**
  * Class implementing a simple block of bits
  */
 class Block {
 protected:
-    BitString &      B;
-    const BitString &alias;                                          // Block is mutable if &B == &alias
+    BitString *      B;                                              // NULL if Block is not (yet) mutable
+    const BitString *alias;
+    Blocks *         owner;                                          // Blocks to make mutable on the first assignment, if any
     unsigned int     index;
     unsigned int     r;
+    Block(Blocks &owner, unsigned int index, unsigned int r);
 public:
     Block(BitString &S, unsigned int index, unsigned int r);
     Block(const BitString &S, unsigned int index, unsigned int r);
     Block &         operator=(const BitString &S);
     operator BitString() const;
+    BitStringView   view() const;
     unsigned int    size() const;
+    friend class    Blocks;
     friend ostream &operator<<(ostream &os, const Block &B);
 };
 
 ostream &           operator<<(ostream &os, const Block &B);
 
 /**
- * Class implementing a string of bit blocks
+ * Class implementing a string of bit blocks.
+ * Blocks built on a const BitString read it without copying it,
+ * and only make their own copy when a block is first assigned.
+ * bits() returns the bits the blocks read: the const BitString until the first
+ * assignment, and the modified copy afterwards (the const BitString is never modified).
+ * A Block built directly on a const BitString throws an Exception when assigned.
  */
 class Blocks {
 protected:
-    BitString        B;
-    BitString &      alias;
-    const BitString &const_alias;                                    // Block is mutable if &alias == &const_alias
+    BitString        B;                                              // Internal storage, or copy of the const BitString once modified
+    BitString *      target;                                         // String modified by the blocks, NULL while reading a const BitString
+    const BitString *source;                                         // String read by the blocks
     unsigned int     r;
+    BitString &      mutableBits();
 public:
     Blocks(unsigned int r);                                          // Use internal BitString for storage
     Blocks(BitString &S, unsigned int r);                            // Use given BitString for storage
-    Blocks(const BitString &S, unsigned int r);                      // Idem, but not mutable
+    Blocks(const BitString &S, unsigned int r);                      // Idem, but copied on the first assignment
     unsigned int    size() const;
     BitString       bits() const;
     Block           operator[](unsigned int i);
     Block           operator[](unsigned int i) const;
+    friend class    Block;
     friend ostream &operator<<(ostream &os, const Blocks &B);
 };
 
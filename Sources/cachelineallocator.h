@@ -0,0 +1,66 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _CACHELINEALLOCATOR_H_
+#define _CACHELINEALLOCATOR_H_
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#ifdef _WIN32
+#include <malloc.h>
+#endif
+
+/**
+  * Allocator that gives memory aligned on 64 bytes, i.e., on a cache line,
+  * so that a table whose entries are read contiguously spans as few cache
+  * lines as possible, e.g., vector<T, CacheLineAllocator<T> >.
+  */
+template<class T>
+class CacheLineAllocator {
+public:
+    typedef T value_type;
+    CacheLineAllocator() {}
+    template<class U> CacheLineAllocator(const CacheLineAllocator<U>&) {}
+    T *allocate(size_t n)
+    {
+        void *p;
+#ifdef _WIN32
+        p = _aligned_malloc(n*sizeof(T), 64);
+#else
+        if (posix_memalign(&p, 64, n*sizeof(T)) != 0)
+            p = 0;
+#endif
+        if (p == 0)
+            throw std::bad_alloc();
+        return static_cast<T *>(p);
+    }
+    void deallocate(T *p, size_t)
+    {
+#ifdef _WIN32
+        _aligned_free(p);
+#else
+        free(p);
+#endif
+    }
+};
+
+template<class T, class U>
+bool operator==(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return true; }
+
+template<class T, class U>
+bool operator!=(const CacheLineAllocator<T>&, const CacheLineAllocator<U>&) { return false; }
+
+#endif
@@ -21,7 +21,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 using namespace std;
 
 Duplex::Duplex(const Transformation *aF, const PaddingRule *aPad, unsigned int aRate)
-    : f(aF), pad(aPad), rate(aRate)
+    : f(aF), pad(aPad), rate(aRate), queue(aRate)
 {
     unsigned int width = f->getWidth();
     if (rate <= 0)
@@ -38,7 +38,8 @@ Duplex::Duplex(const Transformation *aF, const PaddingRule *aPad, unsigned int a
 }
 
 Duplex::Duplex(const Duplex& other)
-    : f(other.f), pad(other.pad), capacity(other.capacity), rate(other.rate), rho_max(other.rho_max)
+    : f(other.f), pad(other.pad), capacity(other.capacity), rate(other.rate), rho_max(other.rho_max),
+    queue(other.rate)
 {
     unsigned int width = f->getWidth();
     state.reset(new UINT8[(width+7)/8]);
@@ -72,13 +73,13 @@ unsigned int Duplex::getMaximumOutputLength() const
 
 void Duplex::duplexing(const UINT8 *input, unsigned int inputLengthInBits, UINT8 *output, unsigned int desiredOutputLengthInBits)
 {
-    vector<UINT8> outputAsVector;
-    duplexing(input, inputLengthInBits, outputAsVector, desiredOutputLengthInBits);
-    for(unsigned int i=0; i<outputAsVector.size(); i++)
-        output[i] = outputAsVector[i];
+    if (desiredOutputLengthInBits > rate)
+        throw DuplexException("The given output length must be less than or equal to the rate.");
+    processDuplexingInPlace(input, inputLengthInBits, 0x01);
+    extractOutput(output, desiredOutputLengthInBits);
 }
 
-const UINT8* Duplex::processDuplexing(MessageQueue& queue, UINT8 delimitedSigmaEnd)
+const UINT8* Duplex::processDuplexing(UINT8 delimitedSigmaEnd)
 {
     if (delimitedSigmaEnd == 0x00)
         throw DuplexException("delimitedSigmaEnd has an invalid coding.");
@@ -89,19 +90,53 @@ const UINT8* Duplex::processDuplexing(MessageQueue& queue, UINT8 delimitedSigmaE
     queue.pad(*pad);
     if ((queue.blockCount() != 1) || (!queue.firstBlockIsWhole()))
         throw DuplexException("The given input length must be such that it spans exactly one block after padding.");
-    const vector<UINT8>& block = queue.firstBlock();
-    for(vector<UINT8>::size_type i=0; i<block.size(); ++i)
+    const UINT8 *block = queue.firstBlock();
+    for(unsigned int i=0; i<(rate+7)/8; ++i)
         state.get()[i] ^= block[i];
     (*f)(state.get());
     return state.get();
 }
 
+const UINT8* Duplex::processDuplexingInPlace(const UINT8 *sigma, unsigned int sigmaLengthInBits, UINT8 delimitedSigmaEnd)
+{
+    if (delimitedSigmaEnd == 0x00)
+        throw DuplexException("delimitedSigmaEnd has an invalid coding.");
+    unsigned int trailingBits = 0;
+    while((delimitedSigmaEnd >> (trailingBits+1)) != 0)
+        trailingBits++;
+    unsigned int inputLengthInBits = sigmaLengthInBits + trailingBits;
+    if (pad->getPaddedSize(rate, inputLengthInBits) != rate)
+        throw DuplexException("The given input length must be such that it spans exactly one block after padding.");
+    UINT8 *s = state.get();
+    for(unsigned int i=0; i<sigmaLengthInBits/8; i++)
+        s[i] ^= sigma[i];
+    if ((sigmaLengthInBits % 8) != 0)
+        s[sigmaLengthInBits/8] ^= sigma[sigmaLengthInBits/8] & ((1 << (sigmaLengthInBits % 8)) - 1);
+    if (trailingBits > 0) {
+        unsigned int shift = sigmaLengthInBits % 8;
+        unsigned int bits = (unsigned int)(delimitedSigmaEnd & ((1 << trailingBits) - 1)) << shift;
+        s[sigmaLengthInBits/8] ^= (UINT8)bits;
+        if (shift + trailingBits > 8)
+            s[sigmaLengthInBits/8 + 1] ^= (UINT8)(bits >> 8);
+    }
+    pad->xorPaddingIntoBlock(rate, inputLengthInBits, s);
+    (*f)(s);
+    return s;
+}
+
+void Duplex::extractOutput(UINT8 *Z, unsigned int ZLengthInBits) const
+{
+    memcpy(Z, state.get(), ZLengthInBits/8);
+    if ((ZLengthInBits % 8) != 0)
+        Z[ZLengthInBits/8] = state.get()[ZLengthInBits/8] & ((1 << (ZLengthInBits % 8)) - 1);
+}
+
 void Duplex::duplexingBytes(const UINT8 *sigmaBegin, unsigned int sigmaBeginByteLen, UINT8 delimitedSigmaEnd, UINT8 *Z, unsigned int ZByteLen)
 {
-    vector<UINT8> ZAsVector;
-    duplexingBytes(sigmaBegin, sigmaBegin+sigmaBeginByteLen, delimitedSigmaEnd, ZAsVector, ZByteLen);
-    for(unsigned int i=0; i<ZAsVector.size(); i++)
-        Z[i] = ZAsVector[i];
+    if (ZByteLen*8 > rate)
+        throw DuplexException("The given output length must be less than or equal to the rate.");
+    processDuplexingInPlace(sigmaBegin, sigmaBeginByteLen*8, delimitedSigmaEnd);
+    extractOutput(Z, ZByteLen*8);
 }
 
 string Duplex::getDescription() const
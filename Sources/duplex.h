@@ -49,6 +49,9 @@ protected:
     unsigned int rho_max;
     /** The state of the duplex construction. */
     auto_ptr<UINT8> state;
+    /** The queue in which the input of a duplexing call is padded.
+      * It is cleared and reused at each call. */
+    MessageQueue queue;
 public:
     /**
       * The constructor. The transformation, padding rule and rate are given to the
@@ -88,6 +91,9 @@ public:
       *
       * @pre    inputLengthInBits ≤ getMaximumInputLength()
       * @pre    desiredOutputLengthInBits ≤ getMaximumOutputLength()
+      *
+      * This method does not allocate memory: the input is XORed and padded
+      * directly in the state, and the output is copied from the state into @a output.
       */
     void duplexing(const UINT8 *input, unsigned int inputLengthInBits, UINT8 *output, unsigned int desiredOutputLengthInBits);
 
@@ -114,9 +120,9 @@ public:
     template<class InputIterator, class OutputContainer>
     void duplexing(InputIterator inputStart, unsigned int inputLengthInBits, OutputContainer& output, unsigned int desiredOutputLengthInBits)
     {
-        MessageQueue queue(rate);
+        queue.clear();
         queue.append(inputStart, inputLengthInBits);
-        const UINT8* state = processDuplexing(queue);
+        const UINT8* state = processDuplexing();
         outputDuplexing(state, output, desiredOutputLengthInBits);
     }
 
@@ -144,6 +150,9 @@ public:
       * @pre    @a delimitedSigmaEnd ≠ 0x00
       * @pre    @a sigmaBeginByteLen*8+<i>n</i> ≤ getMaximumInputLength()
       * @pre    @a ZByteLen*8 ≤ getMaximumOutputLength()
+      *
+      * Like duplexing(const UINT8*, unsigned int, UINT8*, unsigned int),
+      * this method does not allocate memory.
       */
     void duplexingBytes(const UINT8 *sigmaBegin, unsigned int sigmaBeginByteLen, UINT8 delimitedSigmaEnd, UINT8 *Z, unsigned int ZByteLen);
 
@@ -168,9 +177,9 @@ public:
     template<class InputIterator, class OutputContainer>
     void duplexingBytes(InputIterator sigmaBegin_start, InputIterator sigmaBegin_stop, UINT8 delimitedSigmaEnd, OutputContainer& Z, unsigned int ZByteLen)
     {
-        MessageQueue queue(rate);
+        queue.clear();
         queue.append(sigmaBegin_start, sigmaBegin_stop);
-        const UINT8* state = processDuplexing(queue, delimitedSigmaEnd);
+        const UINT8* state = processDuplexing(delimitedSigmaEnd);
         outputDuplexing(state, Z, ZByteLen*8);
     }
 
@@ -191,9 +200,9 @@ public:
     template<class InputIterator>
     void duplexingBytes(InputIterator sigmaBegin_start, InputIterator sigmaBegin_stop, UINT8 delimitedSigmaEnd)
     {
-        MessageQueue queue(rate);
+        queue.clear();
         queue.append(sigmaBegin_start, sigmaBegin_stop);
-        processDuplexing(queue, delimitedSigmaEnd);
+        processDuplexing(delimitedSigmaEnd);
     }
 
     /**
@@ -221,7 +230,20 @@ protected:
       * This value is such that an input message fits in one block after padding.
       */
     void computeRhoMax();
-    const UINT8* processDuplexing(MessageQueue& queue, UINT8 delimitedSigmaEnd = 0x01);
+    /** Internal method that appends the trailing bits of σ to queue, pads it,
+      * absorbs the resulting block and applies the permutation.
+      * @return A pointer to the state.
+      */
+    const UINT8* processDuplexing(UINT8 delimitedSigmaEnd = 0x01);
+    /** Internal method that XORs σ, given as @a sigmaLengthInBits bits followed by
+      * the trailing bits in @a delimitedSigmaEnd, and its padding directly
+      * into the state, and then applies the permutation.
+      * @return A pointer to the state.
+      */
+    const UINT8* processDuplexingInPlace(const UINT8 *sigma, unsigned int sigmaLengthInBits, UINT8 delimitedSigmaEnd);
+    /** Internal method that copies the first @a ZLengthInBits bits of the state into @a Z.
+      */
+    void extractOutput(UINT8 *Z, unsigned int ZLengthInBits) const;
     template<class OutputContainer>
     void outputDuplexing(const UINT8* state, OutputContainer& output, unsigned int desiredOutputLengthInBits)
     {
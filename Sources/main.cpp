@@ -13,13 +13,20 @@ http://creativecommons.org/publicdomain/zero/1.0/
 
 #include <cstdlib>
 #include <fstream>
+#include <iomanip>
 #include <iostream>
+#include <memory>
 #include <sstream>
 #include <string.h>
+#include "bitstring-test.h"
 #include "duplex.h"
+#include "KangarooTwelve-test.h"
 #include "Keccak.h"
 #include "KeccakCrunchyContest.h"
 #include "Keccak-f25LUT.h"
+#include "Keccak-f-benchmark.h"
+#include "Keccak-f-test.h"
+#include "Keccak-fAutotune.h"
 #include "Keccak-fCodeGen.h"
 #include "Keccak-fDCEquations.h"
 #include "Keccak-fDCLC.h"
@@ -34,6 +41,11 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #include "Kravatte.h"
 #include "Kravatte-test.h"
 #include "KravatteModes-test.h"
+#include "mappedtable-test.h"
+#include "ParallelHash-test.h"
+#include "sponge-benchmark.h"
+#include "sponge-test.h"
+#include "spongestream.h"
 
 using namespace std;
 
@@ -812,12 +824,75 @@ void weightDistributions(unsigned int width)
         fout << "w: " << i << " log: " << log(wattab1[i]/laneSize) / log(2) <<  " n : " << wattab1[i]/laneSize << endl;
 }
 
+/** Function that implements the command-line mode
+  * <code>KeccakTools hash [-r rate] [-c capacity] [-n rounds] [-d digestLength] [file ...]</code>.
+  * For each file, or for the standard input if no file or "-" is given,
+  * it prints the digest in hexadecimal followed by the file name.
+  * The rate, capacity and digest length are in bits and default to
+  * Keccak[r=1088, c=512] with a 256-bit digest. If a number of rounds is given,
+  * ReducedRoundKeccak is used with the last rounds of Keccak-<i>f</i>.
+  * The size and throughput of each file are reported on the standard error.
+  */
+int hashFiles(int argc, char *argv[])
+{
+    unsigned int rate = 1088, capacity = 512, nrRounds = 0, digestLength = 256;
+    vector<string> fileNames;
+    for(int i=0; i<argc; i++) {
+        string arg(argv[i]);
+        if (((arg == "-r") || (arg == "-c") || (arg == "-n") || (arg == "-d")) && (i+1 < argc)) {
+            unsigned int value = (unsigned int)atoi(argv[++i]);
+            if (arg == "-r") rate = value;
+            else if (arg == "-c") capacity = value;
+            else if (arg == "-n") nrRounds = value;
+            else digestLength = value;
+        }
+        else
+            fileNames.push_back(arg);
+    }
+    if (fileNames.empty())
+        fileNames.push_back("-");
+    if ((digestLength == 0) || ((digestLength % 8) != 0)) {
+        cerr << "The digest length must be a non-zero multiple of 8." << endl;
+        return EXIT_FAILURE;
+    }
+    int status = EXIT_SUCCESS;
+    for(unsigned int i=0; i<fileNames.size(); i++) {
+        try {
+            unique_ptr<Sponge> sponge;
+            if (nrRounds == 0)
+                sponge.reset(new Keccak(rate, capacity));
+            else {
+                KeccakF keccakF(rate+capacity);
+                int startRoundIndex = (int)keccakF.getNominalNumberOfRounds() - (int)nrRounds;
+                sponge.reset(new ReducedRoundKeccak(rate, capacity, startRoundIndex, nrRounds));
+            }
+            SpongeStream stream(*sponge);
+            stream.absorbFile(fileNames[i]);
+            vector<UINT8> digest(digestLength/8);
+            sponge->squeeze(&digest[0], digestLength);
+            for(unsigned int j=0; j<digest.size(); j++)
+                cout << hex << setw(2) << setfill('0') << (int)digest[j];
+            cout << "  " << fileNames[i] << endl;
+            cerr << fileNames[i] << ": " << dec << stream.getAbsorbedBytes() << " bytes, "
+                << fixed << setprecision(1) << stream.getThroughput()/(1 << 20) << " MiB/s" << endl;
+        }
+        catch(Exception e) {
+            cerr << fileNames[i] << ": " << e.reason << endl;
+            status = EXIT_FAILURE;
+        }
+    }
+    return status;
+}
+
 int main(int argc, char *argv[])
 {
+    if ((argc >= 2) && (string(argv[1]) == "hash"))
+        return hashFiles(argc-2, argv+2);
     try {
         //TODO: uncomment the desired function
         //testKeccakF();
         //testKeccakSponge();
+        //testSpongeImplementations();
         //testKeccakDuplex();
         //genKATShortMsg_main();
         //generateEquations();
@@ -842,6 +917,27 @@ int main(int argc, char *argv[])
         //weightDistributions(200);
         //testKravatte();
         //testKravatteModes();
+        //testKangarooTwelve();
+        //testParallelHash();
+        //testBitString();
+        //testMappedTable();
+        //testKeccakFImplementations();
+        //benchmarkKeccakF();
+        //benchmarkKeccakFInverse();
+        //benchmarkKeccakFInterleaved();
+        //benchmarkKeccakFParallel();
+        //benchmarkKeccakFGenerated();
+        //autotuneKeccakF();
+        //benchmarkKeccakFLUT();
+        //benchmarkLambdaOnTrails();
+        //benchmarkSpongeSqueeze();
+        //benchmarkDuplexing();
+        //benchmarkBatchHashing();
+        //benchmarkSpongeTree();
+        //benchmarkKangarooTwelve();
+        //benchmarkParallelHash();
+        //benchmarkKravatte();
+        //benchmarkBitString();
     }
     catch(Exception e) {
         cout << e.reason << endl;
@@ -0,0 +1,91 @@
+/*
+ * KeccakTools
+ *
+ * The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+ * Michaël Peeters and Gilles Van Assche. For more information, feedback or
+ * questions, please refer to our website: http://keccak.noekeon.org/
+ *
+ * Implementation by the designers,
+ * hereby denoted as "the implementer".
+ *
+ * To the extent possible under law, the implementer has waived all copyright
+ * and related or neighboring rights to the source code in this file.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <string.h>
+#include <vector>
+#include "mappedtable.h"
+#include "mappedtable-test.h"
+
+using namespace std;
+
+static const char *fileName = "MappedTable-test.table";
+static const char *tableName = "MappedTableTest";
+static const unsigned int width = 200, variant = 3, version = 1;
+
+static vector<UINT8> readFile()
+{
+    ifstream fin(fileName, ios::binary);
+    return vector<UINT8>((istreambuf_iterator<char>(fin)), istreambuf_iterator<char>());
+}
+
+static void writeFile(const vector<UINT8>& contents)
+{
+    ofstream fout(fileName, ios::binary);
+    fout.write((const char *)&contents[0], (streamsize)contents.size());
+}
+
+static void checkRejected(const string& name, unsigned int aWidth, unsigned int aVariant, unsigned int aVersion, const string& reason)
+{
+    MappedTable table;
+    if (table.open(fileName, name, aWidth, aVariant, aVersion) || table.isOpen()) {
+        remove(fileName);
+        throw Exception("MappedTable: open() accepts a file with " + reason + ".");
+    }
+}
+
+void testMappedTable()
+{
+    vector<UINT8> data(1000);
+    for(unsigned int i=0; i<data.size(); i++)
+        data[i] = (UINT8)(i*7 + (i >> 8));
+    if (!MappedTable::save(fileName, tableName, width, variant, version, &data[0], data.size()))
+        throw Exception("MappedTable: save() failed.");
+
+    // Round trip
+    {
+        MappedTable table;
+        if (!table.open(fileName, tableName, width, variant, version))
+            throw Exception("MappedTable: open() rejects the file written by save().");
+        if ((table.getSize() != data.size()) || (memcmp(table.getData(), &data[0], data.size()) != 0))
+            throw Exception("MappedTable: the mapped table differs from the saved one.");
+    }
+
+    // Mismatched header
+    checkRejected("OtherTable", width, variant, version, "another name");
+    checkRejected(tableName, width*2, variant, version, "another width");
+    checkRejected(tableName, width, variant+1, version, "another variant");
+    checkRejected(tableName, width, variant, version+1, "another version");
+
+    // Modified table
+    const vector<UINT8> contents = readFile();
+    if (contents.size() != MappedTable::headerSize + data.size())
+        throw Exception("MappedTable: the file written by save() does not have the expected size.");
+    vector<UINT8> modified(contents);
+    modified[MappedTable::headerSize + 500] ^= 0x10;
+    writeFile(modified);
+    checkRejected(tableName, width, variant, version, "a modified table");
+
+    // Truncated file, in the table and in the header
+    writeFile(vector<UINT8>(contents.begin(), contents.end() - 1));
+    checkRejected(tableName, width, variant, version, "a truncated table");
+    writeFile(vector<UINT8>(contents.begin(), contents.begin() + MappedTable::headerSize/2));
+    checkRejected(tableName, width, variant, version, "a truncated header");
+
+    remove(fileName);
+    cout << "MappedTable: OK" << endl;
+}
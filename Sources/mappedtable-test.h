@@ -0,0 +1,28 @@
+/*
+ * KeccakTools
+ *
+ * The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+ * Michaël Peeters and Gilles Van Assche. For more information, feedback or
+ * questions, please refer to our website: http://keccak.noekeon.org/
+ *
+ * Implementation by the designers,
+ * hereby denoted as "the implementer".
+ *
+ * To the extent possible under law, the implementer has waived all copyright
+ * and related or neighboring rights to the source code in this file.
+ * http://creativecommons.org/publicdomain/zero/1.0/
+ */
+
+#ifndef _MAPPEDTABLETEST_H_
+#define _MAPPEDTABLETEST_H_
+
+/**
+  * Function that checks that a table saved with MappedTable::save()
+  * is mapped back by MappedTable::open(), and that open() rejects a file
+  * whose name, width, variant or version does not match, whose table
+  * was modified or which was truncated.
+  * It throws an Exception in case of mismatch.
+  */
+void testMappedTable();
+
+#endif
@@ -0,0 +1,203 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <sstream>
+#include <string.h>
+#include <thread>
+#include "mappedtable.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+struct MappedTableHeader {
+    char magic[8];
+    UINT32 byteOrderMark;
+    UINT32 version;
+    UINT32 width;
+    UINT32 variant;
+    UINT64 size;
+    UINT64 checksum;
+    char name[MappedTable::headerSize-40];
+};
+
+static const char magic[8] = { 'K', 'T', 'T', 'A', 'B', 'L', 'E', 0 };
+static const UINT32 byteOrderMark = 0x01020304;
+
+static void buildHeader(MappedTableHeader& header, const string& name, unsigned int width, unsigned int variant, unsigned int version)
+{
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, magic, sizeof(magic));
+    header.byteOrderMark = byteOrderMark;
+    header.version = version;
+    header.width = width;
+    header.variant = variant;
+    strncpy(header.name, name.c_str(), sizeof(header.name)-1);
+}
+
+MappedTable::MappedTable()
+    : mapping(0), mappingSize(0)
+#ifdef _WIN32
+    , fileHandle(INVALID_HANDLE_VALUE), mappingHandle(0)
+#endif
+{
+}
+
+MappedTable::~MappedTable()
+{
+    close();
+}
+
+bool MappedTable::open(const string& fileName, const string& name, unsigned int width, unsigned int variant, unsigned int version)
+{
+    close();
+#ifdef _WIN32
+    fileHandle = CreateFileA(fileName.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(fileHandle, &fileSize) || (fileSize.QuadPart < (LONGLONG)headerSize)) {
+        close();
+        return false;
+    }
+    mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (mappingHandle == 0) {
+        close();
+        return false;
+    }
+    mapping = (const UINT8 *)MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0);
+    mappingSize = (UINT64)fileSize.QuadPart;
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStatus;
+    if ((fstat(fd, &fileStatus) != 0) || (fileStatus.st_size < (off_t)headerSize)) {
+        ::close(fd);
+        return false;
+    }
+    void *address = mmap(0, (size_t)fileStatus.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address != MAP_FAILED) {
+        mapping = (const UINT8 *)address;
+        mappingSize = (UINT64)fileStatus.st_size;
+    }
+#endif
+    if (mapping == 0) {
+        close();
+        return false;
+    }
+    MappedTableHeader expected, actual;
+    buildHeader(expected, name, width, variant, version);
+    memcpy(&actual, mapping, sizeof(actual));
+    if ((memcmp(actual.magic, expected.magic, sizeof(magic)) != 0)
+            || (actual.byteOrderMark != expected.byteOrderMark)
+            || (actual.version != expected.version)
+            || (actual.width != expected.width)
+            || (actual.variant != expected.variant)
+            || (memcmp(actual.name, expected.name, sizeof(actual.name)) != 0)
+            || (actual.size != getSize())
+            || (actual.checksum != checksum(getData(), getSize()))) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MappedTable::close()
+{
+#ifdef _WIN32
+    if (mapping != 0)
+        UnmapViewOfFile(mapping);
+    if (mappingHandle != 0)
+        CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE)
+        CloseHandle(fileHandle);
+    mappingHandle = 0;
+    fileHandle = INVALID_HANDLE_VALUE;
+#else
+    if (mapping != 0)
+        munmap((void *)mapping, (size_t)mappingSize);
+#endif
+    mapping = 0;
+    mappingSize = 0;
+}
+
+bool MappedTable::save(const string& fileName, const string& name, unsigned int width, unsigned int variant, unsigned int version,
+    const void *data, UINT64 size)
+{
+    MappedTableHeader header;
+    buildHeader(header, name, width, variant, version);
+    header.size = size;
+    header.checksum = checksum(data, size);
+
+    // Write to a temporary file first, so that other processes never map a partial table.
+    // Its name is unique to this process and thread, so that concurrent writers do not share it.
+    stringstream temporaryName;
+#ifdef _WIN32
+    temporaryName << fileName << "." << GetCurrentProcessId();
+#else
+    temporaryName << fileName << "." << getpid();
+#endif
+    temporaryName << "." << hash<thread::id>()(this_thread::get_id()) << ".tmp";
+    string temporaryFileName = temporaryName.str();
+    {
+        ofstream fout(temporaryFileName.c_str(), ios::binary);
+        if (!fout)
+            return false;
+        fout.write((const char *)&header, sizeof(header));
+        fout.write((const char *)data, (streamsize)size);
+        if (!fout) {
+            fout.close();
+            remove(temporaryFileName.c_str());
+            return false;
+        }
+    }
+#ifdef _WIN32
+    remove(fileName.c_str());
+#endif
+    if (rename(temporaryFileName.c_str(), fileName.c_str()) != 0) {
+        remove(temporaryFileName.c_str());
+        return false;
+    }
+    return true;
+}
+
+UINT64 MappedTable::checksum(const void *data, UINT64 size)
+{
+    // 64-bit FNV-1a, applied on 64-bit words and then on the remaining bytes
+    const UINT64 prime = 0x100000001B3ULL;
+    UINT64 h = 0xCBF29CE484222325ULL;
+    const UINT8 *bytes = (const UINT8 *)data;
+    UINT64 i = 0;
+    for( ; i+8<=size; i+=8) {
+        UINT64 word;
+        memcpy(&word, bytes+i, 8);
+        h = (h ^ word) * prime;
+    }
+    for( ; i<size; i++)
+        h = (h ^ bytes[i]) * prime;
+    return h;
+}
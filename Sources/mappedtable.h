@@ -0,0 +1,108 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _MAPPEDTABLE_H_
+#define _MAPPEDTABLE_H_
+
+#include <string>
+#include "types.h"
+
+using namespace std;
+
+/**
+  * Class that gives read-only access to a precomputed table stored in a file,
+  * by mapping the file into memory instead of copying it into the heap.
+  * Several processes that use the same table thus share a single copy
+  * in the page cache.
+  *
+  * The file starts with a header of headerSize bytes that identifies
+  * the table by a name, a width and a variant (e.g., the number of rounds,
+  * or DC vs LC), a format version and the byte order of the host that wrote it.
+  * It also contains the size and a checksum of the table that follows.
+  * If any of these does not match, open() fails and the table must be
+  * generated again and saved with save().
+  */
+class MappedTable {
+public:
+    /** The size of the header, which keeps the table aligned. */
+    static const unsigned int headerSize = 128;
+protected:
+    /** The address of the mapped file, or 0 if no file is mapped. */
+    const UINT8 *mapping;
+    /** The size of the mapped file in bytes. */
+    UINT64 mappingSize;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+public:
+    /**
+      * The constructor, which maps no file.
+      */
+    MappedTable();
+    /**
+      * The destructor, which unmaps the file, if any.
+      */
+    ~MappedTable();
+    /**
+      * Method that maps the file @a fileName, after checking that its header
+      * matches the given parameters and that the checksum of the table is correct.
+      *
+      * @param  fileName    The name of the file.
+      * @param  name    The name identifying the table.
+      * @param  width   The width of the permutation the table relates to.
+      * @param  variant A parameter that further identifies the table.
+      * @param  version The version of the format of the table.
+      * @return true if the file was mapped, false if it does not exist or does not match.
+      */
+    bool open(const string& fileName, const string& name, unsigned int width, unsigned int variant, unsigned int version);
+    /**
+      * Method that unmaps the file, if any.
+      */
+    void close();
+    /**
+      * Method that tells whether a file is mapped.
+      */
+    bool isOpen() const { return mapping != 0; }
+    /**
+      * Method that returns the address of the table, after the header.
+      */
+    const void *getData() const { return mapping + headerSize; }
+    /**
+      * Method that returns the size of the table in bytes, without the header.
+      */
+    UINT64 getSize() const { return mappingSize - headerSize; }
+    /**
+      * Function that writes a table and its header to the file @a fileName.
+      * See open() for the parameters. The table is first written to a temporary
+      * file, next to @a fileName and unique to the calling process and thread,
+      * which is then renamed, so that concurrent writers never expose a partial table.
+      *
+      * @param  data    The address of the table.
+      * @param  size    The size of the table in bytes.
+      * @return true if the file was written successfully.
+      */
+    static bool save(const string& fileName, const string& name, unsigned int width, unsigned int variant, unsigned int version,
+        const void *data, UINT64 size);
+    /**
+      * Function that computes the checksum stored in the header.
+      */
+    static UINT64 checksum(const void *data, UINT64 size);
+private:
+    MappedTable(const MappedTable&);
+    MappedTable& operator=(const MappedTable&);
+};
+
+#endif
@@ -14,121 +14,116 @@ http://creativecommons.org/publicdomain/zero/1.0/
 */
 
 #include <sstream>
+#include <string.h>
 #include <vector>
 #include "padding.h"
 
 using namespace std;
 
-MessageBlock::MessageBlock()
-    : bitsInBlock(0)
+MessageQueue::MessageQueue(unsigned int aBlockSize, unsigned int aCapacity)
+    : blockSize(aBlockSize), blockSizeInWords((aBlockSize+63)/64), capacity(aCapacity),
+    firstSlot(0), wholeBlocks(0), lastBlockBits(0)
 {
-}
-
-void MessageBlock::appendBit(int bitValue)
-{
-    unsigned int bitsInByte = bitsInBlock % 8;
-    if (bitsInByte == 0)
-        block.push_back(bitValue & 1);
-    else if (bitValue & 1)
-        block.back() |= (UINT8)(1 << bitsInByte);
-    bitsInBlock++;
-}
-
-void MessageBlock::appendByte(UINT8 byteValue)
-{
-    if ((bitsInBlock % 8) == 0) {
-        block.push_back(byteValue);
-        bitsInBlock += 8;
-    }
-    else {
-        for(unsigned int i=0; i<8; i++) {
-            appendBit(byteValue % 2);
-            byteValue = byteValue / 2;
-        }
-    }
-}
-
-void MessageBlock::appendZeroes(unsigned int count)
-{
-    while((count > 0) && ((bitsInBlock % 8) != 0)) {
-        appendBit(0);
-        count--;
-    }
-    while(count >= 8) {
-        block.push_back(0);
-        bitsInBlock += 8;
-        count -= 8;
-    }
-    while(count > 0) {
-        appendBit(0);
-        count--;
+    if (blockSize == 0)
+        throw Exception("The block size must be strictly positive.");
+    if (capacity == 0) {
+        capacity = (defaultCapacityInBits+blockSize-1)/blockSize + 1;
+        if (capacity < 3)
+            capacity = 3;
     }
-}
-
-unsigned int MessageBlock::size() const
-{
-    return bitsInBlock;
-}
-
-const vector<UINT8>& MessageBlock::get() const
-{
-    return block;
-}
-
-MessageQueue::MessageQueue(unsigned int aBlockSize)
-    : blockSize(aBlockSize)
-{
-    queue.push_back(MessageBlock());
+    storage.assign(capacity*blockSizeInWords, 0);
 }
 
 unsigned int MessageQueue::lastBlockSize() const
 {
-    return queue.back().size();
+    if ((lastBlockBits == 0) && (wholeBlocks > 0))
+        return blockSize;
+    else
+        return lastBlockBits;
 }
 
 unsigned int MessageQueue::blockCount() const
 {
-    if (queue.size() == 0)
-        return 0;
-    else if (queue.back().size() == 0)
-        return queue.size()-1;
-    else
-        return queue.size();
+    return wholeBlocks + ((lastBlockBits > 0) ? 1 : 0);
 }
 
-void MessageQueue::adjustLastBlock()
+UINT8 *MessageQueue::getLastBlock()
 {
-    if (lastBlockSize() >= blockSize)
-        queue.push_back(MessageBlock());
+    if (wholeBlocks == capacity)
+        throw Exception("The message queue is full.");
+    unsigned int slot = (firstSlot + wholeBlocks) % capacity;
+    UINT64 *block = &storage[slot*blockSizeInWords];
+    if (lastBlockBits == 0)
+        memset(block, 0, blockSizeInWords*8);
+    return (UINT8*)block;
 }
 
-void MessageQueue::appendBit(int bitValue)
+void MessageQueue::advance(unsigned int count)
 {
-    adjustLastBlock();
-    queue.back().appendBit(bitValue);
+    lastBlockBits += count;
+    if (lastBlockBits == blockSize) {
+        wholeBlocks++;
+        lastBlockBits = 0;
+    }
 }
 
-void MessageQueue::appendByte(UINT8 byteValue)
+void MessageQueue::appendBits(UINT64 bits, unsigned int count)
 {
-    adjustLastBlock();
-    if (lastBlockSize()+8 <= blockSize)
-        queue.back().appendByte(byteValue);
-    else {
-        for(unsigned int i=0; i<8; i++) {
-            appendBit(byteValue % 2);
-            byteValue = byteValue / 2;
+    if (count < 64)
+        bits &= ((UINT64)1 << count) - 1;
+    while(count > 0) {
+        UINT8 *block = getLastBlock();
+        unsigned int countInBlock = blockSize - lastBlockBits;
+        if (countInBlock > count)
+            countInBlock = count;
+        UINT64 bitsInBlock = (countInBlock < 64) ? (bits & (((UINT64)1 << countInBlock) - 1)) : bits;
+        UINT8 *byte = block + lastBlockBits/8;
+        unsigned int shift = lastBlockBits%8;
+        byte[0] |= (UINT8)(bitsInBlock << shift);
+        for(unsigned int done=8-shift; done<countInBlock; done+=8)
+            *(++byte) = (UINT8)(bitsInBlock >> done);
+        advance(countInBlock);
+        bits = (countInBlock < 64) ? (bits >> countInBlock) : 0;
+        count -= countInBlock;
+    }
+}
+
+void MessageQueue::append(const UINT8 *input, unsigned int lengthInBits)
+{
+    while(lengthInBits >= 8) {
+        if ((lastBlockBits % 8) == 0) {
+            unsigned int bytesInBlock = (blockSize - lastBlockBits)/8;
+            if (bytesInBlock > lengthInBits/8)
+                bytesInBlock = lengthInBits/8;
+            if (bytesInBlock > 0) {
+                UINT8 *block = getLastBlock();
+                memcpy(block + lastBlockBits/8, input, bytesInBlock);
+                advance(bytesInBlock*8);
+                input += bytesInBlock;
+                lengthInBits -= bytesInBlock*8;
+                continue;
+            }
         }
+        unsigned int bytes = (lengthInBits >= 64) ? 8 : lengthInBits/8;
+        UINT64 bits = 0;
+        for(unsigned int i=0; i<bytes; i++)
+            bits |= (UINT64)input[i] << (8*i);
+        appendBits(bits, bytes*8);
+        input += bytes;
+        lengthInBits -= bytes*8;
     }
+    if (lengthInBits > 0)
+        appendBits(*input, lengthInBits);
 }
 
 void MessageQueue::appendZeroes(unsigned int count)
 {
     while(count > 0) {
-        adjustLastBlock();
-        unsigned int countInBlock = count;
-        if (countInBlock > (blockSize - lastBlockSize()))
-            countInBlock = blockSize - lastBlockSize();
-        queue.back().appendZeroes(countInBlock);
+        getLastBlock();
+        unsigned int countInBlock = blockSize - lastBlockBits;
+        if (countInBlock > count)
+            countInBlock = count;
+        advance(countInBlock);
         count -= countInBlock;
     }
 }
@@ -138,27 +133,21 @@ void MessageQueue::pad(const PaddingRule &pad)
     pad.pad(blockSize, *this);
 }
 
-bool MessageQueue::firstBlockIsWhole() const
-{
-    return queue.front().size() == blockSize;
-}
-
-const vector<UINT8>& MessageQueue::firstBlock() const
-{
-    return queue.front().get();
-}
-
 void MessageQueue::removeFirstBlock()
 {
-    queue.pop_front();
-    if (queue.size() == 0)
-        queue.push_back(MessageBlock());
+    if (wholeBlocks > 0) {
+        firstSlot = (firstSlot + 1) % capacity;
+        wholeBlocks--;
+    }
+    else
+        lastBlockBits = 0;
 }
 
 void MessageQueue::clear()
 {
-    queue.clear();
-    queue.push_back(MessageBlock());
+    firstSlot = 0;
+    wholeBlocks = 0;
+    lastBlockBits = 0;
 }
 
 
@@ -175,6 +164,21 @@ void PaddingRule::append10star(unsigned int blockSize, MessageQueue& queue) cons
         queue.appendZeroes(blockSize - (queue.lastBlockSize() % blockSize));
 }
 
+void PaddingRule::xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const
+{
+    MessageQueue queue(rate);
+    queue.appendZeroes(inputSize);
+    pad(rate, queue);
+    const UINT8 *padded = queue.firstBlock();
+    for(unsigned int i=0; i<(rate+7)/8; i++)
+        block[i] ^= padded[i];
+}
+
+static inline void xorBit(UINT8 *block, unsigned int position)
+{
+    block[position/8] ^= (UINT8)(1 << (position%8));
+}
+
 unsigned int PaddingRule::getDuplexRate(unsigned int rho_max) const
 {
     unsigned int rate = 0;
@@ -210,6 +214,12 @@ unsigned int SimplePadding::getPaddedSize(unsigned int rate, unsigned int inputS
     return inputSize;
 }
 
+void SimplePadding::xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const
+{
+    (void)rate;
+    xorBit(block, inputSize);
+}
+
 string SimplePadding::getDescription() const
 {
     return "pad10*";
@@ -230,6 +240,12 @@ unsigned int MultiRatePadding::getPaddedSize(unsigned int rate, unsigned int inp
     return inputSize;
 }
 
+void MultiRatePadding::xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const
+{
+    xorBit(block, inputSize);
+    xorBit(block, rate-1);
+}
+
 string MultiRatePadding::getDescription() const
 {
     return "pad10*1";
@@ -256,6 +272,15 @@ unsigned int OldDiversifiedKeccakPadding::getPaddedSize(unsigned int rate, unsig
     return inputSize;
 }
 
+void OldDiversifiedKeccakPadding::xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const
+{
+    xorBit(block, inputSize);
+    unsigned int byteIndex = (inputSize+8)/8;
+    block[byteIndex] ^= diversifier;
+    block[byteIndex+1] ^= (UINT8)(rate/8);
+    xorBit(block, (byteIndex+2)*8);
+}
+
 string OldDiversifiedKeccakPadding::getDescription() const
 {
     stringstream str;
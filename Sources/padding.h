@@ -16,81 +16,79 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #ifndef _PADDING_H_
 #define _PADDING_H_
 
-#include <deque>
 #include <iostream>
 #include <vector>
 #include "types.h"
 
 using namespace std;
 
-/** Class representing a message block whose size is not necessarily
-  * a multiple of 8 bits.
-  * The block can contain any number of bits.
-  */
-class MessageBlock {
-private:
-    /** The current block stored as a sequence of bytes.
-      * If the number of bits is not a multiple of 8, the last byte contains the
-      * last few bits in its least significant bits.
-      */
-    vector<UINT8> block;
-    /** The number of bits in the block. */
-    unsigned int bitsInBlock;
-public:
-    /** The constructor. */
-    MessageBlock();
-    /** Method to append one bit to the block.
-      * @param  bitValue     The value (0 or 1) of the bit to append.
-      */
-    void appendBit(int bitValue);
-    /** Method to append one byte to the block.
-      * @param  byteValue     The value (0x00…0xFF) of the byte to append.
-      */
-    void appendByte(UINT8 byteValue);
-    /** Method to append a series of bits with value '0'.
-      * @param  count     The number of zeroes to append.
-      */
-    void appendZeroes(unsigned int count);
-    /** Method that returns the number of bits in the block.
-      * @return  The number of bits in the block.
-      */
-    unsigned int size() const;
-    /** Method that returns a reference to the block.
-      * @return  A constant reference to the block represented as a vector of bytes.
-      * If the number of bits is not a multiple of 8, the last byte contains the
-      * last few bits in its least significant bits.
-      */
-    const vector<UINT8>& get() const;
-};
-
 class PaddingRule;
 
 /** Class representing a sequence of fixed-size blocks, except the last one,
   * whose size can be smaller.
+  *
+  * The blocks are stored in a ring buffer with a fixed number of slots,
+  * each slot being aligned on 8 bytes, so that no allocation takes place
+  * after construction. Within a block, the bits are stored as a sequence
+  * of bytes; if the number of bits is not a multiple of 8, the last byte
+  * contains the last few bits in its least significant bits.
+  * When the ring buffer is full, appending throws an exception;
+  * getFreeSpace() tells how many bits can still be appended.
+  * The same object can be reused for several messages by calling clear().
   */
 class MessageQueue {
 private:
-    /** The sequence of blocks of type MessageBlock . */
-    deque<MessageBlock> queue;
+    /** The storage for the slots, each of blockSizeInWords 64-bit words. */
+    vector<UINT64> storage;
     /** The size of the blocks in bits. */
     unsigned int blockSize;
+    /** The size of each slot in 64-bit words. */
+    unsigned int blockSizeInWords;
+    /** The number of slots in the ring buffer. */
+    unsigned int capacity;
+    /** The index of the slot containing the first block. */
+    unsigned int firstSlot;
+    /** The number of whole blocks, starting from firstSlot. */
+    unsigned int wholeBlocks;
+    /** The number of bits in the partial block that follows the whole blocks. */
+    unsigned int lastBlockBits;
 public:
+    /** The default minimum capacity of the ring buffer in bits, if not specified. */
+    static const unsigned int defaultCapacityInBits = 4096;
     /** The constructor.
       * @param  aBlockSize    The desired block size in bits.
+      * @param  aCapacity     The number of blocks that the queue can contain.
+      *                       If 0, the capacity is such that at least
+      *                       defaultCapacityInBits bits and two whole blocks,
+      *                       plus a partial block, fit in the queue.
       */
-    MessageQueue(unsigned int aBlockSize);
+    MessageQueue(unsigned int aBlockSize, unsigned int aCapacity = 0);
     /** Method to append one bit to the sequence.
       * @param  bitValue     The value (0 or 1) of the bit to append.
       */
-    void appendBit(int bitValue);
+    void appendBit(int bitValue) { appendBits((UINT64)(bitValue & 1), 1); }
     /** Method to append one byte to the sequence.
       * @param  byteValue     The value (0x00…0xFF) of the byte to append.
       */
-    void appendByte(UINT8 byteValue);
+    void appendByte(UINT8 byteValue) { appendBits(byteValue, 8); }
+    /** Method to append up to 64 bits at once to the sequence.
+      * @param  bits    The bits to append, starting from the least significant one.
+      * @param  count   The number of bits to append, at most 64.
+      */
+    void appendBits(UINT64 bits, unsigned int count);
     /** Method to append a series of bits with value '0'.
       * @param  count     The number of zeroes to append.
       */
     void appendZeroes(unsigned int count);
+    /** Method to append a number of bits to the sequence.
+      * Whole bytes are copied at once when the end of the sequence is byte-aligned,
+      * and 64 bits at a time otherwise.
+      * @param  input   The sequence of bytes to append.
+      * If the number of bits is not a multiple of 8, the last byte contains the
+      * last few bits in its least significant bits.
+      * @param  lengthInBits The number of bits to append.
+      */
+    void append(const UINT8 *input, unsigned int lengthInBits);
     /** Method to append a number of bits to the sequence.
       * @param  inputStart  Constant iterator for the sequence of bytes to append.
       * If the number of bits is not a multiple of 8, the last byte contains the
@@ -100,21 +98,14 @@ public:
     template<class InputIterator>
     void append(InputIterator inputStart, unsigned int lengthInBits)
     {
-        if (lengthInBits == 0)
-            return;
         InputIterator i = inputStart;
         while(lengthInBits >= 8) {
             appendByte(*i);
             ++i;
             lengthInBits -= 8;
         }
-        if (lengthInBits > 0) {
-            UINT8 lastByte = *i;
-            for(unsigned int i=0; i<lengthInBits; i++) {
-                appendBit(lastByte & 1);
-                lastByte = lastByte >> 1;
-            }
-        }
+        if (lengthInBits > 0)
+            appendBits((UINT8)*i, lengthInBits);
     }
     /** Method to append a number of bytes to the sequence.
       * @param  inputStart  Constant iterator for the begin of the sequence of bytes to append.
@@ -141,21 +132,29 @@ public:
     /** Method that tells whether the first block has exactly blockSize bits.
       * @return  True iff the first block has exactly blockSize bits.
       */
-    bool firstBlockIsWhole() const;
-    /** Method that returns a reference to the first block of the sequence.
-      * @return  A constant reference to the block represented as a vector of bytes.
+    bool firstBlockIsWhole() const { return wholeBlocks > 0; }
+    /** Method that returns the first block of the sequence.
+      * @return  A pointer to the first block, of ceil(blockSize/8) bytes
+      * if it is whole, or of ceil(lastBlockSize()/8) bytes otherwise.
       * If the number of bits is not a multiple of 8, the last byte contains the
       * last few bits in its least significant bits.
+      * The pointer is valid until the block is removed.
       */
-    const vector<UINT8>& firstBlock() const;
+    const UINT8* firstBlock() const { return (const UINT8*)&storage[firstSlot*blockSizeInWords]; }
     /** Method that removes the first block of the sequence.
       */
     void removeFirstBlock();
+    /** Method that returns the number of bits that can still be appended.
+      */
+    unsigned int getFreeSpace() const { return (capacity - wholeBlocks)*blockSize - lastBlockBits; }
     /** Method to empty the sequence. */
     void clear();
 private:
-    /** Private method to create a new block if the last one has reached blockSize bits. */
-    void adjustLastBlock();
+    /** Private method that returns the slot of the partial block, clearing
+      * it first if it is empty, or throws an exception if the queue is full. */
+    UINT8 *getLastBlock();
+    /** Private method to account for @a count bits appended to the partial block. */
+    void advance(unsigned int count);
 };
 
 /**
@@ -177,6 +176,16 @@ public:
       * @param  inputSize   The size in bits of the input message before padding.
       */
     virtual unsigned int getPaddedSize(unsigned int rate, unsigned int inputSize) const = 0;
+    /** Method that XORs into @a block the bits that pad() appends to a message of
+      * @a inputSize bits, assuming that the padded message fits in a single block,
+      * i.e., that getPaddedSize(rate, inputSize) == rate.
+      * The default implementation pads a message of zeroes in a MessageQueue;
+      * derived classes set the padding bits directly in the block instead.
+      * @param  rate The block size in bits to which the padding must align.
+      * @param  inputSize   The size in bits of the input message before padding.
+      * @param  block   The block of ceil(rate/8) bytes, e.g., the outer part of a state.
+      */
+    virtual void xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const;
     /** Abstract method to compute the minimum rate of a duplex object with the
       * given padding, given the maximum duplex rate rho_max.
       * @param  rate The block size in bits to which the padding must align.
@@ -217,6 +226,8 @@ public:
     void pad(unsigned int rate, MessageQueue& queue) const;
     /** Actual method for SimplePadding, see PaddingRule::getPaddedSize(). */
     unsigned int getPaddedSize(unsigned int rate, unsigned int inputSize) const;
+    /** Actual method for SimplePadding, see PaddingRule::xorPaddingIntoBlock(). */
+    void xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const;
     /** Actual method for SimplePadding, see PaddingRule::getDescription(). */
     string getDescription() const;
 };
@@ -233,6 +244,8 @@ public:
     void pad(unsigned int rate, MessageQueue& queue) const;
     /** Actual method for MultiRatePadding, see PaddingRule::getPaddedSize(). */
     unsigned int getPaddedSize(unsigned int rate, unsigned int inputSize) const;
+    /** Actual method for MultiRatePadding, see PaddingRule::xorPaddingIntoBlock(). */
+    void xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const;
     /** Actual method for MultiRatePadding, see PaddingRule::getDescription(). */
     string getDescription() const;
 };
@@ -251,6 +264,8 @@ public:
     void pad(unsigned int rate, MessageQueue& queue) const;
     /** Actual method for OldDiversifiedKeccakPadding, see PaddingRule::getPaddedSize(). */
     unsigned int getPaddedSize(unsigned int rate, unsigned int inputSize) const;
+    /** Actual method for OldDiversifiedKeccakPadding, see PaddingRule::xorPaddingIntoBlock(). */
+    void xorPaddingIntoBlock(unsigned int rate, unsigned int inputSize, UINT8 *block) const;
     /** Actual method for OldDiversifiedKeccakPadding, see PaddingRule::getDescription(). */
     string getDescription() const;
     /** Actual method for OldDiversifiedKeccakPadding, see PaddingRule::isRateValid().
@@ -275,7 +290,7 @@ vector<UINT8> getKeyPack(InputIterator keyStart, unsigned int keyLengthInBits, u
     if (keyPackQueue.blockCount() != 1)
         throw Exception("The pack length is not large enough to make the key fit");
 
-    return keyPackQueue.firstBlock();
+    return vector<UINT8>(keyPackQueue.firstBlock(), keyPackQueue.firstBlock() + packLengthInBits/8);
 }
 
 #endif
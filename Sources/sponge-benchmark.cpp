@@ -0,0 +1,319 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <vector>
+#include "KangarooTwelve.h"
+#include "Kravatte.h"
+#include "Keccak.h"
+#include "Keccak-f.h"
+#include "ParallelHash.h"
+#include "duplex.h"
+#include "sponge-benchmark.h"
+#include "spongebatch.h"
+#include "spongetree.h"
+#include "timing.h"
+
+using namespace std;
+
+static const UINT64 oneGiB = 1ULL << 30;
+
+static double bytesPerSecondInGiB(UINT64 bytes, double seconds)
+{
+    return (double)bytes/oneGiB/seconds;
+}
+
+void benchmarkSpongeSqueeze()
+{
+    const unsigned int requestSizes[] = { 1, 8, 64, 168, 1024, 65536, 1 << 20 };
+    cout << "Squeezing 1 GiB from Keccak[r=1344, c=256]" << endl;
+    cout << "Request size (bytes)   time (s)   GiB/s   cycles/byte" << endl;
+    for(unsigned int i=0; i<sizeof(requestSizes)/sizeof(requestSizes[0]); i++) {
+        Keccak keccak(1344, 256);
+        vector<UINT8> output(requestSizes[i]);
+        keccak.absorb((const UINT8*)"", 0);
+        UINT64 nrCalls = oneGiB/requestSizes[i];
+        double startTime = getTimeInSeconds();
+        UINT64 startCycles = getCycleCount();
+        for(UINT64 j=0; j<nrCalls; j++)
+            keccak.squeeze(&output[0], requestSizes[i]*8);
+        UINT64 cycles = getCycleCount() - startCycles;
+        double seconds = getTimeInSeconds() - startTime;
+        cout << setw(20) << requestSizes[i];
+        cout << fixed << setprecision(2);
+        cout << setw(11) << seconds;
+        cout << setw(8) << bytesPerSecondInGiB(oneGiB, seconds);
+        cout << setw(14) << (double)cycles/oneGiB << endl;
+    }
+}
+
+static double duplexingCallsPerSecond(Duplex& duplex, bool inPlace, unsigned int nrCalls)
+{
+    unsigned int inputLength = duplex.getMaximumInputLength();
+    unsigned int outputLength = duplex.getMaximumOutputLength();
+    vector<UINT8> input((inputLength+7)/8, 0x5A);
+    vector<UINT8> output((outputLength+7)/8);
+    double startTime = getTimeInSeconds();
+    for(unsigned int i=0; i<nrCalls; i++) {
+        if (inPlace)
+            duplex.duplexing(&input[0], inputLength, &output[0], outputLength);
+        else {
+            vector<UINT8> outputAsVector;
+            duplex.duplexing(input.begin(), inputLength, outputAsVector, outputLength);
+        }
+    }
+    return nrCalls/(getTimeInSeconds() - startTime);
+}
+
+void benchmarkDuplexing()
+{
+    const unsigned int widths[] = { 1600, 1600, 1600, 1600, 800, 400, 200 };
+    const unsigned int rates[] = { 1024, 1026, 1032, 1346, 546, 146, 42 };
+    const unsigned int nrCalls = 200000;
+    cout << "Duplex (pad10*1)                     vector API (calls/s)  in place (calls/s)  speed-up" << endl;
+    for(unsigned int i=0; i<sizeof(rates)/sizeof(rates[0]); i++) {
+        KeccakF keccakF(widths[i]);
+        MultiRatePadding pad;
+        Duplex duplex(&keccakF, &pad, rates[i]);
+        double before = duplexingCallsPerSecond(duplex, false, nrCalls);
+        double after = duplexingCallsPerSecond(duplex, true, nrCalls);
+        stringstream description;
+        description << "Keccak-f[" << dec << widths[i] << "], r=" << rates[i];
+        cout << setw(37) << left << description.str() << right;
+        cout << fixed << setprecision(0);
+        cout << setw(21) << before << setw(20) << after;
+        cout << setprecision(2) << setw(9) << after/before << "x" << endl;
+    }
+}
+
+void benchmarkBatchHashing()
+{
+    const unsigned int messageSizes[] = { 0, 16, 64, 136, 256, 1024, 4096, 10240 };
+    const UINT64 bytesPerSize = 1 << 26;
+    cout << "Hashing independent messages with Keccak[r=1088, c=512], 256-bit digests" << endl;
+    cout << "Size (bytes)   Keccak loop (msg/s)   batch, 1 thread (msg/s)   batch, threads (msg/s)" << endl;
+    for(unsigned int i=0; i<sizeof(messageSizes)/sizeof(messageSizes[0]); i++) {
+        unsigned int nrMessages = (unsigned int)(bytesPerSize/(messageSizes[i] + 136));
+        vector<vector<UINT8> > messages(nrMessages, vector<UINT8>(messageSizes[i]));
+        for(unsigned int j=0; j<nrMessages; j++)
+            for(unsigned int k=0; k<messageSizes[i]; k++)
+                messages[j][k] = (UINT8)(j + k);
+        vector<vector<UINT8> > digests(nrMessages);
+
+        Keccak keccak(1088, 512);
+        double startTime = getTimeInSeconds();
+        for(unsigned int j=0; j<nrMessages; j++) {
+            keccak.reset();
+            keccak.absorb(messages[j], messageSizes[i]*8);
+            digests[j].clear();
+            keccak.squeeze(digests[j], 256);
+        }
+        double loop = nrMessages/(getTimeInSeconds() - startTime);
+
+        KeccakBatch singleThreaded(1088, 512, false);
+        startTime = getTimeInSeconds();
+        singleThreaded.hash(messages, 256, digests);
+        double batch = nrMessages/(getTimeInSeconds() - startTime);
+
+        KeccakBatch multiThreaded(1088, 512, true);
+        startTime = getTimeInSeconds();
+        multiThreaded.hash(messages, 256, digests);
+        double threads = nrMessages/(getTimeInSeconds() - startTime);
+
+        cout << fixed << setprecision(0);
+        cout << setw(12) << messageSizes[i];
+        cout << setw(22) << loop << setw(26) << batch << setw(25) << threads << endl;
+    }
+}
+
+class KeccakFactory : public SpongeFactory {
+public:
+    Sponge* newSponge() const { return new Keccak(1088, 512); }
+};
+
+void benchmarkSpongeTree()
+{
+    const int degrees[] = { 1, 2, 4, 8, 16 };
+    const int B = 8*8704;
+    const unsigned int chunkSize = 1 << 20;
+    const unsigned int nrChunks = 256;
+    vector<UINT8> chunk(chunkSize);
+    for(unsigned int i=0; i<chunkSize; i++)
+        chunk[i] = (UINT8)i;
+    KeccakFactory factory;
+    cout << "Absorbing 256 MiB in ShortLeafInterleavedSpongeTree with Keccak[r=1088, c=512] and B=" << dec << B << endl;
+    cout << " D   serial (MiB/s)   parallel (MiB/s)   speed-up" << endl;
+    for(unsigned int d=0; d<sizeof(degrees)/sizeof(degrees[0]); d++) {
+        double throughputs[2];
+        for(int parallel=0; parallel<2; parallel++) {
+            ShortLeafInterleavedSpongeTree tree(factory, degrees[d], B, parallel != 0);
+            vector<UINT8> output;
+            double startTime = getTimeInSeconds();
+            for(unsigned int i=0; i<nrChunks; i++)
+                tree.absorb(&chunk[0], chunkSize*8);
+            tree.squeeze(output, 256);
+            throughputs[parallel] = (double)nrChunks*chunkSize/(1 << 20)/(getTimeInSeconds() - startTime);
+        }
+        cout << fixed << setprecision(1);
+        cout << setw(2) << degrees[d] << setw(17) << throughputs[0] << setw(19) << throughputs[1];
+        cout << setprecision(2) << setw(10) << throughputs[1]/throughputs[0] << "x" << endl;
+    }
+}
+
+void benchmarkKangarooTwelve()
+{
+    const unsigned int chunkSize = 1 << 20;
+    const unsigned int nrChunks = 256;
+    vector<UINT8> chunk(chunkSize);
+    for(unsigned int i=0; i<chunkSize; i++)
+        chunk[i] = (UINT8)i;
+    cout << "Hashing 256 MiB" << endl;
+    cout << "Function                              time (s)   GiB/s" << endl;
+    for(int i=0; i<3; i++) {
+        vector<UINT8> output;
+        double startTime = getTimeInSeconds();
+        if (i == 0) {
+            Keccak keccak(1344, 256);
+            for(unsigned int j=0; j<nrChunks; j++)
+                keccak.absorb(&chunk[0], chunkSize*8);
+            keccak.squeeze(output, 256);
+        }
+        else {
+            KangarooTwelve k12(vector<UINT8>(), i == 2);
+            for(unsigned int j=0; j<nrChunks; j++)
+                k12.absorb(&chunk[0], chunkSize);
+            k12.squeeze(output, 32);
+        }
+        double seconds = getTimeInSeconds() - startTime;
+        const char *names[] = { "Keccak[r=1344, c=256]", "KangarooTwelve, 1 thread", "KangarooTwelve, threads" };
+        cout << setw(35) << left << names[i] << right;
+        cout << fixed << setprecision(2);
+        cout << setw(11) << seconds;
+        cout << setw(8) << bytesPerSecondInGiB((UINT64)nrChunks*chunkSize, seconds) << endl;
+    }
+}
+
+void benchmarkParallelHash()
+{
+    const unsigned int chunkSize = 1 << 20;
+    const unsigned int nrChunks = 256;
+    vector<UINT8> chunk(chunkSize);
+    for(unsigned int i=0; i<chunkSize; i++)
+        chunk[i] = (UINT8)i;
+    cout << "Hashing 256 MiB" << endl;
+    cout << "Function                              time (s)   GiB/s" << endl;
+    for(int i=0; i<3; i++) {
+        vector<UINT8> output;
+        double startTime = getTimeInSeconds();
+        if (i == 0) {
+            CSHAKE shake(128);
+            for(unsigned int j=0; j<nrChunks; j++)
+                shake.absorb(&chunk[0], chunkSize);
+            shake.squeeze(output, 32);
+        }
+        else {
+            ParallelHash parallelHash(128, 8192, 256, vector<UINT8>(), i == 2);
+            for(unsigned int j=0; j<nrChunks; j++)
+                parallelHash.absorb(&chunk[0], chunkSize);
+            parallelHash.squeeze(output, 32);
+        }
+        double seconds = getTimeInSeconds() - startTime;
+        const char *names[] = { "SHAKE128", "ParallelHash128, B=8192, 1 thread", "ParallelHash128, B=8192, threads" };
+        cout << setw(35) << left << names[i] << right;
+        cout << fixed << setprecision(2);
+        cout << setw(11) << seconds;
+        cout << setw(8) << bytesPerSecondInGiB((UINT64)nrChunks*chunkSize, seconds) << endl;
+    }
+}
+
+void benchmarkKravatte()
+{
+    const unsigned int sizes[] = { 1 << 10, 1 << 14, 1 << 20, 1 << 24, 100 << 20 };
+    const char *sizeNames[] = { "1 KiB", "16 KiB", "1 MiB", "16 MiB", "100 MiB" };
+    BitString K(256, 0xA5);
+    for(int multiThreaded=0; multiThreaded<2; multiThreaded++) {
+        Kravatte kravatte(multiThreaded != 0);
+        cout << (multiThreaded ? "Kravatte, threads" : "Kravatte, 1 thread") << endl;
+        cout << "Size       compression (s)   GiB/s   expansion (s)   GiB/s" << endl;
+        for(unsigned int i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+            vector<UINT8> message(sizes[i]);
+            for(unsigned int j=0; j<sizes[i]; j++)
+                message[j] = (UINT8)j;
+            BitStrings Mseq = BitStrings(BitString(message));
+            double startTime = getTimeInSeconds();
+            BitString tag = kravatte(K, Mseq, 256);
+            double compressionSeconds = getTimeInSeconds() - startTime;
+            startTime = getTimeInSeconds();
+            BitString output = kravatte(K, BitStrings(BitString()), sizes[i]*8);
+            double expansionSeconds = getTimeInSeconds() - startTime;
+            cout << setw(7) << left << sizeNames[i] << right;
+            cout << fixed << setprecision(4);
+            cout << setw(19) << compressionSeconds;
+            cout << setw(8) << bytesPerSecondInGiB(sizes[i], compressionSeconds);
+            cout << setw(16) << expansionSeconds;
+            cout << setw(8) << bytesPerSecondInGiB(sizes[i], expansionSeconds) << endl;
+        }
+    }
+}
+
+template<class Operation>
+static void benchmarkBitStringOperation(const char *name, unsigned int size, Operation operation)
+{
+    const UINT64 nrCalls = (size <= 1600) ? 1000000 : 1000;
+    double startTime = getTimeInSeconds();
+    UINT64 startCycles = getCycleCount();
+    unsigned int checksum = 0;
+    for(UINT64 i=0; i<nrCalls; i++)
+        checksum += operation();
+    UINT64 cycles = getCycleCount() - startCycles;
+    double seconds = getTimeInSeconds() - startTime;
+    cout << setw(24) << left << name << right;
+    cout << setw(10) << size;
+    cout << fixed << setprecision(1);
+    cout << setw(14) << seconds*1e9/nrCalls;
+    cout << setw(14) << (double)cycles/nrCalls;
+    cout << "  (" << (checksum & 1) << ")" << endl;
+}
+
+void benchmarkBitString()
+{
+    const unsigned int sizes[] = { 64, 320, 1600, 1 << 20 };
+    cout << "Operation                     bits    ns/call   cycles/call" << endl;
+    for(unsigned int i=0; i<sizeof(sizes)/sizeof(sizes[0]); i++) {
+        const unsigned int size = sizes[i];
+        const BitString A(size, 0x5A), B(size, 0xC3), C(size - 3, 0x96);
+        BitString D(A);
+        benchmarkBitStringOperation("copy", size, [&]() {
+            BitString Z(A); return Z.size(); });
+        benchmarkBitStringOperation("A ^ B", size, [&]() {
+            return (A ^ B).size(); });
+        benchmarkBitStringOperation("A ^= B", size, [&]() {
+            D ^= B; return D.size(); });
+        benchmarkBitStringOperation("A || B, aligned", size, [&]() {
+            return (A || B).size(); });
+        benchmarkBitStringOperation("A || B, unaligned", size, [&]() {
+            return (C || B).size(); });
+        benchmarkBitStringOperation("A || 0 || 1", size, [&]() {
+            return (A || 0 || 1).size(); });
+        benchmarkBitStringOperation("A || pad10", size, [&]() {
+            return (C || BitString::pad10(1600, C.size())).size(); });
+        benchmarkBitStringOperation("substring, unaligned", size, [&]() {
+            return BitString::substring(A, 3, size - 64).size(); });
+        benchmarkBitStringOperation("A == B", size, [&]() {
+            return (unsigned int)(A == B); });
+    }
+}
@@ -0,0 +1,74 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _SPONGEBENCHMARK_H_
+#define _SPONGEBENCHMARK_H_
+
+/**
+  * Function that measures the throughput of Sponge::squeeze() when
+  * squeezing 1 GiB from Keccak[r=1344, c=256], for request sizes
+  * ranging from 1 byte to 1 MiB per call.
+  */
+void benchmarkSpongeSqueeze();
+
+/**
+  * Function that measures the number of Duplex::duplexing() calls per second,
+  * with maximum input and output lengths, for the rates used in the duplex KATs.
+  * It compares the allocation-free API working on pointers
+  * with the templated API that appends the output to a vector.
+  */
+void benchmarkDuplexing();
+
+/**
+  * Function that measures the number of messages per second hashed
+  * by Keccak[r=1088, c=512] for message sizes from 0 to 10 KiB,
+  * when looping over Keccak::absorb() and Keccak::squeeze(),
+  * and when using KeccakBatch with one thread or several threads.
+  */
+void benchmarkBatchHashing();
+
+/**
+  * Function that measures the throughput of ShortLeafInterleavedSpongeTree
+  * for several degrees <i>D</i>, in the serial and in the parallel mode.
+  */
+void benchmarkSpongeTree();
+
+/**
+  * Function that compares the throughput of KangarooTwelve, with one thread
+  * and with several threads, with that of Keccak[r=1344, c=256].
+  */
+void benchmarkKangarooTwelve();
+
+/**
+  * Function that compares the throughput of ParallelHash128, with one thread
+  * and with several threads, with that of SHAKE128.
+  */
+void benchmarkParallelHash();
+
+/**
+  * Function that measures the throughput of Kravatte, on the compression side
+  * (input of 1 KiB to 100 MiB, 256-bit output) and on the expansion side
+  * (empty input, output of 1 KiB to 100 MiB), with one thread and with several threads.
+  */
+void benchmarkKravatte();
+
+/**
+  * Function that measures the time per call of the BitString operators
+  * (copy, ^, ^=, || with aligned and unaligned strings, substring and ==),
+  * on strings of 64 bits to 1 Mibit.
+  */
+void benchmarkBitString();
+
+#endif
@@ -0,0 +1,426 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <iostream>
+#include <sstream>
+#include <string.h>
+#include "Keccak.h"
+#include "Keccak-f.h"
+#include "duplex.h"
+#include "sponge.h"
+#include "spongebatch.h"
+#include "spongestream.h"
+#include "spongetree.h"
+#include "sponge-test.h"
+
+using namespace std;
+
+static void fillMessage(vector<UINT8>& message, unsigned int lengthInBits, unsigned int seed)
+{
+    message.resize((lengthInBits+7)/8);
+    for(unsigned int i=0; i<message.size(); i++)
+        message[i] = (UINT8)(seed*97 + i*13 + (i >> 4));
+    if ((lengthInBits % 8) != 0)
+        message.back() &= (1 << (lengthInBits % 8)) - 1;
+}
+
+static void checkBlock(const MessageQueue& queue, const vector<int>& bits, unsigned int blockSize)
+{
+    const UINT8 *block = queue.firstBlock();
+    for(unsigned int i=0; i<blockSize; i++)
+        if (((block[i/8] >> (i%8)) & 1) != bits[i])
+            throw SpongeException("MessageQueue does not give back the appended bits.");
+    if (((blockSize % 8) != 0) && ((block[blockSize/8] >> (blockSize%8)) != 0))
+        throw SpongeException("MessageQueue does not clear the unused bits of a block.");
+}
+
+static void checkMessageQueue(unsigned int blockSize)
+{
+    MessageQueue queue(blockSize);
+    vector<int> bits;
+    vector<UINT8> data(64);
+    for(unsigned int step=0; step<2000; step++) {
+        for(unsigned int i=0; i<data.size(); i++)
+            data[i] = (UINT8)(step*37 + i*11 + (i >> 2));
+        UINT64 word = ((UINT64)data[1] << 56) ^ ((UINT64)data[2] << 24) ^ data[3];
+        unsigned int operation = (step*7) % 5;
+        unsigned int count = (step*13) % 64 + 1;
+        if (count*8 > queue.getFreeSpace())
+            operation = 0;
+        if (operation == 0)
+            queue.appendBit(step & 1);
+        else if (operation == 1)
+            queue.appendByte(data[0]);
+        else if (operation == 2)
+            queue.appendBits(word, count);
+        else if (operation == 3)
+            queue.append(&data[0], count*8 - (step % 8));
+        else
+            queue.appendZeroes(count);
+        unsigned int appended = (operation == 0) ? 1 : (operation == 1) ? 8 : (operation == 3) ? count*8 - (step % 8) : count;
+        for(unsigned int i=0; i<appended; i++) {
+            if (operation == 0)
+                bits.push_back(step & 1);
+            else if (operation == 2)
+                bits.push_back((int)((word >> i) & 1));
+            else if (operation == 4)
+                bits.push_back(0);
+            else
+                bits.push_back((data[i/8] >> (i%8)) & 1);
+        }
+        if ((step % 3) == 0)
+            while(queue.firstBlockIsWhole()) {
+                checkBlock(queue, bits, blockSize);
+                bits.erase(bits.begin(), bits.begin() + blockSize);
+                queue.removeFirstBlock();
+            }
+        if (queue.blockCount() != (bits.size() + blockSize - 1)/blockSize)
+            throw SpongeException("MessageQueue does not count the blocks correctly.");
+    }
+    if ((bits.size() > 0) && (bits.size() < blockSize))
+        checkBlock(queue, bits, (unsigned int)bits.size());
+}
+
+static void referenceSponge(const Transformation& f, const PaddingRule& pad, unsigned int rate,
+    const vector<UINT8>& message, unsigned int lengthInBits, unsigned int nrBlocks, vector<UINT8>& output)
+{
+    vector<UINT8> state((f.getWidth()+7)/8, 0);
+    MessageQueue queue(rate, lengthInBits/rate + 4);
+    queue.append(message.begin(), lengthInBits);
+    queue.pad(pad);
+    while(queue.firstBlockIsWhole()) {
+        const UINT8 *block = queue.firstBlock();
+        for(unsigned int i=0; i<(rate+7)/8; i++)
+            state[i] ^= block[i];
+        f(&state[0]);
+        queue.removeFirstBlock();
+    }
+    output.clear();
+    for(unsigned int i=0; i<nrBlocks; i++) {
+        if (i > 0)
+            f(&state[0]);
+        output.insert(output.end(), state.begin(), state.begin() + (rate+7)/8);
+        if ((rate % 8) != 0)
+            output.back() &= (1 << (rate % 8)) - 1;
+    }
+}
+
+static void checkAbsorb(const Transformation& f, const PaddingRule& pad, unsigned int rate)
+{
+    const unsigned int chunkSizes[] = { 0, 1, 7, 3 };
+    for(unsigned int lengthInBits=0; lengthInBits<=4*rate+13; lengthInBits+=(lengthInBits < 3*rate) ? 37 : 1) {
+        vector<UINT8> message, expected;
+        fillMessage(message, lengthInBits, lengthInBits);
+        referenceSponge(f, pad, rate, message, lengthInBits, 1, expected);
+        for(unsigned int c=0; c<sizeof(chunkSizes)/sizeof(chunkSizes[0]); c++) {
+            // chunkSize == 0 means the whole message at once,
+            // chunkSize == 3 means 3 bytes then the rest
+            Sponge sponge(&f, &pad, rate);
+            unsigned int wholeBytes = lengthInBits/8;
+            unsigned int chunkSize = (chunkSizes[c] == 0) ? wholeBytes : chunkSizes[c];
+            unsigned int i = 0;
+            while((chunkSize > 0) && (i+chunkSize <= wholeBytes)) {
+                sponge.absorb(&message[i], chunkSize*8);
+                i += chunkSize;
+                if (chunkSizes[c] == 3)
+                    chunkSize = wholeBytes - i;
+            }
+            if (i < wholeBytes)
+                sponge.absorb(&message[i], (wholeBytes-i)*8);
+            if ((lengthInBits % 8) != 0)
+                sponge.absorb(&message[wholeBytes], lengthInBits % 8);
+            vector<UINT8> output;
+            sponge.squeeze(output, rate);
+            if (output != expected) {
+                stringstream str;
+                str << "The absorbing of " << dec << lengthInBits << " bits in " << sponge
+                    << " does not match the reference.";
+                throw SpongeException(str.str());
+            }
+        }
+    }
+}
+
+static void checkSqueeze(const Transformation& f, const PaddingRule& pad, unsigned int rate)
+{
+    const unsigned int nrBlocks = 7;
+    vector<UINT8> message, expected;
+    fillMessage(message, 3*rate, rate);
+    referenceSponge(f, pad, rate, message, 3*rate, nrBlocks, expected);
+    const unsigned int chunkSizes[] = { 1, 7, 8, 13, rate/8, rate/8+5, 3*rate/8 };
+    for(unsigned int c=0; c<sizeof(chunkSizes)/sizeof(chunkSizes[0]); c++) {
+        Sponge sponge(&f, &pad, rate);
+        sponge.absorb(message, 3*rate);
+        vector<UINT8> output;
+        if ((rate % 8) == 0) {
+            while(output.size() < expected.size()) {
+                unsigned int chunkSize = chunkSizes[c];
+                if (chunkSize > expected.size() - output.size())
+                    chunkSize = (unsigned int)(expected.size() - output.size());
+                if ((c % 2) == 0)
+                    sponge.squeeze(output, chunkSize*8);
+                else {
+                    vector<UINT8> chunk(chunkSize);
+                    sponge.squeeze(&chunk[0], chunkSize*8);
+                    output.insert(output.end(), chunk.begin(), chunk.end());
+                }
+            }
+        }
+        else
+            for(unsigned int i=0; i<nrBlocks; i++)
+                sponge.squeeze(output, rate);
+        if (output != expected) {
+            stringstream str;
+            str << "The squeezing of " << sponge << " per " << dec << chunkSizes[c]
+                << " bytes does not match the reference.";
+            throw SpongeException(str.str());
+        }
+    }
+}
+
+static void checkSnapshot(const Transformation& f, const PaddingRule& pad, unsigned int rate)
+{
+    vector<UINT8> message;
+    unsigned int messageLength = 3*rate + 43;
+    fillMessage(message, messageLength, rate);
+    unsigned int outputLength = ((rate % 8) == 0) ? ((2*rate + 64)/8)*8 : rate;
+    vector<UINT8> expected;
+    referenceSponge(f, pad, rate, message, messageLength, ((rate % 8) == 0) ? outputLength/rate + 1 : 1, expected);
+    expected.resize((outputLength+7)/8);
+    const unsigned int splits[] = { 0, 8, 64, (rate/8)*8, ((rate+8)/8)*8, ((2*rate)/8)*8 };
+    for(unsigned int i=0; i<sizeof(splits)/sizeof(splits[0]); i++) {
+        // Absorb a prefix, checkpoint through a stream, and finish in another object
+        unsigned int split = splits[i];
+        Sponge first(&f, &pad, rate);
+        first.absorb(message, split);
+        stringstream stream;
+        first.snapshot().save(stream);
+        SpongeSnapshot loaded;
+        loaded.load(stream);
+        Sponge second(&f, &pad, rate);
+        second.absorb(message, 8);
+        second.restore(loaded);
+        vector<UINT8> rest(message.begin() + split/8, message.end());
+        second.absorb(rest, messageLength - split);
+        Sponge fork(second);
+        vector<UINT8> output;
+        second.squeeze(output, outputLength);
+        vector<UINT8> forkOutput;
+        fork.squeeze(forkOutput, outputLength);
+        if ((output != expected) || (forkOutput != expected)) {
+            stringstream str;
+            str << "Restoring a snapshot of " << second << " taken after " << dec << split
+                << " bits does not give the same output.";
+            throw SpongeException(str.str());
+        }
+    }
+    if ((rate % 8) == 0) {
+        // Checkpoint in the middle of the squeezing phase
+        Sponge first(&f, &pad, rate);
+        first.absorb(message, messageLength);
+        vector<UINT8> output;
+        first.squeeze(output, 8);
+        SpongeSnapshot snapshot;
+        first.snapshot(snapshot);
+        for(int j=0; j<2; j++) {
+            Sponge second(&f, &pad, rate);
+            second.restore(snapshot);
+            vector<UINT8> rest(output);
+            second.squeeze(rest, outputLength - 8);
+            if (rest != expected)
+                throw SpongeException("Restoring a snapshot in the squeezing phase does not give the same output.");
+        }
+    }
+}
+
+static void checkDuplex(const Transformation& f, const PaddingRule& pad, unsigned int rate)
+{
+    Duplex inPlace(&f, &pad, rate);
+    Duplex reference(&f, &pad, rate);
+    unsigned int maxInput = inPlace.getMaximumInputLength();
+    unsigned int maxOutput = inPlace.getMaximumOutputLength();
+    const unsigned int inputLengths[] = { 0, 1, 7, 8, 9, 63, 64, maxInput-8, maxInput-1, maxInput };
+    for(unsigned int i=0; i<sizeof(inputLengths)/sizeof(inputLengths[0]); i++) {
+        unsigned int inputLength = inputLengths[i];
+        if ((inputLength > maxInput) || (pad.getPaddedSize(rate, inputLength) != rate))
+            continue;
+        unsigned int outputLength = (maxOutput*(i+1))/10;
+        vector<UINT8> input;
+        fillMessage(input, inputLength, i);
+        vector<UINT8> output((outputLength+7)/8, 0xFF);
+        vector<UINT8> expected;
+        inPlace.duplexing(input.empty() ? 0 : &input[0], inputLength, output.empty() ? 0 : &output[0], outputLength);
+        reference.duplexing(input.begin(), inputLength, expected, outputLength);
+        if (output != expected) {
+            stringstream str;
+            str << "The duplexing call of " << inPlace << " with " << dec << inputLength
+                << " input bits does not match the reference.";
+            throw DuplexException(str.str());
+        }
+        if (((inputLength % 8) == 0) && (pad.getPaddedSize(rate, inputLength+3) == rate)) {
+            vector<UINT8> Z((outputLength/8), 0xFF);
+            vector<UINT8> expectedZ;
+            inPlace.duplexingBytes(input.empty() ? 0 : &input[0], inputLength/8, 0x0B, Z.empty() ? 0 : &Z[0], Z.size());
+            reference.duplexingBytes(input.begin(), input.end(), 0x0B, expectedZ, Z.size());
+            if (Z != expectedZ) {
+                stringstream str;
+                str << "The duplexingBytes call of " << inPlace << " with " << dec << inputLength/8
+                    << " input bytes does not match the reference.";
+                throw DuplexException(str.str());
+            }
+        }
+    }
+}
+
+static void checkBatch(const Transformation& f, const PaddingRule& pad, unsigned int rate)
+{
+    const unsigned int nrMessages = 2000;
+    vector<vector<UINT8> > messages(nrMessages);
+    vector<unsigned int> lengthsInBits(nrMessages);
+    for(unsigned int i=0; i<nrMessages; i++) {
+        lengthsInBits[i] = (i*7919 + (i >> 3)) % (3*rate + 17);
+        fillMessage(messages[i], lengthsInBits[i], i);
+    }
+    const unsigned int outputLengths[] = { 0, 256, (rate/8)*8, ((2*rate+100)/8)*8 };
+    for(unsigned int o=0; o<sizeof(outputLengths)/sizeof(outputLengths[0]); o++) {
+        unsigned int outputLength = ((rate % 8) == 0) ? outputLengths[o] : rate;
+        Sponge sponge(&f, &pad, rate);
+        vector<vector<UINT8> > expected(nrMessages);
+        for(unsigned int i=0; i<nrMessages; i++) {
+            sponge.reset();
+            sponge.absorb(messages[i], lengthsInBits[i]);
+            sponge.squeeze(expected[i], outputLength);
+        }
+        for(int multiThreaded=0; multiThreaded<2; multiThreaded++) {
+            SpongeBatch batch(&f, &pad, rate, multiThreaded != 0);
+            vector<vector<UINT8> > digests;
+            batch.hash(messages, lengthsInBits, outputLength, digests);
+            if (digests != expected) {
+                stringstream str;
+                str << "The hashing by " << batch << " of " << dec << nrMessages
+                    << " messages does not match Sponge.";
+                throw SpongeException(str.str());
+            }
+        }
+    }
+}
+
+class KeccakFactory : public SpongeFactory {
+public:
+    Sponge* newSponge() const { return new Keccak(1088, 512); }
+};
+
+static void checkSpongeTree(int D, int B)
+{
+    KeccakFactory factory;
+    vector<UINT8> message;
+    unsigned int messageLength = 8*(1 << 18) + 5;
+    fillMessage(message, messageLength, D+B);
+    const unsigned int chunkSizes[] = { 1, 13, 4096, 1 << 18 };
+    vector<UINT8> expected;
+    {
+        ShortLeafInterleavedSpongeTree tree(factory, D, B);
+        tree.absorb(message, messageLength);
+        tree.squeeze(expected, 512);
+    }
+    for(unsigned int c=0; c<sizeof(chunkSizes)/sizeof(chunkSizes[0]); c++) {
+        ShortLeafInterleavedSpongeTree tree(factory, D, B, true);
+        unsigned int offset = 0;
+        while(offset < messageLength/8) {
+            unsigned int count = min(chunkSizes[c], messageLength/8 - offset);
+            tree.absorb(&message[offset], count*8);
+            offset += count;
+        }
+        tree.absorb(&message[offset], messageLength % 8);
+        vector<UINT8> output;
+        tree.squeeze(output, 512);
+        if (output != expected) {
+            stringstream str;
+            str << "The parallel tree with D=" << dec << D << " and B=" << B
+                << " does not match the serial one when absorbing per " << chunkSizes[c] << " bytes.";
+            throw SpongeException(str.str());
+        }
+    }
+}
+
+static void checkStream()
+{
+    const unsigned int bufferSize = 1000;
+    vector<UINT8> message;
+    fillMessage(message, 5*bufferSize*8+24, 11);
+    FILE *file = tmpfile();
+    if (file == 0)
+        throw SpongeException("Cannot create a temporary file.");
+    fwrite(&message[0], 1, message.size(), file);
+
+    // Reading through the double buffer gives the same output as absorbing at once
+    Keccak reference(1344, 256), streamed(1344, 256);
+    reference.absorb(&message[0], (unsigned int)message.size()*8);
+    SpongeStream stream(streamed, bufferSize);
+    rewind(file);
+    stream.absorbStream(file);
+    vector<UINT8> expected(32), output(32);
+    reference.squeeze(&expected[0], 256);
+    streamed.squeeze(&output[0], 256);
+    if (expected != output)
+        throw SpongeException("SpongeStream::absorbStream() does not match Sponge::absorb().");
+
+    // An exception from the sponge is propagated once the reader thread is joined
+    bool thrown = false;
+    rewind(file);
+    try {
+        stream.absorbStream(file);
+    }
+    catch(SpongeException&) {
+        thrown = true;
+    }
+    fclose(file);
+    if (!thrown)
+        throw SpongeException("SpongeStream::absorbStream() does not report absorbing after squeezing.");
+}
+
+void testSpongeImplementations()
+{
+    const unsigned int blockSizes[] = { 1, 7, 8, 13, 64, 72, 1026, 1088 };
+    for(unsigned int i=0; i<sizeof(blockSizes)/sizeof(blockSizes[0]); i++)
+        checkMessageQueue(blockSizes[i]);
+    cout << "MessageQueue: OK" << endl;
+    KeccakF keccakF(1600);
+    SimplePadding simplePadding;
+    MultiRatePadding multiRatePadding;
+    OldDiversifiedKeccakPadding oldPadding(0x01);
+    const PaddingRule *pads[] = { &simplePadding, &multiRatePadding, &oldPadding };
+    const unsigned int rates[] = { 8, 64, 72, 576, 1026, 1088, 1344, 1599 };
+    for(unsigned int p=0; p<sizeof(pads)/sizeof(pads[0]); p++) {
+        for(unsigned int r=0; r<sizeof(rates)/sizeof(rates[0]); r++) {
+            if (!pads[p]->isRateValid(rates[r]))
+                continue;
+            checkAbsorb(keccakF, *pads[p], rates[r]);
+            checkSqueeze(keccakF, *pads[p], rates[r]);
+            checkDuplex(keccakF, *pads[p], rates[r]);
+            checkBatch(keccakF, *pads[p], rates[r]);
+            checkSnapshot(keccakF, *pads[p], rates[r]);
+        }
+        cout << "Sponge, SpongeBatch and Duplex[f=" << keccakF << ", pad=" << (*pads[p]) << "]: OK" << endl;
+    }
+    const int degrees[] = { 1, 3, 4, 8 };
+    const int treeBlockSizes[] = { 8, 1001, 2176, 65536 };
+    for(unsigned int d=0; d<sizeof(degrees)/sizeof(degrees[0]); d++)
+        for(unsigned int b=0; b<sizeof(treeBlockSizes)/sizeof(treeBlockSizes[0]); b++)
+            checkSpongeTree(degrees[d], treeBlockSizes[b]);
+    cout << "ShortLeafInterleavedSpongeTree, parallel mode: OK" << endl;
+    checkStream();
+    cout << "SpongeStream: OK" << endl;
+}
@@ -0,0 +1,35 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _SPONGETEST_H_
+#define _SPONGETEST_H_
+
+/**
+  * Function that checks that MessageQueue gives back the bits appended to it,
+  * and that the Sponge class gives the same results
+  * as a straightforward reference built on MessageQueue, for several
+  * padding rules and rates, and whatever the way the input and output
+  * are split into calls to Sponge::absorb() and Sponge::squeeze(),
+  * or interrupted by a SpongeSnapshot saved, loaded and restored.
+  * It also checks that SpongeBatch gives the same digests as Sponge,
+  * that the parallel mode of ShortLeafInterleavedSpongeTree gives
+  * the same output as the serial one,
+  * and that the pointer-based Duplex::duplexing() and
+  * Duplex::duplexingBytes() give the same outputs as their templated variants.
+  * It throws a SpongeException or a DuplexException in case of mismatch.
+  */
+void testSpongeImplementations();
+
+#endif
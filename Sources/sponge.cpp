@@ -21,7 +21,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 using namespace std;
 
 Sponge::Sponge(const Transformation *aF, const PaddingRule *aPad, unsigned int aRate)
-    : f(aF), pad(aPad), rate(aRate), squeezing(false), absorbQueue(rate)
+    : f(aF), pad(aPad), rate(aRate), squeezing(false), absorbQueue(rate), squeezeOffset(0)
 {
     unsigned int width = f->getWidth();
     if (rate <= 0)
@@ -38,12 +38,14 @@ Sponge::Sponge(const Transformation *aF, const PaddingRule *aPad, unsigned int a
 
 Sponge::Sponge(const Sponge& other)
     : f(other.f), pad(other.pad), capacity(other.capacity), rate(other.rate),
-        squeezing(other.squeezing), absorbQueue(other.absorbQueue),
-        squeezeBuffer(other.squeezeBuffer)
+        squeezing(other.squeezing), absorbQueue(other.rate),
+        squeezeOffset(other.squeezeOffset)
 {
     unsigned int width = f->getWidth();
     state.reset(new UINT8[(width+7)/8]);
     memcpy(state.get(), other.state.get(), (width+7)/8);
+    // Between calls to absorb(), the queue holds at most a partial block.
+    absorbQueue.append(other.absorbQueue.firstBlock(), other.absorbQueue.lastBlockSize());
 }
 
 unsigned int Sponge::getCapacity()
@@ -63,14 +65,78 @@ void Sponge::reset()
     for(unsigned int i=0; i<(width+7)/8; i++)
         state.get()[i] = 0;
     absorbQueue.clear();
-    squeezeBuffer.clear();
+    squeezeOffset = 0;
+}
+
+void Sponge::snapshot(SpongeSnapshot& snapshot) const
+{
+    unsigned int stateSize = (f->getWidth()+7)/8;
+    snapshot.description = getDescription();
+    snapshot.state.assign(state.get(), state.get() + stateSize);
+    snapshot.pendingLengthInBits = absorbQueue.lastBlockSize();
+    snapshot.pendingBits.assign(absorbQueue.firstBlock(), absorbQueue.firstBlock() + (snapshot.pendingLengthInBits+7)/8);
+    snapshot.squeezing = squeezing;
+    snapshot.squeezeOffset = squeezeOffset;
+}
+
+SpongeSnapshot Sponge::snapshot() const
+{
+    SpongeSnapshot result;
+    snapshot(result);
+    return result;
+}
+
+void Sponge::restore(const SpongeSnapshot& snapshot)
+{
+    if (snapshot.description != getDescription())
+        throw SpongeException("The snapshot was taken from a different sponge function.");
+    unsigned int stateSize = (f->getWidth()+7)/8;
+    if ((snapshot.state.size() != stateSize)
+            || (snapshot.pendingLengthInBits >= rate)
+            || (snapshot.pendingBits.size() != (snapshot.pendingLengthInBits+7)/8)
+            || (snapshot.squeezing && (snapshot.pendingLengthInBits > 0))
+            || (snapshot.squeezeOffset > (rate+7)/8))
+        throw SpongeException("The snapshot is inconsistent.");
+    memcpy(state.get(), &snapshot.state[0], stateSize);
+    absorbQueue.clear();
+    if (snapshot.pendingLengthInBits > 0)
+        absorbQueue.append(&snapshot.pendingBits[0], snapshot.pendingLengthInBits);
+    squeezing = snapshot.squeezing;
+    squeezeOffset = snapshot.squeezeOffset;
 }
 
 void Sponge::absorb(const UINT8 *input, unsigned int lengthInBits)
 {
-    unsigned int lengthInBytes = (lengthInBits+7)/8;
-    vector<UINT8> inputAsVector(input, input+lengthInBytes);
-    absorb(inputAsVector, lengthInBits);
+    if (lengthInBits == 0)
+        return;
+    if (squeezing)
+        throw SpongeException("The absorbing phase is over.");
+    while(lengthInBits > 0) {
+        if (((rate % 8) == 0) && (absorbQueue.blockCount() == 0) && (lengthInBits >= rate)) {
+            // Fast path: a whole block is absorbed directly from the input
+            xorIntoState(input, rate/8);
+            (*f)(state.get());
+            input += rate/8;
+            lengthInBits -= rate;
+        }
+        else {
+            unsigned int count = lengthInBits;
+            if (((rate % 8) == 0) && ((absorbQueue.lastBlockSize() % 8) == 0)) {
+                // Only complete the pending block, so that the fast path can resume
+                if (count > rate - absorbQueue.lastBlockSize())
+                    count = rate - absorbQueue.lastBlockSize();
+            }
+            else if (count > absorbQueue.getFreeSpace())
+                count = absorbQueue.getFreeSpace() - (absorbQueue.getFreeSpace() % 8);
+            absorbQueue.append(input, count);
+            input += count/8;
+            lengthInBits -= count;
+            while(absorbQueue.firstBlockIsWhole()) {
+                absorbBlock(absorbQueue.firstBlock());
+                absorbQueue.removeFirstBlock();
+            }
+        }
+    }
 }
 
 void Sponge::absorb(const vector<UINT8>& input, unsigned int lengthInBits)
@@ -80,74 +146,77 @@ void Sponge::absorb(const vector<UINT8>& input, unsigned int lengthInBits)
     unsigned int lengthInBytes = (lengthInBits+7)/8;
     if (input.size() < lengthInBytes)
         throw SpongeException("The given input length is inconsistent.");
-    if (squeezing)
-        throw SpongeException("The absorbing phase is over.");
-    absorbQueue.append(input.begin(), lengthInBits);
-    while(absorbQueue.firstBlockIsWhole()) {
-        absorbBlock(absorbQueue.firstBlock());
-        absorbQueue.removeFirstBlock();
-    }
+    absorb(&input[0], lengthInBits);
 }
 
-void Sponge::absorbBlock(const vector<UINT8>& block)
+void Sponge::absorbBlock(const UINT8 *block)
 {
-    for(vector<UINT8>::size_type i=0; i<block.size(); ++i)
-        state.get()[i] ^= block[i];
+    xorIntoState(block, (rate+7)/8);
     (*f)(state.get());
 }
 
-void Sponge::squeeze(UINT8 *output, unsigned int desiredLengthInBits)
+void Sponge::xorIntoState(const UINT8 *data, unsigned int lengthInBytes)
 {
-    vector<UINT8> outputAsVector;
-    squeeze(outputAsVector, desiredLengthInBits);
-    for(unsigned int i=0; i<outputAsVector.size(); i++)
-        output[i] = outputAsVector[i];
+    UINT8 *s = state.get();
+    unsigned int i = 0;
+    for( ; i+8<=lengthInBytes; i+=8) {
+        UINT64 lane, dataLane;
+        memcpy(&lane, s+i, 8);
+        memcpy(&dataLane, data+i, 8);
+        lane ^= dataLane;
+        memcpy(s+i, &lane, 8);
+    }
+    for( ; i<lengthInBytes; i++)
+        s[i] ^= data[i];
 }
 
-void Sponge::squeeze(vector<UINT8>& output, unsigned int desiredLengthInBits)
+void Sponge::squeeze(UINT8 *output, unsigned int desiredLengthInBits)
 {
-	if (!squeezing)
+    if (!squeezing)
         flushAndSwitchToSqueezingPhase();
+    unsigned int blockSizeInBytes = (rate+7)/8;
     if ((rate % 8) == 0) {
         if ((desiredLengthInBits % 8) != 0)
             throw SpongeException("The desired output length must be a multiple of 8.");
         unsigned int desiredLengthInBytes = desiredLengthInBits / 8;
         while(desiredLengthInBytes > 0) {
-            if (squeezeBuffer.size() == 0)
-                squeezeIntoBuffer();
-            while((desiredLengthInBytes > 0) && (squeezeBuffer.size() > 0)) {
-                output.push_back(squeezeBuffer.front());
-                desiredLengthInBytes--;
-                squeezeBuffer.pop_front();
+            if (squeezeOffset == blockSizeInBytes) {
+                (*f)(state.get());
+                squeezeOffset = 0;
             }
+            unsigned int count = blockSizeInBytes - squeezeOffset;
+            if (count > desiredLengthInBytes)
+                count = desiredLengthInBytes;
+            memcpy(output, state.get() + squeezeOffset, count);
+            output += count;
+            squeezeOffset += count;
+            desiredLengthInBytes -= count;
         }
     }
     else {
         if (desiredLengthInBits != rate)
             throw SpongeException("The desired output length must be equal to the rate.");
-        if (squeezeBuffer.size() == 0)
-            squeezeIntoBuffer();
-        while(squeezeBuffer.size() > 0) {
-            output.push_back(squeezeBuffer.front());
-            squeezeBuffer.pop_front();
-        }
+        if (squeezeOffset == blockSizeInBytes)
+            (*f)(state.get());
+        memcpy(output, state.get(), blockSizeInBytes);
+        output[blockSizeInBytes-1] &= (1 << (rate % 8)) - 1;
+        squeezeOffset = blockSizeInBytes;
     }
 }
 
-void Sponge::squeezeIntoBuffer()
-{
-    (*f)(state.get());
-    fromStateToSqueezeBuffer();
-}
-
-void Sponge::fromStateToSqueezeBuffer()
+void Sponge::squeeze(vector<UINT8>& output, unsigned int desiredLengthInBits)
 {
-    for(unsigned int i=0; i<rate/8; ++i)
-        squeezeBuffer.push_back(state.get()[i]);
-    if ((rate % 8) != 0) {
-        UINT8 lastByte = (state.get())[rate/8];
-        UINT8 mask = (1 << (rate % 8)) - 1;
-        squeezeBuffer.push_back(lastByte & mask);
+    if (!squeezing)
+        flushAndSwitchToSqueezingPhase();
+    vector<UINT8>::size_type previousSize = output.size();
+    unsigned int lengthInBytes = ((rate % 8) == 0) ? desiredLengthInBits/8 : (rate+7)/8;
+    output.resize(previousSize + lengthInBytes);
+    try {
+        squeeze((lengthInBytes > 0) ? &output[previousSize] : (UINT8*)0, desiredLengthInBits);
+    }
+    catch(SpongeException&) {
+        output.resize(previousSize);
+        throw;
     }
 }
 
@@ -159,7 +228,7 @@ void Sponge::flushAndSwitchToSqueezingPhase()
         absorbQueue.removeFirstBlock();
     }
     squeezing = true;
-    fromStateToSqueezeBuffer();
+    squeezeOffset = 0;
 }
 
 string Sponge::getDescription() const
@@ -175,3 +244,66 @@ ostream& operator<<(ostream& a, const Sponge& sponge)
 {
     return a << sponge.getDescription();
 }
+
+static const char spongeSnapshotMagic[4] = { 'K', 'T', 'S', 'S' };
+static const UINT8 spongeSnapshotVersion = 1;
+
+static void writeUINT32(ostream& out, unsigned int value)
+{
+    UINT8 bytes[4] = { (UINT8)value, (UINT8)(value >> 8), (UINT8)(value >> 16), (UINT8)(value >> 24) };
+    out.write((const char*)bytes, 4);
+}
+
+static unsigned int readUINT32(istream& in)
+{
+    UINT8 bytes[4];
+    if (!in.read((char*)bytes, 4))
+        throw SpongeException("The sponge snapshot is truncated.");
+    return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
+
+static void readBytes(istream& in, unsigned int length, string& bytes)
+{
+    if (length > (1 << 16))
+        throw SpongeException("The sponge snapshot is invalid.");
+    bytes.resize(length);
+    if ((length > 0) && !in.read(&bytes[0], length))
+        throw SpongeException("The sponge snapshot is truncated.");
+}
+
+void SpongeSnapshot::save(ostream& out) const
+{
+    out.write(spongeSnapshotMagic, sizeof(spongeSnapshotMagic));
+    out.put((char)spongeSnapshotVersion);
+    writeUINT32(out, (unsigned int)description.size());
+    out.write(description.data(), description.size());
+    writeUINT32(out, (unsigned int)state.size());
+    out.write((const char*)state.data(), state.size());
+    writeUINT32(out, pendingLengthInBits);
+    out.write((const char*)pendingBits.data(), pendingBits.size());
+    out.put(squeezing ? 1 : 0);
+    writeUINT32(out, squeezeOffset);
+    if (!out)
+        throw SpongeException("The sponge snapshot could not be written.");
+}
+
+void SpongeSnapshot::load(istream& in)
+{
+    char magic[sizeof(spongeSnapshotMagic)];
+    if (!in.read(magic, sizeof(magic)) || (memcmp(magic, spongeSnapshotMagic, sizeof(magic)) != 0))
+        throw SpongeException("The data is not a sponge snapshot.");
+    if (in.get() != spongeSnapshotVersion)
+        throw SpongeException("The version of the sponge snapshot is not supported.");
+    readBytes(in, readUINT32(in), description);
+    string bytes;
+    readBytes(in, readUINT32(in), bytes);
+    state.assign(bytes.begin(), bytes.end());
+    pendingLengthInBits = readUINT32(in);
+    readBytes(in, (pendingLengthInBits+7)/8, bytes);
+    pendingBits.assign(bytes.begin(), bytes.end());
+    int squeezingFlag = in.get();
+    if ((squeezingFlag != 0) && (squeezingFlag != 1))
+        throw SpongeException("The sponge snapshot is invalid.");
+    squeezing = (squeezingFlag == 1);
+    squeezeOffset = readUINT32(in);
+}
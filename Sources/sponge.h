@@ -16,7 +16,6 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #ifndef _SPONGE_H_
 #define _SPONGE_H_
 
-#include <deque>
 #include <iostream>
 #include <memory>
 #include "padding.h"
@@ -27,6 +26,42 @@ using namespace std;
 
 typedef Exception SpongeException;
 
+/**
+  * Class that contains what is needed to resume a Sponge object:
+  * the raw state, the bits absorbed since the last complete block,
+  * and the position in the output stream.
+  * It can be saved to and loaded from a stream in a compact binary form,
+  * e.g., to checkpoint a long absorbing phase across process restarts,
+  * or restored any number of times to hash messages sharing a common prefix.
+  */
+class SpongeSnapshot {
+public:
+    /** The description of the sponge function, to check that the snapshot
+      * is restored into the same kind of sponge function. */
+    string description;
+    /** The state of the sponge function. */
+    vector<UINT8> state;
+    /** The bits absorbed since the last complete block. */
+    vector<UINT8> pendingBits;
+    /** The number of bits in pendingBits. */
+    unsigned int pendingLengthInBits;
+    /** Whether the sponge function is in the squeezing phase. */
+    bool squeezing;
+    /** The number of bytes already squeezed from the current block. */
+    unsigned int squeezeOffset;
+public:
+    SpongeSnapshot() : pendingLengthInBits(0), squeezing(false), squeezeOffset(0) {}
+    /**
+      * Method that writes the snapshot to @a out in binary form.
+      */
+    void save(ostream& out) const;
+    /**
+      * Method that reads a snapshot written by save() from @a in.
+      * It throws a SpongeException if the data is not a valid snapshot.
+      */
+    void load(istream& in);
+};
+
 /**
   * Class implementing the sponge construction.
   * This class uses a given transformation (inherited from class
@@ -61,8 +96,11 @@ protected:
     auto_ptr<UINT8> state;
     /** The message blocks not yet absorbed. */
     MessageQueue absorbQueue;
-    /** Buffer containing the partial block that is being squeezed. */
-    deque<UINT8> squeezeBuffer;
+    /** In the squeezing phase, the number of bytes of the current output
+      * block, still in the state, that were already given out.
+      * When equal to the block size in bytes, the state must be
+      * permuted before squeezing further. */
+    unsigned int squeezeOffset;
 public:
     /**
       * The constructor. The transformation, padding rule and rate are given to the
@@ -79,7 +117,10 @@ public:
       */
     Sponge(const Transformation *aF, const PaddingRule *aPad, unsigned int aRate);
     /**
-      * The copy constructor.
+      * The copy constructor. It copies only the state, the bits absorbed
+      * since the last complete block and the position in the output stream,
+      * so it can be used to fork a sponge function after a common prefix.
+      * The transformation and the padding rule are shared with @a other.
       * @param  other   A reference to the object to copy from.
       */
     Sponge(const Sponge& other);
@@ -89,6 +130,21 @@ public:
     virtual ~Sponge(void) {}
     /** Method to reset the sponge to the initial state. */
     void reset();
+    /**
+      * Method that stores the current state of the sponge function in
+      * @a snapshot. It reuses the memory already allocated in @a snapshot.
+      */
+    void snapshot(SpongeSnapshot& snapshot) const;
+    /**
+      * Method that returns the current state of the sponge function.
+      */
+    SpongeSnapshot snapshot() const;
+    /**
+      * Method that sets the sponge function to the state stored in @a snapshot,
+      * which must come from a sponge function with the same description.
+      * The same snapshot can be restored any number of times.
+      */
+    void restore(const SpongeSnapshot& snapshot);
     /**
       * Method that absorbs data. The data is given as a sequence of bytes.
       * Within each byte, the bits are understood to be ordered from the
@@ -102,6 +158,11 @@ public:
       * @param  lengthInBits    The length in bits of the data provided in
       *                     input. When lengthInBits is not a multiple
       *                     of 8, this function can no longer be used.
+      *
+      * When the rate is a multiple of 8 and no partial block is pending,
+      * the whole blocks are XORed directly from @a input into the state,
+      * and only the remaining bits are queued. Otherwise, the input is
+      * queued in pieces that fit in absorbQueue.
       */
     void absorb(const UINT8 *input, unsigned int lengthInBits);
     /**
@@ -128,6 +189,9 @@ public:
       *                     If the rate of the sponge is a multiple of 8,
       *                     @a desiredOutputLength must be a multiple of 8.
       *                     Otherwise, @a desiredOutputLength must be equal to the rate.
+      *
+      * The output is copied directly from the state; only the position
+      * within the current block is kept between calls.
       */
     void squeeze(UINT8 *output, unsigned int desiredLengthInBits);
     /**
@@ -161,23 +225,21 @@ protected:
     /**
       * Internal method that does the actual absorbing of the whole block
       * in @a block.
-      * @param  block  A block to absorb.
+      * @param  block  A block of ceil(rate/8) bytes to absorb.
       */
-    void absorbBlock(const vector<UINT8>& block);
+    void absorbBlock(const UINT8 *block);
+    /**
+      * Internal method that XORs bytes into the beginning of the state,
+      * 8 bytes at a time when possible.
+      * @param  data            The bytes to XOR into the state.
+      * @param  lengthInBytes   The number of bytes in @a data.
+      */
+    void xorIntoState(const UINT8 *data, unsigned int lengthInBytes);
     /**
       * Internal method that absorbs the data still in absorbQueue,
       * and then switches the sponge function to the squeezing phase.
       */
     void flushAndSwitchToSqueezingPhase();
-    /**
-      * Internal method that does the actual squeezing and stores the whole
-      * squeezed block into squeezeBuffer.
-      */
-    void squeezeIntoBuffer();
-    /**
-      * Internal method that copies a block from state to squeezeBuffer.
-      */
-    void fromStateToSqueezeBuffer();
 };
 
 #endif
@@ -0,0 +1,259 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <algorithm>
+#include <sstream>
+#include <string.h>
+#include "Keccak-fAutotune.h"
+#include "spongebatch.h"
+#include "threads.h"
+
+using namespace std;
+
+SpongeBatch::SpongeBatch(const Transformation *aF, const PaddingRule *aPad, unsigned int aRate, bool aMultiThreaded)
+    : f(aF), pad(aPad), rate(aRate), multiThreaded(aMultiThreaded)
+{
+    if (rate <= 0)
+        throw SpongeException("The requested rate must be strictly positive.");
+    if (rate > f->getWidth())
+        throw SpongeException("The requested rate is too large when using this function.");
+    if (!pad->isRateValid(rate))
+        throw SpongeException("The requested rate is incompatible with the padding rule.");
+}
+
+void SpongeBatch::hash(const vector<vector<UINT8> >& messages, unsigned int outputLengthInBits, vector<vector<UINT8> >& digests) const
+{
+    vector<unsigned int> messageLengthsInBits(messages.size());
+    for(unsigned int i=0; i<messages.size(); i++)
+        messageLengthsInBits[i] = (unsigned int)messages[i].size()*8;
+    hash(messages, messageLengthsInBits, outputLengthInBits, digests);
+}
+
+static void xorBytes(UINT8 *state, const UINT8 *data, unsigned int lengthInBytes)
+{
+    unsigned int i = 0;
+    for( ; i+8<=lengthInBytes; i+=8) {
+        UINT64 lane, dataLane;
+        memcpy(&lane, state+i, 8);
+        memcpy(&dataLane, data+i, 8);
+        lane ^= dataLane;
+        memcpy(state+i, &lane, 8);
+    }
+    for( ; i<lengthInBytes; i++)
+        state[i] ^= data[i];
+}
+
+void SpongeBatch::hash(const vector<vector<UINT8> >& messages, const vector<unsigned int>& messageLengthsInBits,
+    unsigned int outputLengthInBits, vector<vector<UINT8> >& digests) const
+{
+    if (messageLengthsInBits.size() != messages.size())
+        throw SpongeException("There must be one length per message.");
+    for(unsigned int i=0; i<messages.size(); i++)
+        if (messages[i].size() < (messageLengthsInBits[i]+7)/8)
+            throw SpongeException("The given input length is inconsistent.");
+    if ((rate % 8) != 0) {
+        hashWithSponges(messages, messageLengthsInBits, outputLengthInBits, digests);
+        return;
+    }
+    if ((outputLengthInBits % 8) != 0)
+        throw SpongeException("The desired output length must be a multiple of 8.");
+
+    // Sort the messages by number of blocks, so that the states of a batch
+    // are permuted together as long as possible.
+    unsigned int nrMessages = (unsigned int)messages.size();
+    vector<unsigned int> blockCounts(nrMessages);
+    vector<unsigned int> order(nrMessages);
+    UINT64 totalBlockCount = 0;
+    for(unsigned int i=0; i<nrMessages; i++) {
+        blockCounts[i] = pad->getPaddedSize(rate, messageLengthsInBits[i])/rate;
+        totalBlockCount += blockCounts[i];
+        order[i] = i;
+    }
+    stable_sort(order.begin(), order.end(),
+        [&blockCounts](unsigned int a, unsigned int b) { return blockCounts[a] < blockCounts[b]; });
+    digests.resize(nrMessages);
+    for(unsigned int i=0; i<nrMessages; i++)
+        digests[i].resize(outputLengthInBits/8);
+
+    auto processBatches = [&](UINT64 firstBatch, UINT64 endBatch) {
+        const unsigned int rateInBytes = rate/8;
+        const unsigned int outputLengthInBytes = outputLengthInBits/8;
+        const unsigned int stateSizeInWords = (f->getWidth()+63)/64;
+        vector<UINT64> stateStorage(batchSize*stateSizeInWords);
+        UINT8 *states[batchSize];
+        UINT8 *activeStates[batchSize];
+        vector<UINT8> tails[batchSize];
+        unsigned int wholeBlocks[batchSize];
+        MessageQueue queue(rate);
+        for(UINT64 batch=firstBatch; batch<endBatch; batch++) {
+            unsigned int first = (unsigned int)batch*batchSize;
+            unsigned int nrLanes = nrMessages - first;
+            if (nrLanes > batchSize)
+                nrLanes = batchSize;
+            // The whole blocks are read directly from the messages,
+            // while the last bits and the padding are put in a tail.
+            for(unsigned int lane=0; lane<nrLanes; lane++) {
+                unsigned int index = order[first+lane];
+                unsigned int lengthInBits = messageLengthsInBits[index];
+                const UINT8 *message = messages[index].empty() ? 0 : &messages[index][0];
+                states[lane] = (UINT8*)&stateStorage[lane*stateSizeInWords];
+                memset(states[lane], 0, stateSizeInWords*8);
+                wholeBlocks[lane] = lengthInBits/rate;
+                queue.clear();
+                queue.append(message + wholeBlocks[lane]*rateInBytes, lengthInBits % rate);
+                queue.pad(*pad);
+                tails[lane].clear();
+                while(queue.firstBlockIsWhole()) {
+                    tails[lane].insert(tails[lane].end(), queue.firstBlock(), queue.firstBlock() + rateInBytes);
+                    queue.removeFirstBlock();
+                }
+            }
+            for(unsigned int block=0; block<blockCounts[order[first+nrLanes-1]]; block++) {
+                unsigned int nrActive = 0;
+                for(unsigned int lane=0; lane<nrLanes; lane++) {
+                    unsigned int index = order[first+lane];
+                    if (block >= blockCounts[index])
+                        continue;
+                    const UINT8 *data = (block < wholeBlocks[lane])
+                        ? &messages[index][block*rateInBytes]
+                        : &tails[lane][(block - wholeBlocks[lane])*rateInBytes];
+                    xorBytes(states[lane], data, rateInBytes);
+                    activeStates[nrActive++] = states[lane];
+                }
+                f->permuteN(activeStates, nrActive);
+            }
+            unsigned int offset = 0;
+            while(offset < outputLengthInBytes) {
+                if (offset > 0)
+                    f->permuteN(states, nrLanes);
+                unsigned int count = min(rateInBytes, outputLengthInBytes - offset);
+                for(unsigned int lane=0; lane<nrLanes; lane++)
+                    memcpy(&digests[order[first+lane]][offset], states[lane], count);
+                offset += count;
+            }
+        }
+    };
+    UINT64 nrBatches = (nrMessages + batchSize - 1)/batchSize;
+    if (multiThreaded && (totalBlockCount >= (UINT64)minimumBlocksPerThread*getNumberOfThreads()))
+        parallelFor(0, nrBatches, processBatches);
+    else
+        processBatches(0, nrBatches);
+}
+
+void SpongeBatch::hashWithSponges(const vector<vector<UINT8> >& messages, const vector<unsigned int>& messageLengthsInBits,
+    unsigned int outputLengthInBits, vector<vector<UINT8> >& digests) const
+{
+    Sponge sponge(f, pad, rate);
+    digests.resize(messages.size());
+    for(unsigned int i=0; i<messages.size(); i++) {
+        sponge.reset();
+        sponge.absorb(messages[i], messageLengthsInBits[i]);
+        digests[i].clear();
+        sponge.squeeze(digests[i], outputLengthInBits);
+    }
+}
+
+string SpongeBatch::getDescription() const
+{
+    stringstream a;
+    a << "SpongeBatch[f=" << (*f) << ", pad=" << (*pad)
+        << ", r=" << dec << rate
+        << ", c=" << f->getWidth()-rate << "]";
+    return a.str();
+}
+
+ostream& operator<<(ostream& a, const SpongeBatch& batch)
+{
+    return a << batch.getDescription();
+}
+
+KeccakBatch::KeccakBatch(unsigned int aRate, unsigned int aCapacity, bool aMultiThreaded)
+    : SpongeBatch(new KeccakFTuned(aRate+aCapacity), new MultiRatePadding(), aRate, aMultiThreaded)
+{
+}
+
+KeccakBatch::~KeccakBatch()
+{
+    delete f;
+    delete pad;
+}
+
+string KeccakBatch::getDescription() const
+{
+    stringstream a;
+    a << "KeccakBatch[r=" << dec << rate << ", c=" << dec << f->getWidth()-rate << "]";
+    return a.str();
+}
+
+LeafBatchHasher::LeafBatchHasher(const SpongeBatch *aHasher, unsigned int aLeafSize, UINT8 aSuffix, unsigned int aSuffixLengthInBits,
+    unsigned int aDigestLengthInBits, unsigned int aLeavesPerBatch, const function<void(const vector<UINT8>&)>& aProcessDigest)
+    : hasher(aHasher), leafSize(aLeafSize), suffix(aSuffix), suffixLengthInBits(aSuffixLengthInBits),
+    digestLengthInBits(aDigestLengthInBits), leavesPerBatch(aLeavesPerBatch), processDigest(aProcessDigest)
+{
+    reset();
+}
+
+void LeafBatchHasher::reset()
+{
+    leaves.clear();
+    leafLengthsInBits.clear();
+    nrPendingLeaves = 0;
+    currentLeafSize = 0;
+    nrLeaves = 0;
+}
+
+void LeafBatchHasher::absorb(const UINT8 *input, UINT64 lengthInBytes)
+{
+    while(lengthInBytes > 0) {
+        if ((nrPendingLeaves == 0) || (currentLeafSize == leafSize)) {
+            if (nrPendingLeaves == leavesPerBatch)
+                flush();
+            if (leaves.size() <= nrPendingLeaves) {
+                leaves.push_back(vector<UINT8>(leafSize+1));
+                leafLengthsInBits.push_back(0);
+            }
+            nrPendingLeaves++;
+            nrLeaves++;
+            currentLeafSize = 0;
+        }
+        unsigned int count = leafSize - currentLeafSize;
+        if (count > lengthInBytes)
+            count = (unsigned int)lengthInBytes;
+        memcpy(&leaves[nrPendingLeaves-1][currentLeafSize], input, count);
+        currentLeafSize += count;
+        input += count;
+        lengthInBytes -= count;
+    }
+}
+
+void LeafBatchHasher::flush()
+{
+    if (nrPendingLeaves == 0)
+        return;
+    for(unsigned int i=0; i<nrPendingLeaves; i++) {
+        unsigned int size = (i == nrPendingLeaves-1) ? currentLeafSize : leafSize;
+        leaves[i][size] = suffix;
+        leafLengthsInBits[i] = size*8 + suffixLengthInBits;
+    }
+    if (nrPendingLeaves < leaves.size()) {
+        leaves.resize(nrPendingLeaves);
+        leafLengthsInBits.resize(nrPendingLeaves);
+    }
+    hasher->hash(leaves, leafLengthsInBits, digestLengthInBits, digests);
+    nrPendingLeaves = 0;
+    currentLeafSize = 0;
+    for(unsigned int i=0; i<digests.size(); i++)
+        processDigest(digests[i]);
+}
@@ -0,0 +1,209 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _SPONGEBATCH_H_
+#define _SPONGEBATCH_H_
+
+#include <functional>
+#include <vector>
+#include "padding.h"
+#include "sponge.h"
+#include "transformations.h"
+#include "types.h"
+
+using namespace std;
+
+/**
+  * Class that hashes many independent messages with the same sponge function.
+  * The result is the same as absorbing each message into a fresh Sponge object
+  * and squeezing the requested number of bits, but the messages are processed
+  * together: they are sorted by number of blocks after padding, and the states
+  * of up to batchSize messages are permuted at once with
+  * Transformation::permuteN(), so that KeccakF can use its SIMD backends.
+  * When the total amount of work is large enough, the batches are also
+  * spread over several threads (see parallelFor()).
+  *
+  * The batched processing requires a rate that is a multiple of 8;
+  * for other rates, each message goes through its own Sponge object.
+  */
+class SpongeBatch {
+public:
+    /** The number of states given to Transformation::permuteN() at once. */
+    static const unsigned int batchSize = 8;
+    /** The minimum number of blocks per thread before using several threads. */
+    static const unsigned int minimumBlocksPerThread = 256;
+protected:
+    /** The transformation used.
+      * The memory is assumed to belong to the caller. */
+    const Transformation *f;
+    /** The padding rule used.
+      * The memory is assumed to belong to the caller. */
+    const PaddingRule *pad;
+    /** The rate of the sponge function. */
+    unsigned int rate;
+    /** Whether the batches may be processed by several threads. */
+    bool multiThreaded;
+public:
+    /**
+      * The constructor. The transformation, padding rule and rate are
+      * as in Sponge::Sponge().
+      *
+      * @param  aF              The transformation.
+      * @param  aPad            The padding rule.
+      * @param  aRate           The rate.
+      * @param  aMultiThreaded  Whether several threads may be used.
+      */
+    SpongeBatch(const Transformation *aF, const PaddingRule *aPad, unsigned int aRate, bool aMultiThreaded = true);
+    /**
+      * The destructor.
+      */
+    virtual ~SpongeBatch() {}
+    /**
+      * Method that hashes each of the given messages, made of whole bytes.
+      *
+      * @param  messages            The messages to hash.
+      * @param  outputLengthInBits  The number of output bits for each message.
+      * @param  digests     The output, resized to have one digest per message,
+      *                     in the same order as @a messages. Each digest
+      *                     has the format of Sponge::squeeze().
+      */
+    void hash(const vector<vector<UINT8> >& messages, unsigned int outputLengthInBits, vector<vector<UINT8> >& digests) const;
+    /**
+      * Method that hashes each of the given messages, of any length in bits.
+      * The last bits of a message whose length is not a multiple of 8
+      * are in the last byte, as in Sponge::absorb().
+      *
+      * @param  messages            The messages to hash.
+      * @param  messageLengthsInBits    The length in bits of each message.
+      * @param  outputLengthInBits  The number of output bits for each message.
+      * @param  digests     The output, resized to have one digest per message,
+      *                     in the same order as @a messages.
+      */
+    void hash(const vector<vector<UINT8> >& messages, const vector<unsigned int>& messageLengthsInBits,
+        unsigned int outputLengthInBits, vector<vector<UINT8> >& digests) const;
+    /**
+      * Method that returns the rate.
+      */
+    unsigned int getRate() const { return rate; }
+    /**
+      * Method that returns a string describing the instance.
+      */
+    virtual string getDescription() const;
+    /**
+      * Display function.
+      */
+    friend ostream& operator<<(ostream& a, const SpongeBatch& batch);
+protected:
+    void hashWithSponges(const vector<vector<UINT8> >& messages, const vector<unsigned int>& messageLengthsInBits,
+        unsigned int outputLengthInBits, vector<vector<UINT8> >& digests) const;
+};
+
+/**
+  * Class that hashes many independent messages with Keccak[r, c],
+  * giving the same results as the Keccak class.
+  */
+class KeccakBatch : public SpongeBatch {
+public:
+    /**
+      * The constructor. It dynamically allocates a KeccakFTuned permutation (see Keccak::Keccak()).
+      *
+      * @param  aRate       The rate, as in Keccak::Keccak().
+      * @param  aCapacity   The capacity, as in Keccak::Keccak().
+      * @param  aMultiThreaded  Whether several threads may be used.
+      */
+    KeccakBatch(unsigned int aRate = 1024, unsigned int aCapacity = 576, bool aMultiThreaded = true);
+    /**
+      * The destructor. It frees the allocated KeccakF permutation.
+      */
+    virtual ~KeccakBatch();
+    /**
+      * Method that returns a string describing the instance.
+      */
+    string getDescription() const;
+};
+
+/**
+  * Class that cuts a byte stream into leaves of a fixed size and hashes them
+  * in batches with a SpongeBatch, as in the tree hashing modes KangarooTwelve
+  * and ParallelHash. Each leaf is followed by a suffix of a few bits.
+  * The leaves are buffered until a batch is full, and the digests
+  * are given in the order of the leaves to the function given to the
+  * constructor as soon as each batch is done, so the memory use does not
+  * depend on the length of the stream.
+  */
+class LeafBatchHasher {
+protected:
+    /** The object that hashes the leaves.
+      * The memory is assumed to belong to the caller. */
+    const SpongeBatch *hasher;
+    /** The size of a leaf in bytes. */
+    unsigned int leafSize;
+    /** The bits that follow each leaf, in the same format as the last byte in Sponge::absorb(). */
+    UINT8 suffix;
+    /** The number of bits in the suffix. */
+    unsigned int suffixLengthInBits;
+    /** The number of output bits for each leaf. */
+    unsigned int digestLengthInBits;
+    /** The number of leaves hashed at once. */
+    unsigned int leavesPerBatch;
+    /** The function that receives the digest of each leaf, in order. */
+    function<void(const vector<UINT8>&)> processDigest;
+    /** The leaves not yet hashed, each with room for the suffix. */
+    vector<vector<UINT8> > leaves;
+    /** The lengths in bits of the leaves, including the suffix. */
+    vector<unsigned int> leafLengthsInBits;
+    /** The digests of the last batch of leaves. */
+    vector<vector<UINT8> > digests;
+    /** The number of leaves not yet hashed, including the one being filled. */
+    unsigned int nrPendingLeaves;
+    /** The number of bytes in the leaf being filled. */
+    unsigned int currentLeafSize;
+    /** The total number of leaves. */
+    UINT64 nrLeaves;
+public:
+    /**
+      * The constructor.
+      *
+      * @param  aHasher             The object that hashes the leaves.
+      * @param  aLeafSize           The size of a leaf in bytes.
+      * @param  aSuffix             The bits that follow each leaf.
+      * @param  aSuffixLengthInBits The number of bits in @a aSuffix, less than 8.
+      * @param  aDigestLengthInBits The number of output bits for each leaf.
+      * @param  aLeavesPerBatch     The number of leaves hashed at once.
+      * @param  aProcessDigest      The function that receives the digest of each leaf.
+      */
+    LeafBatchHasher(const SpongeBatch *aHasher, unsigned int aLeafSize, UINT8 aSuffix, unsigned int aSuffixLengthInBits,
+        unsigned int aDigestLengthInBits, unsigned int aLeavesPerBatch, const function<void(const vector<UINT8>&)>& aProcessDigest);
+    /**
+      * Method that forgets the leaves, without hashing them.
+      */
+    void reset();
+    /**
+      * Method that appends bytes to the stream. A new leaf is started
+      * only when there is a byte to put in it, so the last leaf is never empty.
+      */
+    void absorb(const UINT8 *input, UINT64 lengthInBytes);
+    /**
+      * Method that hashes the pending leaves, the last one possibly incomplete,
+      * and gives their digests. The next byte absorbed starts a new leaf.
+      */
+    void flush();
+    /**
+      * Method that returns the number of leaves started so far.
+      */
+    UINT64 getNumberOfLeaves() const { return nrLeaves; }
+};
+
+#endif
@@ -0,0 +1,156 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include <thread>
+#include <vector>
+#include "spongestream.h"
+#include "timing.h"
+
+#ifdef _WIN32
+#include <fcntl.h>
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+SpongeStream::SpongeStream(Sponge& aSponge, unsigned int aBufferSize)
+    : sponge(aSponge), bufferSize(aBufferSize), absorbedBytes(0), absorbingTime(0.0)
+{
+    if (bufferSize == 0)
+        throw SpongeException("The buffer size must be strictly positive.");
+    if (bufferSize > maxChunkSize)
+        bufferSize = maxChunkSize;
+}
+
+void SpongeStream::absorbChunks(const UINT8 *input, UINT64 lengthInBytes)
+{
+    while(lengthInBytes > 0) {
+        unsigned int chunkSize = (lengthInBytes > maxChunkSize) ? maxChunkSize : (unsigned int)lengthInBytes;
+        sponge.absorb(input, chunkSize*8);
+        input += chunkSize;
+        lengthInBytes -= chunkSize;
+        absorbedBytes += chunkSize;
+    }
+}
+
+void SpongeStream::absorb(const UINT8 *input, UINT64 lengthInBytes)
+{
+    double startTime = getTimeInSeconds();
+    absorbChunks(input, lengthInBytes);
+    absorbingTime += getTimeInSeconds() - startTime;
+}
+
+void SpongeStream::absorbStream(FILE *file)
+{
+    double startTime = getTimeInSeconds();
+    vector<UINT8> buffers[2] = { vector<UINT8>(bufferSize), vector<UINT8>(bufferSize) };
+    size_t lengths[2];
+    lengths[0] = fread(&buffers[0][0], 1, bufferSize, file);
+    unsigned int current = 0;
+    while(lengths[current] > 0) {
+        unsigned int next = 1 - current;
+        thread reader([&, next]() {
+            lengths[next] = fread(&buffers[next][0], 1, bufferSize, file);
+        });
+        try {
+            absorbChunks(&buffers[current][0], lengths[current]);
+        }
+        catch(...) {
+            // The reader must be joined before leaving, otherwise ~thread() terminates the program
+            reader.join();
+            throw;
+        }
+        reader.join();
+        current = next;
+    }
+    absorbingTime += getTimeInSeconds() - startTime;
+    if (ferror(file))
+        throw SpongeException("Error while reading the input.");
+}
+
+bool SpongeStream::absorbMappedFile(const string& fileName)
+{
+#ifdef _WIN32
+    (void)fileName;
+    return false;
+#else
+    int fd = ::open(fileName.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+    struct stat fileStatus;
+    if ((fstat(fd, &fileStatus) != 0) || !S_ISREG(fileStatus.st_mode)
+            || ((UINT64)fileStatus.st_size != (UINT64)(size_t)fileStatus.st_size)) {
+        ::close(fd);
+        return false;
+    }
+    UINT64 size = (UINT64)fileStatus.st_size;
+    if (size == 0) {
+        ::close(fd);
+        return true;
+    }
+    void *address = mmap(0, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (address == MAP_FAILED)
+        return false;
+#ifdef MADV_SEQUENTIAL
+    madvise(address, (size_t)size, MADV_SEQUENTIAL);
+#endif
+    double startTime = getTimeInSeconds();
+    try {
+        absorbChunks((const UINT8 *)address, size);
+    }
+    catch(...) {
+        munmap(address, (size_t)size);
+        throw;
+    }
+    absorbingTime += getTimeInSeconds() - startTime;
+    munmap(address, (size_t)size);
+    return true;
+#endif
+}
+
+void SpongeStream::absorbFile(const string& fileName)
+{
+    if (fileName == "-") {
+#ifdef _WIN32
+        _setmode(_fileno(stdin), _O_BINARY);
+#endif
+        absorbStream(stdin);
+        return;
+    }
+    if (absorbMappedFile(fileName))
+        return;
+    FILE *file = fopen(fileName.c_str(), "rb");
+    if (file == 0)
+        throw SpongeException("Cannot open the file " + fileName + ".");
+    try {
+        absorbStream(file);
+    }
+    catch(...) {
+        fclose(file);
+        throw;
+    }
+    fclose(file);
+}
+
+double SpongeStream::getThroughput() const
+{
+    return (absorbingTime > 0.0) ? absorbedBytes/absorbingTime : 0.0;
+}
@@ -0,0 +1,99 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _SPONGESTREAM_H_
+#define _SPONGESTREAM_H_
+
+#include <cstdio>
+#include <string>
+#include "sponge.h"
+#include "types.h"
+
+using namespace std;
+
+/**
+  * Class that absorbs data of any length into a Sponge object, such as
+  * an instance of Keccak or ReducedRoundKeccak, from memory,
+  * from a file or from a pipe.
+  *
+  * Lengths are counted in bytes on 64 bits, and the data is given to
+  * Sponge::absorb() in chunks whose length in bits fits in an unsigned int.
+  * Regular files are mapped into memory when possible. Otherwise, e.g.,
+  * for pipes, the data is read into two buffers in turn: while one buffer
+  * is being absorbed, the next one is filled by a separate thread.
+  *
+  * The input is processed as a sequence of bytes, so Sponge::absorb()
+  * can still be called afterwards with a last partial byte, if needed.
+  */
+class SpongeStream {
+public:
+    /** The default size of each of the two read buffers, in bytes. */
+    static const unsigned int defaultBufferSize = 1 << 20;
+    /** The maximum number of bytes given to Sponge::absorb() in one call. */
+    static const unsigned int maxChunkSize = 1 << 28;
+protected:
+    /** The sponge function that absorbs the data.
+      * The memory is assumed to belong to the caller. */
+    Sponge& sponge;
+    /** The size of each of the two read buffers, in bytes. */
+    unsigned int bufferSize;
+    /** The number of bytes absorbed through this object so far. */
+    UINT64 absorbedBytes;
+    /** The time, in seconds, spent in the absorb methods so far,
+      * including the time waiting for input. */
+    double absorbingTime;
+public:
+    /**
+      * The constructor.
+      * @param  aSponge     The sponge function, in the absorbing phase.
+      * @param  aBufferSize The size of each of the two read buffers, in bytes.
+      */
+    SpongeStream(Sponge& aSponge, unsigned int aBufferSize = defaultBufferSize);
+    /**
+      * Method that absorbs @a lengthInBytes bytes from memory,
+      * e.g., from a region mapped by the caller.
+      */
+    void absorb(const UINT8 *input, UINT64 lengthInBytes);
+    /**
+      * Method that absorbs everything that can be read from @a file
+      * until its end, using two buffers so that reading overlaps with absorbing.
+      * @param  file    An open file or pipe, e.g., stdin.
+      */
+    void absorbStream(FILE *file);
+    /**
+      * Method that absorbs the content of the given file. A regular file
+      * is mapped into memory if possible; otherwise, it is read with absorbStream().
+      * @param  fileName    The name of the file, or "-" for the standard input.
+      */
+    void absorbFile(const string& fileName);
+    /**
+      * Method that returns the number of bytes absorbed so far.
+      */
+    UINT64 getAbsorbedBytes() const { return absorbedBytes; }
+    /**
+      * Method that returns the time, in seconds, spent absorbing so far.
+      */
+    double getAbsorbingTime() const { return absorbingTime; }
+    /**
+      * Method that returns the throughput, in bytes per second, of the
+      * absorbing done so far.
+      */
+    double getThroughput() const;
+private:
+    void absorbChunks(const UINT8 *input, UINT64 lengthInBytes);
+    bool absorbMappedFile(const string& fileName);
+};
+
+#endif
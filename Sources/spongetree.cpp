@@ -13,9 +13,102 @@ and related or neighboring rights to the source code in this file.
 http://creativecommons.org/publicdomain/zero/1.0/
 */
 
+#include <chrono>
+#include <string.h>
 #include "spongetree.h"
 
-ShortLeafInterleavedSpongeTree::ShortLeafInterleavedSpongeTree(const SpongeFactory& aFactory, const int aD, const int aB)
+SpongeTreeLeafWorker::SpongeTreeLeafWorker(Sponge *aLeaf, unsigned int aBlockSizeInBits)
+    : leaf(aLeaf), blockSizeInBits(aBlockSizeInBits), blockSizeInBytes((aBlockSizeInBits+7)/8),
+    blockCounts(nrChunks, 0), producedChunks(0), consumedChunks(0), finished(false),
+    blocksInCurrentChunk(0)
+{
+    blocksPerChunk = chunkSize/blockSizeInBytes;
+    if (blocksPerChunk == 0)
+        blocksPerChunk = 1;
+    storage.resize(nrChunks*blocksPerChunk*blockSizeInBytes);
+    worker = thread(&SpongeTreeLeafWorker::run, this);
+}
+
+SpongeTreeLeafWorker::~SpongeTreeLeafWorker()
+{
+    if (worker.joinable()) {
+        finished.store(true, memory_order_release);
+        worker.join();
+    }
+}
+
+UINT8* SpongeTreeLeafWorker::getBlockToFill()
+{
+    UINT64 produced = producedChunks.load(memory_order_relaxed);
+    if (blocksInCurrentChunk == 0)
+        while(produced - consumedChunks.load(memory_order_acquire) == nrChunks)
+            this_thread::yield();
+    return &storage[((produced % nrChunks)*blocksPerChunk + blocksInCurrentChunk)*blockSizeInBytes];
+}
+
+void SpongeTreeLeafWorker::publishBlock()
+{
+    blocksInCurrentChunk++;
+    if (blocksInCurrentChunk == blocksPerChunk)
+        publishChunk();
+}
+
+void SpongeTreeLeafWorker::publishChunk()
+{
+    UINT64 produced = producedChunks.load(memory_order_relaxed);
+    blockCounts[produced % nrChunks] = blocksInCurrentChunk;
+    producedChunks.store(produced+1, memory_order_release);
+    blocksInCurrentChunk = 0;
+}
+
+void SpongeTreeLeafWorker::finish()
+{
+    if (blocksInCurrentChunk > 0)
+        publishChunk();
+    finished.store(true, memory_order_release);
+    if (worker.joinable())
+        worker.join();
+    if (error)
+        rethrow_exception(error);
+}
+
+void SpongeTreeLeafWorker::run()
+{
+    unsigned int idleRounds = 0;
+    while(true) {
+        UINT64 consumed = consumedChunks.load(memory_order_relaxed);
+        bool done = finished.load(memory_order_acquire);
+        if (producedChunks.load(memory_order_acquire) == consumed) {
+            if (done)
+                return;
+            // Yield while blocks are expected soon, then sleep
+            // so that an idle tree does not keep the processor busy.
+            if (++idleRounds < 1000)
+                this_thread::yield();
+            else
+                this_thread::sleep_for(chrono::microseconds(100));
+            continue;
+        }
+        idleRounds = 0;
+        unsigned int slot = (unsigned int)(consumed % nrChunks);
+        const UINT8 *chunk = &storage[slot*blocksPerChunk*blockSizeInBytes];
+        if (!error) {
+            try {
+                if ((blockSizeInBits % 8) == 0)
+                    leaf->absorb(chunk, blockCounts[slot]*blockSizeInBits);
+                else
+                    for(unsigned int i=0; i<blockCounts[slot]; i++)
+                        leaf->absorb(chunk + i*blockSizeInBytes, blockSizeInBits);
+            }
+            catch(...) {
+                error = current_exception();
+            }
+        }
+        consumedChunks.store(consumed+1, memory_order_release);
+    }
+}
+
+ShortLeafInterleavedSpongeTree::ShortLeafInterleavedSpongeTree(const SpongeFactory& aFactory, const int aD, const int aB, const bool aParallel)
     : factory(aFactory), absorbQueue(aB), D(aD), B(aB)
 {
     for(int i=0; i<D; i++)
@@ -24,10 +117,15 @@ ShortLeafInterleavedSpongeTree::ShortLeafInterleavedSpongeTree(const SpongeFacto
     C = 8*((final->getCapacity()+7)/8);
     leafIndex = 0;
     squeezing = false;
+    if (aParallel)
+        for(int i=0; i<D; i++)
+            workers.push_back(new SpongeTreeLeafWorker(leaves[i], B));
 }
 
 ShortLeafInterleavedSpongeTree::~ShortLeafInterleavedSpongeTree()
 {
+    for(unsigned int i=0; i<workers.size(); i++)
+        delete workers[i];
     for(unsigned int i=0; i<leaves.size(); i++) {
         delete leaves[i];
         leaves[i] = (Sponge*)0;
@@ -37,25 +135,52 @@ ShortLeafInterleavedSpongeTree::~ShortLeafInterleavedSpongeTree()
 
 void ShortLeafInterleavedSpongeTree::absorb(const UINT8 *input, unsigned int lengthInBits)
 {
-    unsigned int lengthInBytes = (lengthInBits+7)/8;
-    vector<UINT8> inputAsVector(input, input+lengthInBytes);
-    absorb(inputAsVector, lengthInBits);
+    if (squeezing)
+        throw SpongeException("The absorbing phase is over.");
+    while(lengthInBits > 0) {
+        if (((B % 8) == 0) && (absorbQueue.lastBlockSize() == 0) && (lengthInBits >= (unsigned int)B)) {
+            absorbBlock(input);
+            input += B/8;
+            lengthInBits -= B;
+            continue;
+        }
+        unsigned int count = lengthInBits;
+        if (count > absorbQueue.getFreeSpace())
+            count = absorbQueue.getFreeSpace() - (absorbQueue.getFreeSpace() % 8);
+        absorbQueue.append(input, count);
+        input += count/8;
+        lengthInBits -= count;
+        while(absorbQueue.firstBlockIsWhole()) {
+            absorbBlock(absorbQueue.firstBlock());
+            absorbQueue.removeFirstBlock();
+        }
+    }
+}
+
+void ShortLeafInterleavedSpongeTree::absorbBlock(const UINT8 *block)
+{
+    if (workers.empty())
+        leaves[leafIndex]->absorb(block, B);
+    else {
+        memcpy(workers[leafIndex]->getBlockToFill(), block, (B+7)/8);
+        workers[leafIndex]->publishBlock();
+    }
+    leafIndex = (leafIndex+1)%D;
 }
 
 void ShortLeafInterleavedSpongeTree::absorb(const vector<UINT8>& input, unsigned int lengthInBits)
 {
-    if (squeezing)
-        throw SpongeException("The absorbing phase is over.");
-    absorbQueue.append(input.begin(), lengthInBits);
-    while(absorbQueue.firstBlockIsWhole()) {
-        leaves[leafIndex]->absorb(absorbQueue.firstBlock(), B);
-        absorbQueue.removeFirstBlock();
-        leafIndex = (leafIndex+1)%D;
-    }
+    if (lengthInBits == 0)
+        return;
+    if (input.size() < (lengthInBits+7)/8)
+        throw SpongeException("The given input length is inconsistent.");
+    absorb(&input[0], lengthInBits);
 }
 
 void ShortLeafInterleavedSpongeTree::flushAndSwitchToSqueezingPhase()
 {
+    for(unsigned int i=0; i<workers.size(); i++)
+        workers[i]->finish();
     leaves[leafIndex]->absorb(absorbQueue.firstBlock(), absorbQueue.lastBlockSize());
     absorbQueue.clear();
     for(int i=0; i<D; i++) {
@@ -16,6 +16,10 @@ http://creativecommons.org/publicdomain/zero/1.0/
 #ifndef _SPONGETREE_H_
 #define _SPONGETREE_H_
 
+#include <atomic>
+#include <exception>
+#include <thread>
+#include <vector>
 #include "sponge.h"
 
 using namespace std;
@@ -30,6 +34,73 @@ public:
     virtual Sponge* newSponge() const = 0;
 };
 
+/** This class feeds the blocks of one leaf of ShortLeafInterleavedSpongeTree
+  * to its sponge function in a separate thread.
+  * The blocks are written by the thread calling
+  * ShortLeafInterleavedSpongeTree::absorb() into a ring of chunks, and
+  * absorbed by the worker thread, without locks: each side only updates
+  * its own counter of chunks, so there is exactly one producer
+  * and one consumer.
+  */
+class SpongeTreeLeafWorker {
+public:
+    /** The approximate size of a chunk, in bytes. */
+    static const unsigned int chunkSize = 1 << 16;
+    /** The number of chunks in the ring. */
+    static const unsigned int nrChunks = 4;
+protected:
+    /** The sponge function of the leaf.
+      * The memory is assumed to belong to the caller. */
+    Sponge *leaf;
+    /** The block size in bits. */
+    unsigned int blockSizeInBits;
+    /** The block size in bytes, i.e., the size of a slot in a chunk. */
+    unsigned int blockSizeInBytes;
+    /** The number of blocks in a full chunk. */
+    unsigned int blocksPerChunk;
+    /** The storage of the ring of chunks. */
+    vector<UINT8> storage;
+    /** The number of blocks in each chunk of the ring. */
+    vector<unsigned int> blockCounts;
+    /** The number of chunks published by the producer. */
+    atomic<UINT64> producedChunks;
+    /** The number of chunks absorbed by the worker. */
+    atomic<UINT64> consumedChunks;
+    /** Whether the producer has published its last chunk. */
+    atomic<bool> finished;
+    /** The number of blocks written in the chunk being filled. */
+    unsigned int blocksInCurrentChunk;
+    /** The exception thrown by the leaf, if any. */
+    exception_ptr error;
+    /** The worker thread. */
+    thread worker;
+public:
+    /** The constructor. It starts the worker thread.
+      * @param  aLeaf   The sponge function of the leaf.
+      * @param  aBlockSizeInBits    The block size <i>B</i>.
+      */
+    SpongeTreeLeafWorker(Sponge *aLeaf, unsigned int aBlockSizeInBits);
+    /** The destructor. It stops the worker thread if finish() was not called.
+      */
+    ~SpongeTreeLeafWorker();
+    /** Method that returns where to write the next block,
+      * waiting if the ring is full.
+      */
+    UINT8* getBlockToFill();
+    /** Method that makes the block returned by getBlockToFill()
+      * available to the worker thread.
+      */
+    void publishBlock();
+    /** Method that waits until the worker thread has absorbed all the
+      * blocks and stops it. It rethrows the exception thrown by
+      * the leaf, if any.
+      */
+    void finish();
+protected:
+    void publishChunk();
+    void run();
+};
+
 /** This class implements a tree hashing mode.
   * In particular, it implements the second tree hashing mode described
   * in Section 7.2 of [Bertoni et al., Sufficient conditions for sound tree
@@ -47,6 +118,10 @@ public:
   * - the value <i>B</i> coded on 32-bit in a little-endian fashion;
   * - 5 bits set to zero (reserved for future use, for other layouts);
   * - the final bit set to 1 for domain separation with leaves.
+  *
+  * In the parallel mode, each leaf is absorbed by its own thread
+  * (see SpongeTreeLeafWorker), and the final node is processed
+  * once all these threads are done. The output is the same in both modes.
   */
 class ShortLeafInterleavedSpongeTree {
 protected:
@@ -78,14 +153,19 @@ protected:
     /** The chaining value size.
       */
     int C;
+    /** In the parallel mode, the worker threads of the <i>D</i> leaves.
+      * In the serial mode, this attribute is empty.
+      */
+    vector<SpongeTreeLeafWorker*> workers;
 public:
     /** The constructor.
       * @param  aFactory    The object that will create the right sponge functions
       *                     for the leaves and for the final node.
       * @param  aD  The value for <i>D</i>.
       * @param  aB  The value for <i>B</i>.
+      * @param  aParallel   Whether each leaf is absorbed by its own thread.
       */
-    ShortLeafInterleavedSpongeTree(const SpongeFactory& aFactory, const int aD, const int aB);
+    ShortLeafInterleavedSpongeTree(const SpongeFactory& aFactory, const int aD, const int aB, const bool aParallel = false);
     /** The desctructor. It deallocates any allocated object.
       */
     ~ShortLeafInterleavedSpongeTree();
@@ -142,6 +222,11 @@ public:
       */
     void squeeze(vector<UINT8>& output, unsigned int desiredLengthInBits);
 protected:
+    /**
+      * Internal method that gives a block of <i>B</i> bits to the current
+      * leaf, directly or through its worker thread, and moves to the next leaf.
+      */
+    void absorbBlock(const UINT8 *block);
     /**
       * Internal method that absorbs the data still in absorbQueue,
       * and then switches the sponge function of the final node
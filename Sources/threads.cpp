@@ -0,0 +1,24 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include "threads.h"
+
+using namespace std;
+
+unsigned int getNumberOfThreads()
+{
+    unsigned int n = thread::hardware_concurrency();
+    return (n > 0) ? n : 1;
+}
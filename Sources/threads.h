@@ -0,0 +1,79 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _THREADS_H_
+#define _THREADS_H_
+
+#include <exception>
+#include <thread>
+#include <vector>
+#include "types.h"
+
+using namespace std;
+
+/**
+  * Function that returns the number of threads to use for parallel
+  * computations, i.e., the number of hardware threads, or 1 if unknown.
+  */
+unsigned int getNumberOfThreads();
+
+/**
+  * Function that splits the range [@a begin, @a end) into as many contiguous
+  * sub-ranges as getNumberOfThreads() and calls @a function(subBegin, subEnd)
+  * for each of them in a separate thread. It returns when all are done.
+  * The calls must be independent, e.g., each writing a distinct part of a table.
+  * If a call throws, or if a thread cannot be created, the threads already
+  * started are joined and then the first exception is rethrown.
+  */
+template<class Function>
+void parallelFor(UINT64 begin, UINT64 end, Function function)
+{
+    UINT64 nrThreads = getNumberOfThreads();
+    if (end - begin < nrThreads)
+        nrThreads = (end > begin) ? (end - begin) : 1;
+    if (nrThreads <= 1) {
+        function(begin, end);
+        return;
+    }
+    vector<exception_ptr> exceptions(nrThreads);
+    vector<thread> threads;
+    try {
+        for(UINT64 i=0; i<nrThreads; i++) {
+            UINT64 subBegin = begin + (end - begin)*i/nrThreads;
+            UINT64 subEnd = begin + (end - begin)*(i+1)/nrThreads;
+            exception_ptr *exception = &exceptions[i];
+            threads.push_back(thread([function, subBegin, subEnd, exception]() mutable {
+                try {
+                    function(subBegin, subEnd);
+                }
+                catch(...) {
+                    *exception = current_exception();
+                }
+            }));
+        }
+    }
+    catch(...) {
+        for(unsigned int i=0; i<threads.size(); i++)
+            threads[i].join();
+        throw;
+    }
+    for(unsigned int i=0; i<threads.size(); i++)
+        threads[i].join();
+    for(unsigned int i=0; i<exceptions.size(); i++)
+        if (exceptions[i])
+            rethrow_exception(exceptions[i]);
+}
+
+#endif
@@ -0,0 +1,72 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#include "timing.h"
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#include <windows.h>
+#define KeccakTools_HAS_RDTSC
+#elif defined(__i386__) || defined(__x86_64__)
+#include <x86intrin.h>
+#include <sys/time.h>
+#define KeccakTools_HAS_RDTSC
+#else
+#include <sys/time.h>
+#endif
+
+UINT64 getCycleCount()
+{
+#ifdef KeccakTools_HAS_RDTSC
+    return __rdtsc();
+#else
+    return (UINT64)(getTimeInSeconds()*1e9);
+#endif
+}
+
+double getTimeInSeconds()
+{
+#if defined(_MSC_VER)
+    LARGE_INTEGER count, frequency;
+    QueryPerformanceCounter(&count);
+    QueryPerformanceFrequency(&frequency);
+    return (double)count.QuadPart/(double)frequency.QuadPart;
+#else
+    struct timeval t;
+    gettimeofday(&t, 0);
+    return t.tv_sec + t.tv_usec*1e-6;
+#endif
+}
+
+CycleMeasurement::CycleMeasurement()
+    : startCount(0), minimum(~(UINT64)0), overhead(0)
+{
+    UINT64 calibration = ~(UINT64)0;
+    for(unsigned int i=0; i<100; i++) {
+        UINT64 t0 = getCycleCount();
+        UINT64 t1 = getCycleCount();
+        if (t1-t0 < calibration)
+            calibration = t1-t0;
+    }
+    overhead = calibration;
+}
+
+void CycleMeasurement::stop()
+{
+    UINT64 duration = getCycleCount() - startCount;
+    duration = (duration > overhead) ? (duration - overhead) : 0;
+    if (duration < minimum)
+        minimum = duration;
+}
@@ -0,0 +1,75 @@
+/*
+KeccakTools
+
+The Keccak sponge function, designed by Guido Bertoni, Joan Daemen,
+Michaël Peeters and Gilles Van Assche. For more information, feedback or
+questions, please refer to our website: http://keccak.noekeon.org/
+
+Implementation by the designers,
+hereby denoted as "the implementer".
+
+To the extent possible under law, the implementer has waived all copyright
+and related or neighboring rights to the source code in this file.
+http://creativecommons.org/publicdomain/zero/1.0/
+*/
+
+#ifndef _TIMING_H_
+#define _TIMING_H_
+
+#include "types.h"
+
+/**
+  * Function that returns the current value of the processor's time-stamp
+  * counter, to measure durations in clock cycles.
+  * On platforms without such a counter, it returns the time in nanoseconds.
+  */
+UINT64 getCycleCount();
+
+/**
+  * Function that returns the current time in seconds, to measure
+  * the wall-clock duration of long operations.
+  */
+double getTimeInSeconds();
+
+/**
+  * Class that measures the minimum duration, in cycles, of a repeated operation.
+  * Taking the minimum over several runs filters out interrupts and cache effects.
+  * Typical use:
+  * <pre>
+  *     CycleMeasurement m;
+  *     for(unsigned int i=0; i<repeat; i++) {
+  *         m.start();
+  *         ... operation to measure ...
+  *         m.stop();
+  *     }
+  *     cout << m.getMinimum();
+  * </pre>
+  */
+class CycleMeasurement {
+protected:
+    /** The counter value at the last call to start(). */
+    UINT64 startCount;
+    /** The minimum duration observed so far. */
+    UINT64 minimum;
+    /** The overhead of a start()/stop() pair, subtracted from each measurement. */
+    UINT64 overhead;
+public:
+    /**
+      * The constructor. It calibrates the overhead of the measurement itself.
+      */
+    CycleMeasurement();
+    /**
+      * Method that starts a measurement.
+      */
+    inline void start() { startCount = getCycleCount(); }
+    /**
+      * Method that stops a measurement and updates the minimum.
+      */
+    void stop();
+    /**
+      * Method that returns the minimum duration observed, in cycles.
+      */
+    UINT64 getMinimum() const { return minimum; }
+};
+
+#endif
@@ -15,6 +15,7 @@ http://creativecommons.org/publicdomain/zero/1.0/
 
 #ifndef _TRANSFORMATIONS_H_
 #define _TRANSFORMATIONS_H_
+#include <cstddef>
 #include <iostream>
 #include <string>
 #include "types.h"
@@ -44,6 +45,21 @@ public:
       *                 ceil(getWidth()/8.0) bytes.
       */
     virtual void operator()(UINT8 * state) const = 0;
+    /**
+      * Method that applies the transformation onto @a n independent states.
+      * By default, it applies operator() onto each state in turn,
+      * but a derived class can process several states at once.
+      *
+      * @param  states  An array of @a n pointers to the states.
+      *                 Each state must have a size of at least
+      *                 ceil(getWidth()/8.0) bytes.
+      * @param  n       The number of states.
+      */
+    virtual void permuteN(UINT8 * const * states, size_t n) const
+    {
+        for(size_t i=0; i<n; i++)
+            (*this)(states[i]);
+    }
     /**
       * Abstract method that returns a string with a description of itself.
       */